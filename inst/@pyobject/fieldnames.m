@@ -54,8 +54,7 @@ function names = fieldnames (x)
                  " and not a.startswith('_')]"]);
 
   names_obj = pycall (cmd, x);
-  names = cellfun (@char, cell (names_obj), "uniformoutput", false);
-  names = names(:);
+  names = cellstr (names_obj);
 
 endfunction
 
@@ -101,7 +101,7 @@ function mtds = methods (x, option)
 
   mtds_list_obj = pycall (cmd, x);
 
-  mtds_list = cellfun (@char, cell (mtds_list_obj), "uniformoutput", false);
+  mtds_list = cellstr (mtds_list_obj);
 
   if (nargout == 0)
     if (isa (x, "py.types.ModuleType"))
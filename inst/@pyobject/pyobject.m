@@ -167,8 +167,22 @@ classdef pyobject < handle
       endfor
     endfunction
 
-    function y = struct (x)
-      y = __py_struct_from_dict__ (x);
+    function y = struct (x, mode)
+      if (nargin == 1)
+        y = __py_struct_from_dict__ (x);
+      elseif (strcmp (mode, "lazy"))
+        y = pystruct (x);
+      else
+        y = __py_struct_from_dict__ (x, mode);
+      endif
+    endfunction
+
+    function y = cellstr (x)
+      y = __py_cellstr_value__ (x);
+    endfunction
+
+    function y = sparse (x)
+      y = __py_sparse_value__ (x);
     endfunction
 
     function vargout = help (x)
@@ -334,10 +348,29 @@ endclassdef
 %!assert (pyobject (s1){"ok"}, true)
 
 %!error pyobject (struct ("a", {}))
-%!error pyobject (struct ("a", {1, 2}))
+
+## Test conversion of a struct array to an array of records
+%!test
+%! s = struct ("a", {1, 2, 3, 4}, "b", {int8(-1), int8(0), int8(1), int8(2)});
+%! p = pyobject (s);
+%! assert (double (pycall ("len", p)), 4)
+%! assert (struct (p), s)
+
+## Test conversion of a sparse matrix to a SciPy CSC matrix
+%!test
+%! if (pyeval ("__import__('importlib').util.find_spec('scipy') is not None"))
+%!   A = speye (4) + sparse (4, 1, 2, 4, 4);
+%!   p = pyobject (A);
+%!   assert (double (p.nnz), 5)
+%!   assert (sparse (p), A)
+%! endif
 
 %!error <unable to convert Octave struct array to a Python object>
-%! pyobject (struct ('a', {1, 2, 3, 4}))
+%! pyobject (struct ('a', {1, "x"}))
+%!error <must contain only numeric or logical scalars>
+%! pyobject (struct ('a', {1, [2, 3]}))
+%!error <must have the same type in all elements>
+%! pyobject (struct ('a', {1, int8(2)}))
 
 %!assert (char (pyeval ("None")), "None")
 %!assert (char (pyeval ("'this is a string'")), "this is a string")
@@ -408,11 +441,35 @@ endclassdef
 %! c = struct (b);
 %! assert (c, a)
 
+%!test
+%! d = pyeval ("{'a': 1, 'b': {'c': [1, 2]}, 'd': ['x', {'e': None}]}");
+%! s = struct (d, "deep");
+%! assert (s, struct ("a", 1, "b", struct ("c", [1, 2]), "d", {{"x", struct("e", [])}}))
+%! s = struct (d, "lazy");
+%! assert (class (s), "pystruct")
+%! assert (s.b.c{2}, 2)
+
 %!error struct (pyeval ("{1:2, 3:4}"));
+%!error <invalid MODE> struct (pyeval ("{}"), "shallow")
 %!error struct (pyobject ("this is not a dict"))
 %!error struct (pyobject ({1, 2, 3}))
 %!error struct (pyobject ())
 
+## Test conversion of strings in bulk
+%!test
+%! c = {"abc", "", "déf", "x"};
+%! p = pyobject (c);
+%! assert (class (p), "py.tuple")
+%! assert (char (pycall ("repr", p)), "('abc', '', 'déf', 'x')")
+%! assert (cellstr (p), c(:))
+%!test
+%! m = ["ab "; "cde"];
+%! p = pyobject (m);
+%! assert (class (p), "py.list")
+%! assert (char (pycall ("repr", p)), "['ab ', 'cde']")
+%! assert (char (cellstr (p)), m)
+%!error <item 1 is of type "int"> cellstr (pyeval ("[1, 2]"))
+
 ## Octave fails to resolve function overloads via function handles
 %!xtest
 %! fn = @double;
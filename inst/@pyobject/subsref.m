@@ -56,6 +56,12 @@ function varargout = subsref (x, idx)
         error ("subsref: slice indexing of Python objects not yet implemented");
       endif
 
+      ## Unpack multiple return values directly in a single call
+      if (nargout >= 2 && length (idx) == 1)
+        [varargout{1:nargout}] = pycall (x, t.subs{:});
+        return;
+      endif
+
       r = pycall (x, t.subs{:});
 
     case "{}"
@@ -107,6 +113,10 @@ function varargout = subsref (x, idx)
 
   ## deal with additional indexing (might be recursive)
   if (length (idx) > 1)
+    if (nargout >= 2)
+      [varargout{1:nargout}] = subsref (r, idx(2:end));
+      return;
+    endif
     r = subsref (r, idx(2:end));
   endif
 
@@ -118,7 +128,11 @@ function varargout = subsref (x, idx)
   elseif (nargout >= 2)
     assert (length (r) == nargout, ...
             "pyobject/subsref: number of outputs must match")
-    [varargout{1:nargout}] = subsref (r, struct ("type", "{}", "subs", {{1:nargout}}));
+    if (iscell (r))
+      varargout = r;
+    else
+      [varargout{1:nargout}] = pycall ("tuple", r);
+    endif
   endif
 endfunction
 
@@ -168,6 +182,21 @@ endfunction
 %! assert (a{2}, 12)
 %! assert (a{end}, 14)
 
+%!test
+%! % method call with multiple return values
+%! pyexec ("class _Pair:\n    def get(self):\n        return (1.0, 'two')");
+%! p = pyeval ("_Pair()");
+%! [a, b] = p.get ();
+%! assert (a, 1)
+%! assert (char (b), "two")
+
+%!test
+%! % tuple attribute unpacked into multiple outputs
+%! f = pyeval ("__import__('fractions').Fraction(3, 4)");
+%! [n, d] = f.as_integer_ratio ();
+%! assert (double (n), 3)
+%! assert (double (d), 4)
+
 %!test
 %! % dict: str key access
 %! d = pyeval ("{'one':1., 5:5, 6:6}");
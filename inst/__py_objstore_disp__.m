@@ -21,7 +21,8 @@
 ## -*- texinfo -*-
 ## @deftypefn  {} {} __py_objstore_disp__ ()
 ## @deftypefnx {} {@var{list} =} __py_objstore_disp__ ()
-## Print or return all Python objects and their ref counts in the object store.
+## Print or return all Python objects, their ref counts, and their sizes in the
+## object store.
 ##
 ## This is a private internal function not intended for direct use.
 ## @end deftypefn
@@ -42,16 +43,16 @@ function retval = __py_objstore_disp__ ()
     disp ("Python object store is empty")
   else
     disp ("Contents of the Python object store:\n")
-    disp ("  key            count  type          string snippet")
+    disp ("  key            count      bytes  type          value snippet")
     if (use_unicode)
-      disp ("  ───            ─────  ────          ──────────────")
+      disp ("  ───            ─────      ─────  ────          ─────────────")
     else
-      disp ("  ---            -----  ----          --------------")
+      disp ("  ---            -----      -----  ----          -------------")
     endif
   endif
 
   TypeLen = 12;
-  SnipLen = max (42, cols - (80 - 42)) - 2;
+  SnipLen = max (31, cols - (80 - 31)) - 2;
 
   for i = 1:sz
     snip = undo_string_escapes (x(i).value);
@@ -70,7 +71,8 @@ function retval = __py_objstore_disp__ ()
         type = [strtrunc(type, TypeLen - 3) "..."];
       endif
     endif
-    printf ("  %#.12x %5d  %-12s  %s\n", x(i).key, x(i).count, type, snip)
+    printf ("  %#.12x %5d %10s  %-12s  %s\n", x(i).key, x(i).count,
+            format_bytes (x(i).bytes), type, snip)
   endfor
   if (sz >= 1)
     disp ("")
@@ -78,5 +80,19 @@ function retval = __py_objstore_disp__ ()
 
 endfunction
 
+function str = format_bytes (n)
+  units = {"", "k", "M", "G", "T"};
+  k = 1;
+  while (n >= 1024 && k < numel (units))
+    n /= 1024;
+    k++;
+  endwhile
+  if (k == 1)
+    str = sprintf ("%d", n);
+  else
+    str = sprintf ("%.1f%s", n, units{k});
+  endif
+endfunction
+
 ## Mark this file as fully tested.
 %!assert (1)
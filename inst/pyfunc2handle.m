@@ -0,0 +1,103 @@
+## Copyright (C) 2019 Mike Miller
+## SPDX-License-Identifier: GPL-3.0-or-later
+##
+## This file is part of Octave Pythonic.
+##
+## Octave Pythonic is free software: you can redistribute it and/or modify
+## it under the terms of the GNU General Public License as published by
+## the Free Software Foundation, either version 3 of the License, or
+## (at your option) any later version.
+##
+## Octave Pythonic is distributed in the hope that it will be useful,
+## but WITHOUT ANY WARRANTY; without even the implied warranty of
+## MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+## GNU General Public License for more details.
+##
+## You should have received a copy of the GNU General Public License
+## along with Octave Pythonic; see the file COPYING.  If not, see
+## <https://www.gnu.org/licenses/>.
+
+## -*- texinfo -*-
+## @deftypefn {} {@var{fh} =} pyfunc2handle (@var{func})
+## Return an Octave function handle that calls the Python callable @var{func}.
+##
+## The function handle can be passed to any Octave function that accepts
+## one, such as @code{fzero}, @code{ode45}, or @code{arrayfun}.  Arguments
+## are converted to Python the same way as by @code{pycall}.  Python numbers
+## are returned as @code{double} values, and objects that implement the
+## buffer protocol or DLPack, such as NumPy arrays and CPU tensors, are
+## returned as Octave arrays of the matching type.  One-dimensional arrays
+## are returned as row vectors.
+##
+## For example, a Python function can be integrated with @code{quad}
+##
+## @example
+## @group
+## fh = pyfunc2handle (py.math.exp);
+## quad (fh, 0, 1)
+##       @result{} 1.7183
+## @end group
+## @end example
+## @seealso{pycall}
+## @end deftypefn
+
+function fh = pyfunc2handle (func)
+
+  if (nargin != 1)
+    print_usage ();
+  endif
+
+  if (! (isa (func, "pyobject") && pycall ("callable", func)))
+    error ("pyfunc2handle: FUNC must be a callable Python object");
+  endif
+
+  ## Capturing FUNC in the anonymous function keeps the Python object alive
+  ## for as long as the function handle exists.
+  fh = @(varargin) __py_handle_call__ (func, varargin{:});
+
+endfunction
+
+
+%!test
+%! fh = pyfunc2handle (py.math.sqrt);
+%! assert (is_function_handle (fh))
+%! assert (fh (4), 2)
+%! assert (class (fh (4)), "double")
+
+%!test
+%! fh = pyfunc2handle (pyeval ("lambda x: 2 * x"));
+%! assert (arrayfun (fh, [1, 2, 3]), [2, 4, 6])
+%! assert (fh (int8 (2)), 4)
+
+%!test
+%! fh = pyfunc2handle (pyeval ("lambda x: x ** 2 - 2"));
+%! assert (fzero (fh, [0, 2]), sqrt (2), 1e-8)
+
+%!test
+%! fh = pyfunc2handle (pyeval ("lambda: __import__('array').array('d', [1, 2, 3])"));
+%! assert (fh (), [1, 2, 3])
+
+%!test
+%! fh = pyfunc2handle (pyeval ("lambda: __import__('array').array('i', [1, 2, 3])"));
+%! assert (fh (), int32 ([1, 2, 3]))
+
+%!test
+%! fh = pyfunc2handle (pyeval ("lambda x: x > 0"));
+%! assert (fh (1), true)
+
+%!test
+%! fh = pyfunc2handle (pyeval ("lambda: None"));
+%! assert (fh (), [])
+
+%!test
+%! fh = pyfunc2handle (pyeval ("lambda: 'abc'"));
+%! assert (isa (fh (), "pyobject"))
+
+%!error <ZeroDivisionError>
+%! fh = pyfunc2handle (pyeval ("lambda x: 1 / x"));
+%! fh (0)
+
+%!error pyfunc2handle ()
+%!error pyfunc2handle (1, 2)
+%!error <FUNC must be a callable Python object> pyfunc2handle (1)
+%!error <FUNC must be a callable Python object> pyfunc2handle (pyeval ("None"))
@@ -0,0 +1,168 @@
+## Copyright (C) 2019 Mike Miller
+## SPDX-License-Identifier: GPL-3.0-or-later
+##
+## This file is part of Octave Pythonic.
+##
+## Octave Pythonic is free software: you can redistribute it and/or modify
+## it under the terms of the GNU General Public License as published by
+## the Free Software Foundation, either version 3 of the License, or
+## (at your option) any later version.
+##
+## Octave Pythonic is distributed in the hope that it will be useful,
+## but WITHOUT ANY WARRANTY; without even the implied warranty of
+## MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+## GNU General Public License for more details.
+##
+## You should have received a copy of the GNU General Public License
+## along with Octave Pythonic; see the file COPYING.  If not, see
+## <https://www.gnu.org/licenses/>.
+
+## -*- texinfo -*-
+## @documentencoding UTF-8
+## @deftypefn {} {@var{s} =} pystruct (@var{dict})
+## Create a struct-like view of a Python dict with on-demand field conversion.
+##
+## Fields of @var{s} are read with the usual @code{@var{s}.@var{name}}
+## syntax.  Each field is converted from the Python dict @var{dict} the first
+## time it is read, in the same way as @code{struct} converts it, and the
+## converted value is cached for later reads.  Fields that hold a dict are
+## returned as nested @code{pystruct} views.  Entries that are never read
+## are never converted.
+##
+## The view reflects the dict at the time each field is first read.  Use
+## @code{struct (@var{s})} to convert all remaining fields into an ordinary
+## Octave struct.
+##
+## A @code{pystruct} is also returned by @code{struct (@var{dict}, "lazy")}.
+##
+## Example:
+## @example
+## @group
+## d = pyeval ("@{'name': 'x', 'size': @{'rows': 2, 'cols': 3@}@}");
+## s = pystruct (d);
+## s.size.rows
+##   @result{} 2
+## @end group
+## @end example
+##
+## @seealso{pyobject, struct}
+## @end deftypefn
+
+
+classdef pystruct < handle
+  properties (Access = private)
+    m_dict
+    m_cache
+  endproperties
+
+
+  methods
+    function obj = pystruct (dict)
+      if (nargin != 1)
+        print_usage ();
+      endif
+
+      if (! (isa (dict, "pyobject") && isa (dict, "py.dict")))
+        error ("pystruct: DICT must be a Python dict");
+      endif
+
+      obj.m_dict = dict;
+      obj.m_cache = containers.Map ("KeyType", "char", "ValueType", "any");
+    endfunction
+
+    function varargout = subsref (obj, idx)
+      if (! strcmp (idx(1).type, "."))
+        error ("pystruct: only field access with '.' is supported");
+      endif
+
+      name = idx(1).subs;
+      if (isKey (obj.m_cache, name))
+        r = obj.m_cache(name);
+      else
+        [r, isdict] = __py_struct_field__ (obj.m_dict, name);
+        if (isdict)
+          r = pystruct (r);
+        endif
+        obj.m_cache(name) = r;
+      endif
+
+      if (numel (idx) > 1)
+        r = subsref (r, idx(2:end));
+      endif
+
+      varargout = {r};
+    endfunction
+
+    function s = struct (obj)
+      s = struct ();
+      names = fieldnames (obj);
+      for i = 1:numel (names)
+        r = subsref (obj, struct ("type", ".", "subs", names{i}));
+        if (isa (r, "pystruct"))
+          r = struct (r);
+        endif
+        s.(names{i}) = r;
+      endfor
+    endfunction
+
+    function names = fieldnames (obj)
+      names = __py_struct_field__ (obj.m_dict);
+    endfunction
+
+    function tf = isfield (obj, name)
+      tf = ismember (name, fieldnames (obj));
+    endfunction
+
+    function n = numfields (obj)
+      n = numel (fieldnames (obj));
+    endfunction
+
+    function disp (obj)
+      names = fieldnames (obj);
+      printf ("  pystruct with %d fields:\n\n", numel (names));
+      for i = 1:numel (names)
+        if (isKey (obj.m_cache, names{i}))
+          printf ("    %s\n", names{i});
+        else
+          printf ("    %s  (not converted)\n", names{i});
+        endif
+      endfor
+      printf ("\n");
+    endfunction
+
+  endmethods
+
+endclassdef
+
+
+%!test
+%! d = pyeval ("{'a': 1.5, 'b': {'c': 'x', 'd': {'e': True}}, 'l': [1, 2]}");
+%! s = pystruct (d);
+%! assert (fieldnames (s), {"a"; "b"; "l"})
+%! assert (numfields (s), 3)
+%! assert (isfield (s, "b"))
+%! assert (! isfield (s, "z"))
+%! assert (s.a, 1.5)
+%! assert (class (s.b), "pystruct")
+%! assert (char (s.b.c), "x")
+%! assert (s.b.d.e, true)
+%! assert (class (s.l), "py.list")
+
+## Fields are converted once and cached
+%!test
+%! d = pyeval ("{'a': 1.5}");
+%! s = pystruct (d);
+%! assert (s.a, 1.5)
+%! pycall ("operator.setitem", d, "a", 2.5);
+%! assert (s.a, 1.5)
+
+%!test
+%! d = pyeval ("{'a': 1.5, 'b': {'c': True}}");
+%! s = struct (pystruct (d));
+%! assert (s, struct ("a", 1.5, "b", struct ("c", true)))
+
+%!error pystruct ()
+%!error <DICT must be a Python dict> pystruct (struct ())
+%!error <DICT must be a Python dict> pystruct (pyeval ("[]"))
+%!error <only field access> subsref (pystruct (pyeval ("{}")), substruct ("()", {1}))
+%!error <no field named "z"> subsref (pystruct (pyeval ("{}")), substruct (".", "z"))
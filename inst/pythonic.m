@@ -22,12 +22,53 @@
 ## @deftypefnx {} {} pythonic help
 ## @deftypefnx {} {} pythonic gitlab
 ## @deftypefnx {} {} pythonic issue
+## @deftypefnx {} {} pythonic lazy
+## @deftypefnx {} {} pythonic lazy on
+## @deftypefnx {} {} pythonic lazy off
+## @deftypefnx {} {} pythonic memory
+## @deftypefnx {} {} pythonic memory on
+## @deftypefnx {} {} pythonic memory on @var{nframe}
+## @deftypefnx {} {} pythonic memory off
+## @deftypefnx {} {} pythonic memory clear
+## @deftypefnx {} {} pythonic objstore
+## @deftypefnx {} {} pythonic profile
+## @deftypefnx {} {} pythonic profile on
+## @deftypefnx {} {} pythonic profile on @var{interval}
+## @deftypefnx {} {} pythonic profile off
+## @deftypefnx {} {} pythonic profile clear
+## @deftypefnx {} {} pythonic profile save @var{file}
+## @deftypefnx {} {} pythonic remote
+## @deftypefnx {} {} pythonic remote @var{n}
+## @deftypefnx {} {} pythonic remote off
+## @deftypefnx {} {} pythonic slowlog
+## @deftypefnx {} {} pythonic slowlog on
+## @deftypefnx {} {} pythonic slowlog on @var{threshold}
+## @deftypefnx {} {} pythonic slowlog on @var{threshold} @var{n}
+## @deftypefnx {} {} pythonic slowlog off
+## @deftypefnx {} {} pythonic slowlog clear
+## @deftypefnx {} {} pythonic slowlog save @var{file}
+## @deftypefnx {} {} pythonic stats
+## @deftypefnx {} {} pythonic stats reset
+## @deftypefnx {} {} pythonic trace
+## @deftypefnx {} {} pythonic trace on
+## @deftypefnx {} {} pythonic trace on @var{n}
+## @deftypefnx {} {} pythonic trace off
+## @deftypefnx {} {} pythonic trace clear
+## @deftypefnx {} {} pythonic trace save @var{file}
 ## @deftypefnx {} {} pythonic update
 ## @deftypefnx {} {} pythonic version
 ## @deftypefnx {} {} pythonic versions
 ## @deftypefnx {} {} pythonic wiki
 ## @deftypefnx {} {@var{v} =} pythonic ("version")
 ## @deftypefnx {} {@var{v} =} pythonic ("versions")
+## @deftypefnx {} {@var{tf} =} pythonic ("lazy", @dots{})
+## @deftypefnx {} {@var{s} =} pythonic ("memory")
+## @deftypefnx {} {@var{s} =} pythonic ("objstore")
+## @deftypefnx {} {@var{stacks} =} pythonic ("profile")
+## @deftypefnx {} {@var{n} =} pythonic ("remote", @dots{})
+## @deftypefnx {} {@var{log} =} pythonic ("slowlog")
+## @deftypefnx {} {@var{s} =} pythonic ("stats")
+## @deftypefnx {} {@var{n} =} pythonic ("trace")
 ## Display useful information about the Pythonic package.
 ##
 ## With no arguments, display a summary description and simple examples
@@ -48,6 +89,120 @@
 ## @itemx @qcode{"bug"}
 ## Open a new issue on GitLab in the default web browser.
 ##
+## @item @qcode{"lazy"}
+## With @qcode{"on"}, pass cell arrays and structs to Python as read-only
+## views that convert each element or field when it is first accessed,
+## instead of converting the whole value to a tuple or dict up front.  A
+## cell array becomes a @code{collections.abc.Sequence} and a struct becomes
+## a @code{collections.abc.Mapping}.  This is faster when a Python function
+## only uses a few elements of a large cell array or struct.  With
+## @qcode{"off"}, convert eagerly again, which is the default.  With no
+## argument, display whether lazy conversion is enabled.
+##
+## @item @qcode{"memory"}
+## With @qcode{"on"}, start tracing Python memory allocations with the
+## Python @code{tracemalloc} module, storing @var{nframe} Python frames for
+## each allocation, 1 by default.  While tracing, the growth of the traced
+## memory over each call of @code{pycall}, @code{pyeval}, and @code{pyexec}
+## is added to the line of Octave code that made the call, not counting
+## growth already added to calls made from Octave callbacks during the call.
+## This shows which lines of Octave code leave Python memory allocated,
+## including memory of values converted from Octave.  With no argument,
+## display the size of the traced memory and its peak, the size of the
+## objects in the object store, the growth for each line of Octave code,
+## largest first, and the Python source lines with the most memory
+## allocated.  With an output argument, return these values as a struct
+## instead.  With @qcode{"off"}, stop tracing, which discards the traced
+## allocations, and with @qcode{"clear"}, discard the traced allocations
+## and the growth recorded for each line of Octave code.  If
+## @code{tracemalloc} was already tracing before @qcode{"on"}, its traces
+## are used as they are, @qcode{"clear"} does not discard them, and
+## @qcode{"off"} leaves it running.  Tracing slows Python down considerably
+## and is off by default.
+##
+## @item @qcode{"remote"}
+## Run Python code in separate worker processes instead of in the Octave
+## process.  With a number @var{n}, start @var{n} local Python worker
+## processes; @code{pycall}, @code{pyeval}, and @code{pyexec} are then
+## forwarded to the workers over a Unix domain socket, and large arrays are
+## passed through shared memory.  A crash in a Python extension module then
+## only terminates a worker, which is restarted on the next call.  Calls are
+## distributed across the workers, except that calls involving objects
+## returned by a worker are always sent to that worker.  Code run by
+## @code{pyexec} without a namespace is run by every worker.  With
+## @qcode{"off"}, stop all workers.  With no argument, display the number of
+## running workers.
+##
+## Numbers, strings, tuples of these, and arrays are returned by value, all
+## other Python objects remain in the worker and are returned as references.
+##
+## @item @qcode{"objstore"}
+## Display the number of Python objects referenced from Octave, the number
+## of references to them, their total size in bytes, the largest number of
+## objects referenced at any one time since the @qcode{"stats"} counters
+## were last reset, and the number and size of objects of each type,
+## largest first.  The size of an object is the size of its
+## data buffer if it has one, such as a NumPy array, otherwise the size
+## given by @code{sys.getsizeof}.  With an output argument, return these
+## values as a struct instead.
+##
+## @item @qcode{"profile"}
+## With @qcode{"on"}, start a sampling profiler that records the stack of
+## Python functions being run every @var{interval} seconds, 0.005 by
+## default, together with the Octave call stack at the point where Octave
+## called into Python.  This shows which lines of Octave code lead to the
+## most expensive Python code, which neither the Octave @code{profile}
+## function nor Python profilers can show on their own.  Samples are only
+## taken while Python code is running.  With @qcode{"save"}, write the
+## samples to @var{file} in the collapsed stack format used by
+## @code{flamegraph.pl} and speedscope, one stack per line followed by its
+## number of samples.  With @qcode{"off"}, stop sampling, and with
+## @qcode{"clear"}, discard the samples.  With no argument, display the
+## samples, or return them as a string with an output argument.
+##
+## @item @qcode{"slowlog"}
+## With @qcode{"on"}, log every call of @code{pycall}, @code{pyeval}, and
+## @code{pyexec}, including method calls, that takes at least
+## @var{threshold} seconds, 0.05 by default.  Each entry records the time of
+## the call, the Python function or code, the classes and dimensions of the
+## arguments, the number of bytes of argument data, the type of the return
+## value, the wall time of the call, and the part of it spent converting
+## values.  Only the most recent @var{n} calls are kept, 1000 by default.
+## With @qcode{"save"}, write the log to @var{file} as tab-separated text.
+## With @qcode{"off"}, stop logging, and with @qcode{"clear"}, discard the
+## logged calls.  With no argument, display the log, or return it as a
+## struct array with an output argument.
+##
+## @item @qcode{"stats"}
+## Display counters of the calls and conversions between Octave and Python
+## since the package was loaded or the counters were last reset.  The
+## counters include the number of calls to each Pythonic function, the
+## number of arguments converted from each Octave class and return values
+## converted from each Python type, the number of bytes of data copied, the
+## number of return values wrapped as @code{pyobject} because they have no
+## Octave equivalent, the number of exceptions raised in either direction,
+## the current and peak size of the Python object store, and the time spent
+## converting values, running Python code, and running Octave callbacks.
+## With an output argument, return the counters as a struct instead.  With
+## @qcode{"reset"}, set all counters to zero.  When the package is built
+## with @code{make AUDIT=1}, the growth in the number of allocated Python
+## memory blocks, and in the total reference count on debug builds of
+## Python, over the calls of each function is also shown, which helps to
+## find functions that leak Python objects.
+##
+## @item @qcode{"trace"}
+## With @qcode{"on"}, record every call to Python, evaluation of Python
+## code, conversion of arguments and return values, and Octave callback
+## with its start time, duration, thread, and a summary of the argument
+## types and sizes.  Only the most recent @var{n} events are kept, 100000
+## by default.  With @qcode{"save"}, write the recorded events to
+## @var{file} in the Chrome trace event format, which can be opened in
+## Perfetto (@url{https://ui.perfetto.dev}) or @code{chrome://tracing}.
+## With @qcode{"off"}, stop recording, and with @qcode{"clear"}, discard
+## the recorded events.  With no argument, display whether tracing is
+## enabled and how many events are recorded.  Tracing has no cost when it
+## is disabled, which is the default.
+##
 ## @item @qcode{"update"}
 ## Attempt to update to the latest available release of the Pythonic package.
 ##
@@ -59,9 +214,11 @@
 ## @end table
 ## @end deftypefn
 
-function varargout = pythonic (command)
+function varargout = pythonic (command, varargin)
 
-  if (nargin > 1)
+  subcommands_with_args = {"lazy", "memory", "profile", "remote", ...
+                           "slowlog", "stats", "trace"};
+  if (nargin > 1 && ! any (strcmp (command, subcommands_with_args)))
     print_usage ();
   endif
 
@@ -78,6 +235,54 @@ function varargout = pythonic (command)
       wiki ();
     case {"iss", "issu", "issue", "bug"}
       issue ();
+    case "lazy"
+      if (nargout == 0)
+        lazy (varargin{:});
+      else
+        varargout{1} = lazy (varargin{:});
+      endif
+    case "memory"
+      if (nargout == 0)
+        memory (varargin{:});
+      else
+        varargout{1} = memory (varargin{:});
+      endif
+    case "objstore"
+      if (nargout == 0)
+        objstore ();
+      else
+        varargout{1} = objstore ();
+      endif
+    case "profile"
+      if (nargout == 0)
+        profile (varargin{:});
+      else
+        varargout{1} = profile (varargin{:});
+      endif
+    case "remote"
+      if (nargout == 0)
+        remote (varargin{:});
+      else
+        varargout{1} = remote (varargin{:});
+      endif
+    case "slowlog"
+      if (nargout == 0)
+        slowlog (varargin{:});
+      else
+        varargout{1} = slowlog (varargin{:});
+      endif
+    case "stats"
+      if (nargout == 0)
+        stats (varargin{:});
+      else
+        varargout{1} = stats (varargin{:});
+      endif
+    case "trace"
+      if (nargout == 0)
+        trace (varargin{:});
+      else
+        varargout{1} = trace (varargin{:});
+      endif
     case {"up", "upd", "upda", "updat", "update"}
       update ();
     case "version"
@@ -129,6 +334,334 @@ function issue ()
   pythonic_web ("https://gitlab.com/mtmiller/octave-pythonic/issues/new");
 endfunction
 
+function tf = lazy (state)
+  if (nargin > 1)
+    print_usage ("pythonic");
+  endif
+
+  if (nargin == 1)
+    if (ischar (state) && any (strcmp (state, {"on", "off"})))
+      state = strcmp (state, "on");
+    elseif (! (isscalar (state) && (islogical (state) || isnumeric (state))))
+      error ("pythonic: lazy conversion must be \"on\" or \"off\"");
+    endif
+    __py_lazy__ (logical (state));
+  endif
+
+  enabled = __py_lazy__ ();
+  if (nargout == 0)
+    if (enabled)
+      disp ("Cell arrays and structs are passed to Python as lazy views")
+    else
+      disp ("Cell arrays and structs are converted to Python tuples and dicts")
+    endif
+  else
+    tf = enabled;
+  endif
+endfunction
+
+function s = memory (cmd, arg)
+  if (nargin == 0)
+    st = __py_memory__ ();
+    if (nargout > 0)
+      s = st;
+      return;
+    endif
+
+    if (st.enabled)
+      printf ("Python memory traced           %14d (peak %d)\n",
+              st.current, st.peak);
+    else
+      disp ("Python memory is not being traced")
+    endif
+    printf ("Bytes in object store          %14d\n", st.objstore);
+    if (! isempty (st.callers))
+      printf ("\n%-30s %10s %14s\n", "Octave caller", "Calls", "Growth");
+      for i = 1:numel (st.callers)
+        printf ("  %-28s %10d %14d\n", st.callers(i).name,
+                st.callers(i).calls, st.callers(i).bytes);
+      endfor
+    endif
+    if (! isempty (st.sites))
+      printf ("\n%-30s %10s %14s\n", "Python source line", "Blocks", "Bytes");
+      for i = 1:numel (st.sites)
+        site = sprintf ("%s:%d", st.sites(i).file, st.sites(i).line);
+        printf ("  %-28s %10d %14d\n", site, st.sites(i).count,
+                st.sites(i).bytes);
+      endfor
+    endif
+    return;
+  endif
+
+  switch (cmd)
+    case "on"
+      if (nargin < 2)
+        arg = 1;
+      elseif (ischar (arg))
+        arg = str2double (arg);
+      endif
+      if (! (isscalar (arg) && arg >= 1 && arg == fix (arg)))
+        error ("pythonic: number of traced frames must be a positive integer");
+      endif
+      __py_memory__ ("on", arg);
+    case {"off", "clear"}
+      if (nargin > 1)
+        print_usage ("pythonic");
+      endif
+      __py_memory__ (cmd);
+    otherwise
+      error ("pythonic: memory command must be \"on\", \"off\", or \"clear\"");
+  endswitch
+endfunction
+
+function s = objstore ()
+  st = __py_objstore_stats__ ();
+  if (nargout > 0)
+    s = st;
+    return;
+  endif
+
+  printf ("Python objects in object store %10d (peak %d)\n",
+          st.entries, st.peak);
+  printf ("References from Octave         %10d\n", st.references);
+  printf ("Bytes                          %10d\n", st.bytes);
+  if (! isempty (st.types))
+    printf ("\n%-30s %10s %14s\n", "Type", "Objects", "Bytes");
+    for i = 1:numel (st.types)
+      printf ("  %-28s %10d %14d\n", st.types(i).name, st.types(i).count,
+              st.types(i).bytes);
+    endfor
+  endif
+endfunction
+
+function stacks = profile (cmd, arg)
+  if (nargin == 0)
+    [text, enabled] = __py_profile__ ();
+    if (nargout > 0)
+      stacks = text;
+    elseif (! isempty (text))
+      printf ("%s", text);
+    elseif (enabled)
+      disp ("Profiling is on, no samples recorded")
+    else
+      disp ("Profiling is off, no samples recorded")
+    endif
+    return;
+  endif
+
+  switch (cmd)
+    case "on"
+      if (nargin < 2)
+        arg = 0.005;
+      elseif (ischar (arg))
+        arg = str2double (arg);
+      endif
+      if (! (isscalar (arg) && isreal (arg) && arg > 0))
+        error ("pythonic: profile sampling interval must be a positive number");
+      endif
+      __py_profile__ ("on", arg);
+    case {"off", "clear"}
+      if (nargin > 1)
+        print_usage ("pythonic");
+      endif
+      __py_profile__ (cmd);
+    case "save"
+      if (nargin < 2)
+        error ("pythonic: profile save requires a file name");
+      endif
+      fid = fopen (arg, "w");
+      if (fid < 0)
+        error ("pythonic: unable to open \"%s\" for writing", arg);
+      endif
+      unwind_protect
+        fputs (fid, __py_profile__ ());
+      unwind_protect_cleanup
+        fclose (fid);
+      end_unwind_protect
+    otherwise
+      error (["pythonic: profile command must be ", ...
+              "\"on\", \"off\", \"clear\", or \"save\""]);
+  endswitch
+endfunction
+
+function n = remote (nworkers)
+  if (nargin > 1)
+    print_usage ("pythonic");
+  endif
+
+  if (nargin == 1)
+    if (ischar (nworkers) && any (strcmp (nworkers, {"off", "stop"})))
+      nworkers = 0;
+    elseif (ischar (nworkers))
+      nworkers = str2double (nworkers);
+    endif
+    if (! (isscalar (nworkers) && nworkers >= 0 && nworkers == fix (nworkers)))
+      error (["pythonic: number of remote workers must be ", ...
+              "a non-negative integer"]);
+    endif
+    __py_remote__ (nworkers);
+  endif
+
+  nworkers = __py_remote__ ();
+  if (nargout == 0)
+    if (nworkers == 0)
+      disp ("Python code is evaluated in the Octave process")
+    else
+      printf ("Python code is evaluated by %d remote worker processes\n",
+              nworkers);
+    endif
+  else
+    n = nworkers;
+  endif
+endfunction
+
+function log = slowlog (cmd, varargin)
+  if (nargin == 0)
+    [entries, enabled] = __py_slowlog__ ();
+    if (nargout > 0)
+      log = entries;
+    elseif (isempty (entries))
+      if (enabled)
+        disp ("Slow calls are being logged, none recorded")
+      else
+        disp ("Slow calls are not being logged, none recorded")
+      endif
+    else
+      printf ("%10s %10s  %-8s %-32s %s\n", "time", "conversion",
+              "function", "target", "arguments");
+      for i = 1:numel (entries)
+        e = entries(i);
+        printf ("%10.6f %10.6f  %-8s %-32s %s\n", e.time, e.conversion,
+                e.function, e.target, e.arguments);
+      endfor
+    endif
+    return;
+  endif
+
+  switch (cmd)
+    case "on"
+      if (numel (varargin) > 2)
+        print_usage ("pythonic");
+      endif
+      opts = {0.05, 1000};
+      opts(1:numel (varargin)) = varargin;
+      for i = find (cellfun (@ischar, opts))
+        opts{i} = str2double (opts{i});
+      endfor
+      [threshold, n] = opts{:};
+      if (! (isscalar (threshold) && isreal (threshold) && threshold >= 0))
+        error ("pythonic: slow call threshold must be a non-negative number");
+      elseif (! (isscalar (n) && n >= 1 && n == fix (n)))
+        error ("pythonic: number of slow calls must be a positive integer");
+      endif
+      __py_slowlog__ ("on", threshold, n);
+    case {"off", "clear"}
+      if (nargin > 1)
+        print_usage ("pythonic");
+      endif
+      __py_slowlog__ (cmd);
+    case "save"
+      if (nargin < 2)
+        error ("pythonic: slowlog save requires a file name");
+      endif
+      __py_slowlog__ ("save", varargin{1});
+    otherwise
+      error (["pythonic: slowlog command must be ", ...
+              "\"on\", \"off\", \"clear\", or \"save\""]);
+  endswitch
+endfunction
+
+function s = stats (cmd)
+  if (nargin > 1)
+    print_usage ("pythonic");
+  endif
+
+  if (nargin == 1)
+    if (! strcmp (cmd, "reset"))
+      error ("pythonic: stats command must be \"reset\"");
+    endif
+    __py_stats__ ("reset");
+    return;
+  endif
+
+  st = __py_stats__ ();
+  if (nargout > 0)
+    s = st;
+    return;
+  endif
+
+  printf ("Time converting values         %10.6f s\n", st.time.conversion);
+  printf ("Time running Python code       %10.6f s\n", st.time.python);
+  printf ("Time running Octave callbacks  %10.6f s\n", st.time.octave);
+  printf ("Bytes copied                   %10d\n", st.bytes);
+  printf ("Values wrapped as pyobject     %10d\n", st.fallbacks);
+  printf ("Python exceptions raised       %10d\n", st.exceptions.python);
+  printf ("Octave errors raised in Python %10d\n", st.exceptions.octave);
+  printf ("Python objects in object store %10d (peak %d)\n",
+          st.objstore.size, st.objstore.peak);
+  print_counts ("Calls", st.calls);
+  print_counts ("Arguments by Octave class", st.arguments);
+  print_counts ("Return values by Python type", st.returns);
+  if (isfield (st, "audit") && ! isempty (st.audit))
+    printf ("\n%-30s %10s %10s %10s\n", "Growth of live Python objects:",
+            "calls", "blocks", "refs");
+    for i = 1:numel (st.audit)
+      printf ("  %-28s %10d %10d %10g\n", st.audit(i).name,
+              st.audit(i).calls, st.audit(i).blocks, st.audit(i).refs);
+    endfor
+  endif
+endfunction
+
+function n = trace (cmd, arg)
+  if (nargin == 0)
+    [enabled, nevents] = __py_trace__ ();
+    if (nargout > 0)
+      n = nevents;
+    elseif (enabled)
+      printf ("Tracing is on, %d events recorded\n", nevents);
+    else
+      printf ("Tracing is off, %d events recorded\n", nevents);
+    endif
+    return;
+  endif
+
+  switch (cmd)
+    case "on"
+      if (nargin < 2)
+        arg = 100000;
+      elseif (ischar (arg))
+        arg = str2double (arg);
+      endif
+      if (! (isscalar (arg) && arg >= 1 && arg == fix (arg)))
+        error ("pythonic: number of trace events must be a positive integer");
+      endif
+      __py_trace__ ("on", arg);
+    case {"off", "clear"}
+      if (nargin > 1)
+        print_usage ("pythonic");
+      endif
+      __py_trace__ (cmd);
+    case "save"
+      if (nargin < 2)
+        error ("pythonic: trace save requires a file name");
+      endif
+      __py_trace__ ("save", arg);
+    otherwise
+      error (["pythonic: trace command must be ", ...
+              "\"on\", \"off\", \"clear\", or \"save\""]);
+  endswitch
+endfunction
+
+function print_counts (title, counts)
+  if (isempty (counts))
+    return;
+  endif
+  printf ("\n%s:\n", title);
+  for i = 1:numel (counts)
+    printf ("  %-28s %10d\n", counts(i).name, counts(i).count);
+  endfor
+endfunction
+
 function update ()
   ver_curr = installed_version ();
   [ver_avail, url_avail] = most_recently_released_version ();
@@ -137,7 +670,8 @@ function update ()
     disp (sprintf ("Pythonic version %s is available, updating...", ver_avail))
     pkg ("install", url_avail);
   elseif (compare_versions (ver_curr, ver_avail, ">"))
-    disp (sprintf ("Pythonic version %s is higher than the latest official release, nothing to do", ver_curr))
+    disp (sprintf (["Pythonic version %s is higher than the latest ", ...
+                    "official release, nothing to do"], ver_curr))
   else
     disp (sprintf ("Pythonic version %s is already up to date, nothing to do", ver_curr))
   endif
@@ -220,3 +754,122 @@ endfunction
 
 %!error pythonic ("invalid")
 %!error pythonic ("versions", 2)
+%!error <must be a non-negative integer> pythonic ("remote", -1)
+%!error <must be a non-negative integer> pythonic ("remote", "many")
+%!error <must be "on" or "off"> pythonic ("lazy", "maybe")
+%!error <must be "on", "off"> pythonic ("memory", "start")
+%!error <positive integer> pythonic ("memory", "on", "0")
+%!error <must be "reset"> pythonic ("stats", "clear")
+%!error <must be "on", "off"> pythonic ("profile", "start")
+%!error <positive number> pythonic ("profile", "on", "-1")
+%!error <requires a file name> pythonic ("profile", "save")
+%!error <must be "on", "off"> pythonic ("slowlog", "start")
+%!error <non-negative number> pythonic ("slowlog", "on", "-1")
+%!error <positive integer> pythonic ("slowlog", "on", "1", "0.5")
+%!error <requires a file name> pythonic ("slowlog", "save")
+%!error <must be "on", "off"> pythonic ("trace", "start")
+%!error <positive integer> pythonic ("trace", "on", "0")
+%!error <requires a file name> pythonic ("trace", "save")
+
+%!test
+%! pythonic stats reset
+%! pycall ("len", {1, 2});
+%! s = pythonic ("stats");
+%! assert (s.calls(1).name, "pycall")
+%! assert (s.calls(1).count, 1)
+%! assert (any (strcmp ({s.arguments.name}, "cell")))
+%! pythonic stats reset
+%! s = pythonic ("stats");
+%! assert (isempty (s.calls))
+
+%!test
+%! pythonic profile on 0.001
+%! unwind_protect
+%!   pythonic profile clear
+%!   pyexec ("import time\nt = time.time()\nwhile time.time() - t < 0.1: pass");
+%!   file = tempname ();
+%!   pythonic ("profile", "save", file);
+%!   stacks = fileread (file);
+%!   delete (file);
+%!   assert (stacks, pythonic ("profile"))
+%!   assert (strncmp (stacks, "octave;", 7))
+%! unwind_protect_cleanup
+%!   pythonic profile off
+%!   pythonic profile clear
+%! end_unwind_protect
+
+%!test
+%! pythonic memory on
+%! unwind_protect
+%!   pythonic memory clear
+%!   x = pycall ("bytearray", 100000);
+%!   s = pythonic ("memory");
+%!   assert (s.enabled, true)
+%!   assert (s.current >= 100000)
+%!   assert (s.objstore >= 100000)
+%!   assert (sum ([s.callers.calls]), 1)
+%!   assert (s.callers(1).bytes >= 100000)
+%! unwind_protect_cleanup
+%!   pythonic memory off
+%!   pythonic memory clear
+%! end_unwind_protect
+%! s = pythonic ("memory");
+%! assert (s.enabled, false)
+
+%!test
+%! pyexec ("import tracemalloc; tracemalloc.start()");
+%! unwind_protect
+%!   pythonic memory on
+%!   pythonic memory off
+%!   assert (pyeval ("tracemalloc.is_tracing()"), true)
+%! unwind_protect_cleanup
+%!   pyexec ("tracemalloc.stop()");
+%! end_unwind_protect
+
+%!test
+%! x = pycall ("bytearray", 100);
+%! s = pythonic ("objstore");
+%! assert (s.entries >= 1)
+%! assert (any (strcmp ({s.types.name}, "bytearray")))
+
+%!test
+%! pythonic slowlog on 0 5
+%! unwind_protect
+%!   pythonic slowlog clear
+%!   pycall ("len", {1, 2});
+%!   log = pythonic ("slowlog");
+%!   assert (numel (log), 1)
+%!   assert (log.target, "builtins.len")
+%!   assert (log.arguments, "cell 1x2")
+%!   assert (log.result, "int")
+%! unwind_protect_cleanup
+%!   pythonic slowlog off
+%!   pythonic slowlog clear
+%! end_unwind_protect
+
+%!test
+%! pythonic trace on 1000
+%! unwind_protect
+%!   pythonic trace clear
+%!   pycall ("len", {1, 2});
+%!   assert (pythonic ("trace") > 0)
+%!   file = [tempname(), ".json"];
+%!   pythonic ("trace", "save", file);
+%!   assert (exist (file, "file"), 2)
+%!   delete (file);
+%! unwind_protect_cleanup
+%!   pythonic trace off
+%!   pythonic trace clear
+%! end_unwind_protect
+%! assert (pythonic ("trace"), 0)
+
+%!test
+%! old = pythonic ("lazy");
+%! unwind_protect
+%!   assert (pythonic ("lazy", "on"), true)
+%!   assert (class (pyobject ({1, 2})), "py.pythonic.OctaveCell")
+%!   assert (pythonic ("lazy", "off"), false)
+%!   assert (class (pyobject ({1, 2})), "py.tuple")
+%! unwind_protect_cleanup
+%!   pythonic ("lazy", old);
+%! end_unwind_protect
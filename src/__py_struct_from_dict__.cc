@@ -32,15 +32,67 @@ along with Octave Pythonic; see the file COPYING.  If not, see
 #endif
 
 #include <cinttypes>
+#include <list>
 
 #include <Python.h>
 #include <octave/oct.h>
 
+#include "oct-py-buffer.h"
+#include "oct-py-eval.h"
 #include "oct-py-init.h"
+#include "oct-py-lazy.h"
+#include "oct-py-memory.h"
 #include "oct-py-object.h"
+#include "oct-py-profile.h"
+#include "oct-py-remote.h"
+#include "oct-py-slowlog.h"
+#include "oct-py-sparse.h"
+#include "oct-py-stats.h"
+#include "oct-py-trace.h"
 #include "oct-py-types.h"
 #include "oct-py-util.h"
 
+// PKG_ADD: autoload ("__py_cellstr_value__", "__py_struct_from_dict__.oct");
+// PKG_DEL: autoload ("__py_cellstr_value__", which ("__py_struct_from_dict__.oct"), "remove");
+DEFUN_DLD (__py_cellstr_value__, args, ,
+           R"doc(-*- texinfo -*-
+@deftypefn {} {} __py_cellstr_value__ (@var{obj})
+Return the items of the Python sequence of strings @var{obj} as a column
+cell array of strings.
+
+This is a private internal function not intended for direct use.
+@end deftypefn)doc")
+{
+  pythonic::py_stats_call call ("__py_cellstr_value__");
+
+  if (args.length () != 1)
+    print_usage ();
+
+  if (! (args(0).isobject () && args(0).class_name () == "pyobject"))
+    error ("pyobject.cellstr: argument must be a valid Python object");
+
+  pythonic::py_init ();
+
+  pythonic::python_object obj = pythonic::pyobject_unwrap_object (args(0));
+
+  return ovl (pythonic::extract_py_cellstr (obj));
+}
+
+/*
+%!assert (__py_cellstr_value__ (pyeval ("[]")), cell (0, 1))
+%!assert (__py_cellstr_value__ (pyeval ("['a', 'bc', '']")), {"a"; "bc"; ""})
+%!assert (__py_cellstr_value__ (pyeval ("('a', b'bc')")), {"a"; "bc"})
+%!assert (__py_cellstr_value__ (pyeval ("'abc'")), {"abc"})
+%!assert (__py_cellstr_value__ (pyeval ("iter(['x', 'y'])")), {"x"; "y"})
+%!assert (__py_cellstr_value__ (pyeval ("['\\u00e9t\\u00e9', 'x' * 20]")), {"été"; repmat("x", 1, 20)})
+
+%!error __py_cellstr_value__ ()
+%!error __py_cellstr_value__ (pyeval ("[]"), 2)
+%!error <must be a valid Python object> __py_cellstr_value__ ({"a"})
+%!error <item 2 is of type "int"> __py_cellstr_value__ (pyeval ("['a', 1]"))
+%!error <must be iterable> __py_cellstr_value__ (pyeval ("None"))
+*/
+
 // PKG_ADD: autoload ("__py_class_name__", "__py_struct_from_dict__.oct");
 // PKG_DEL: autoload ("__py_class_name__", which ("__py_struct_from_dict__.oct"), "remove");
 DEFUN_DLD (__py_class_name__, args, ,
@@ -51,6 +103,8 @@ Return the name of the class of the Python object @var{obj}.
 This is a private internal function not intended for direct use.
 @end deftypefn)doc")
 {
+  pythonic::py_stats_call call ("__py_class_name__");
+
   if (args.length () != 1)
     print_usage ();
 
@@ -81,6 +135,82 @@ This is a private internal function not intended for direct use.
 %!error __py_class_name__ (1, 2)
 */
 
+// Convert the return value of a Python function called through a function
+// handle.  Numbers and arrays become Octave numeric values directly.
+
+static octave_value
+py_handle_return_value (PyObject *obj)
+{
+  if (obj == Py_None)
+    return octave_value (Matrix ());
+  else if (PyBool_Check (obj))
+    return octave_value (obj == Py_True);
+  else if (PyFloat_Check (obj))
+    return octave_value (PyFloat_AsDouble (obj));
+  else if (PyComplex_Check (obj))
+    return octave_value (pythonic::extract_py_complex (obj));
+  else if (PyLong_Check (obj))
+    {
+      double d = PyLong_AsDouble (obj);
+      if (! (d == -1.0 && PyErr_Occurred ()))
+        return octave_value (d);
+      PyErr_Clear ();
+    }
+#if PY_VERSION_HEX < 0x03000000
+  else if (PyInt_Check (obj))
+    return octave_value (static_cast<double> (PyInt_AsLong (obj)));
+#endif
+  else if (pythonic::py_is_buffer (obj))
+    return pythonic::extract_py_buffer (obj);
+  else if (pythonic::py_is_dlpack (obj))
+    return pythonic::extract_py_dlpack (obj);
+  else if (pythonic::py_is_sparse (obj))
+    return pythonic::extract_py_sparse (obj);
+  else if (pythonic::py_is_lazy_view (obj))
+    return pythonic::extract_py_lazy_view (obj);
+
+  return pythonic::py_implicitly_convert_return_value (obj);
+}
+
+// PKG_ADD: autoload ("__py_handle_call__", "__py_struct_from_dict__.oct");
+// PKG_DEL: autoload ("__py_handle_call__", which ("__py_struct_from_dict__.oct"), "remove");
+DEFUN_DLD (__py_handle_call__, args, ,
+           R"doc(-*- texinfo -*-
+@deftypefn {} {} __py_handle_call__ (@var{func}, @dots{})
+Call the Python function @var{func} with the remaining arguments.
+
+This is a private internal function not intended for direct use.
+@end deftypefn)doc")
+{
+  pythonic::py_stats_call call ("__py_handle_call__");
+
+  int nargin = args.length ();
+
+  if (nargin < 1)
+    print_usage ();
+
+  if (! (args(0).isobject () && args(0).class_name () == "pyobject"))
+    error ("__py_handle_call__: FUNC must be a Python object");
+
+  pythonic::py_init ();
+
+  pythonic::python_object callable = pythonic::pyobject_unwrap_object (args(0));
+  if (! callable)
+    error ("__py_handle_call__: no existing Python object found for FUNC");
+
+  octave_value_list arglist = args.slice (1, nargin - 1);
+  pythonic::python_object res = pythonic::py_call_function (callable, arglist);
+
+  return ovl (py_handle_return_value (res));
+}
+
+/*
+%!assert (__py_handle_call__ (pyeval ("lambda x, y: x + y"), 1, 2), 3)
+
+%!error __py_handle_call__ ()
+%!error <FUNC must be a Python object> __py_handle_call__ (1)
+*/
+
 // PKG_ADD: autoload ("__py_int64_scalar_value__", "__py_struct_from_dict__.oct");
 // PKG_DEL: autoload ("__py_int64_scalar_value__", which ("__py_struct_from_dict__.oct"), "remove");
 DEFUN_DLD (__py_int64_scalar_value__, args, ,
@@ -91,6 +221,8 @@ Extract a scalar int64 value from the Python integer @var{x}.
 This is a private internal function not intended for direct use.
 @end deftypefn)doc")
 {
+  pythonic::py_stats_call call ("__py_int64_scalar_value__");
+
   if (args.length () != 1)
     print_usage ();
 
@@ -128,6 +260,8 @@ Extract a scalar uint64 value from the Python integer @var{x}.
 This is a private internal function not intended for direct use.
 @end deftypefn)doc")
 {
+  pythonic::py_stats_call call ("__py_uint64_scalar_value__");
+
   if (args.length () != 1)
     print_usage ();
 
@@ -164,6 +298,8 @@ Check whether the Python object @var{obj} is the @code{None} object.
 This is a private internal function not intended for direct use.
 @end deftypefn)doc")
 {
+  pythonic::py_stats_call call ("__py_is_none__");
+
   if (args.length () != 1)
     print_usage ();
 
@@ -210,6 +346,8 @@ __py_isinstance__ (py.list, "py.no.such.object")
 This is a private internal function not intended for direct use.
 @end deftypefn)doc")
 {
+  pythonic::py_stats_call call ("__py_isinstance__");
+
   octave_value_list retval;
 
   int nargin = args.length ();
@@ -257,6 +395,178 @@ This is a private internal function not intended for direct use.
 %!error <must be a string> __py_isinstance__ (pyeval ("None"), "object")
 */
 
+// PKG_ADD: autoload ("__py_lazy__", "__py_struct_from_dict__.oct");
+// PKG_DEL: autoload ("__py_lazy__", which ("__py_struct_from_dict__.oct"), "remove");
+DEFUN_DLD (__py_lazy__, args, ,
+           R"doc(-*- texinfo -*-
+@deftypefn  {} {@var{tf} =} __py_lazy__ ()
+@deftypefnx {} {@var{tf} =} __py_lazy__ (@var{enable})
+Query or set whether cell arrays and structs are passed to Python as lazy views.
+
+This is a private internal function not intended for direct use.
+@end deftypefn)doc")
+{
+  pythonic::py_stats_call call ("__py_lazy__");
+
+  int nargin = args.length ();
+
+  if (nargin > 1)
+    print_usage ();
+
+  if (nargin == 1)
+    pythonic::py_set_lazy_conversion (args(0).xbool_value ("__py_lazy__: ENABLE must be a logical value"));
+
+  return ovl (pythonic::py_lazy_conversion ());
+}
+
+/*
+%!test
+%! old = __py_lazy__ ();
+%! unwind_protect
+%!   __py_lazy__ (true);
+%!   s = struct ("a", 1, "b", {{"x", 2}}, "c", "str");
+%!   p = pyobject (s);
+%!   assert (class (p), "py.pythonic.OctaveStruct")
+%!   assert (pycall ("isinstance", p, py.collections.abc.Mapping))
+%!   assert (double (pycall ("len", p)), 3)
+%!   assert (p{"a"}, 1)
+%!   assert (char (p{"c"}), "str")
+%!   assert (char (pycall ("str", pycall ("sorted", p))), "['a', 'b', 'c']")
+%!   b = p{"b"};
+%!   assert (class (b), "py.pythonic.OctaveCell")
+%!   assert (char (b{1}), "x")
+%!   assert (b{2}, 2)
+%!   assert (char (pycall ("repr", pycall ("tuple", b))), "('x', 2.0)")
+%!   assert (struct (p), s)
+%!   assert (pycall ("operator.contains", p, "a"))
+%!   assert (! pycall ("operator.contains", p, "z"))
+%!   r = pycall ("operator.getitem", b, pyeval ("slice(None, None, -1)"));
+%!   assert (char (pycall ("repr", r)), "(2.0, 'x')")
+%! unwind_protect_cleanup
+%!   __py_lazy__ (old);
+%! end_unwind_protect
+
+## Views can only be read from the thread that created them
+%!test
+%! pyexec (["import concurrent.futures\n" ...
+%!          "def _pythonic_lazy_in_thread(view, key):\n" ...
+%!          "    with concurrent.futures.ThreadPoolExecutor(1) as pool:\n" ...
+%!          "        try:\n" ...
+%!          "            pool.submit(view.__getitem__, key).result()\n" ...
+%!          "        except RuntimeError as e:\n" ...
+%!          "            return str(e)\n" ...
+%!          "    return ''"]);
+%! old = __py_lazy__ ();
+%! unwind_protect
+%!   __py_lazy__ (true);
+%!   c = pyobject ({1, 2});
+%!   s = pyobject (struct ("a", 1));
+%!   msg = char (pycall ("_pythonic_lazy_in_thread", c, 0));
+%!   assert (msg, "Octave cell arrays and structs can only be accessed from the thread that created them")
+%!   msg = char (pycall ("_pythonic_lazy_in_thread", s, "a"));
+%!   assert (! isempty (strfind (msg, "thread that created them")))
+%! unwind_protect_cleanup
+%!   __py_lazy__ (old);
+%!   pyexec ("del _pythonic_lazy_in_thread");
+%! end_unwind_protect
+
+%!error __py_lazy__ (1, 2)
+%!error <ENABLE must be a logical value> __py_lazy__ ("on")
+*/
+
+// PKG_ADD: autoload ("__py_memory__", "__py_struct_from_dict__.oct");
+// PKG_DEL: autoload ("__py_memory__", which ("__py_struct_from_dict__.oct"), "remove");
+DEFUN_DLD (__py_memory__, args, ,
+           R"doc(-*- texinfo -*-
+@deftypefn  {} {@var{s} =} __py_memory__ ()
+@deftypefnx {} {@var{s} =} __py_memory__ (@var{n})
+@deftypefnx {} {} __py_memory__ ("on", @var{nframe})
+@deftypefnx {} {} __py_memory__ ("off")
+@deftypefnx {} {} __py_memory__ ("clear")
+Control the tracing of Python memory allocations with tracemalloc.
+
+With no arguments or a number, return a snapshot of the traced memory as a
+struct, with at most @var{n} Python source lines, 10 by default.
+
+This is a private internal function not intended for direct use.
+@end deftypefn)doc")
+{
+  int nargin = args.length ();
+
+  if (nargin > 2)
+    print_usage ();
+
+  pythonic::py_init ();
+
+  if (nargin == 0 || (nargin == 1 && ! args(0).is_string ()))
+    {
+      int limit = 10;
+      if (nargin == 1)
+        limit = args(0).xint_value ("__py_memory__: N must be a non-negative integer");
+      if (limit < 0)
+        error ("__py_memory__: N must be a non-negative integer");
+      return ovl (pythonic::py_memory_snapshot (limit));
+    }
+
+  std::string cmd = args(0).xstring_value ("__py_memory__: argument must be a string");
+
+  if (cmd == "on" && nargin == 2)
+    {
+      int nframe = args(1).xint_value ("__py_memory__: NFRAME must be a positive integer");
+      if (nframe < 1)
+        error ("__py_memory__: NFRAME must be a positive integer");
+      pythonic::py_memory_start (nframe);
+    }
+  else if (cmd == "off" && nargin == 1)
+    pythonic::py_memory_stop ();
+  else if (cmd == "clear" && nargin == 1)
+    pythonic::py_memory_clear ();
+  else
+    error ("__py_memory__: invalid command \"%s\"", cmd.c_str ());
+
+  return ovl ();
+}
+
+/*
+%!function __py_memory_test_caller__ ()
+%!  pyexec ("_pythonic_memory_test.append(bytearray(1000000))");
+%!endfunction
+
+%!test
+%! pyexec ("_pythonic_memory_test = []");
+%! __py_memory__ ("on", 1);
+%! unwind_protect
+%!   __py_memory__ ("clear");
+%!   __py_memory_test_caller__ ();
+%!   s = __py_memory__ (5);
+%!   assert (s.enabled, true)
+%!   assert (s.current >= 1000000)
+%!   assert (s.peak >= s.current)
+%!   assert (s.objstore >= 0)
+%!   idx = find (strncmp ({s.callers.name}, "__py_memory_test_caller__:", 26));
+%!   assert (numel (idx), 1)
+%!   assert (s.callers(idx).calls, 1)
+%!   assert (s.callers(idx).bytes >= 1000000)
+%!   assert (numel (s.sites) <= 5)
+%!   assert (s.sites(1).bytes >= 1000000)
+%! unwind_protect_cleanup
+%!   __py_memory__ ("off");
+%!   __py_memory__ ("clear");
+%!   pyexec ("del _pythonic_memory_test");
+%! end_unwind_protect
+%! s = __py_memory__ ();
+%! assert (s.enabled, false)
+%! assert (s.current, 0)
+%! assert (numel (s.callers), 0)
+%! assert (numel (s.sites), 0)
+
+%!error __py_memory__ (1, 2, 3)
+%!error <invalid command> __py_memory__ ("start")
+%!error <invalid command> __py_memory__ ("on")
+%!error <non-negative integer> __py_memory__ (-1)
+%!error <positive integer> __py_memory__ ("on", 0)
+*/
+
 // PKG_ADD: autoload ("__py_objstore_clear__", "__py_struct_from_dict__.oct");
 // PKG_DEL: autoload ("__py_objstore_clear__", which ("__py_struct_from_dict__.oct"), "remove");
 DEFUN_DLD (__py_objstore_clear__, , ,
@@ -270,6 +580,8 @@ valid.
 This is a private internal function not intended for direct use.
 @end deftypefn)doc")
 {
+  pythonic::py_stats_call call ("__py_objstore_clear__");
+
   pythonic::py_init ();
 
   pythonic::py_objstore_clear ();
@@ -289,6 +601,8 @@ If there are no more references, this will delete the object.
 This is a private internal function not intended for direct use.
 @end deftypefn)doc")
 {
+  pythonic::py_stats_call call ("__py_objstore_drop__");
+
   if (args.length () != 1)
     print_usage ();
 
@@ -310,6 +624,8 @@ Get the Python object stored under @var{key} from the object store.
 This is a private internal function not intended for direct use.
 @end deftypefn)doc")
 {
+  pythonic::py_stats_call call ("__py_objstore_get__");
+
   if (args.length () != 1)
     print_usage ();
 
@@ -336,6 +652,8 @@ Convert @var{value} to a Python value and store in the object store.
 This is a private internal function not intended for direct use.
 @end deftypefn)doc")
 {
+  pythonic::py_stats_call call ("__py_objstore_put__");
+
   if (args.length () != 1)
     print_usage ();
 
@@ -346,7 +664,7 @@ This is a private internal function not intended for direct use.
   if (! obj)
     error ("__py_objstore_put__: VALUE must be convertible to a Python value");
 
-  uint64_t key = pythonic::py_objstore_put (obj.release ());
+  uint64_t key = pythonic::py_objstore_put (obj);
 
   return ovl (octave_uint64 (key));
 }
@@ -361,6 +679,8 @@ Store None in the object store and return its index.
 This is a private internal function not intended for direct use.
 @end deftypefn)doc")
 {
+  pythonic::py_stats_call call ("__py_objstore_put_none__");
+
   pythonic::py_init ();
 
   uint64_t key = pythonic::py_objstore_put (Py_None);
@@ -378,6 +698,8 @@ Return all Python objects and their ref counts in the object store.
 This is a private internal function not intended for direct use.
 @end deftypefn)doc")
 {
+  pythonic::py_stats_call call ("__py_objstore_list__");
+
   pythonic::py_init ();
 
   octave_map map = pythonic::py_objstore_list ();
@@ -385,6 +707,425 @@ This is a private internal function not intended for direct use.
   return ovl (map);
 }
 
+/*
+%!test
+%! x = pyeval ("'abc' * 10000");
+%! y = pycall ("bytearray", 4096);
+%! z = pyeval ("list(range(100000))");
+%! list = __py_objstore_list__ ();
+%! e = list([list.key] == id (x));
+%! assert (e.type, "str")
+%! assert (e.value, [repmat("abc", 1, 332), "a..."])
+%! assert (e.bytes > 30000)
+%! assert (e.age >= 0)
+%! e = list([list.key] == id (y));
+%! assert (e.type, "bytearray")
+%! assert (e.bytes, 4096)
+%! assert (e.value, ["bytearray(b'", repmat('\x00', 1, 1000), "')..."])
+%! e = list([list.key] == id (z));
+%! assert (e.value, "[0, 1, 2, 3, 4, 5, ...]")
+
+## The repr of a large object of an unknown type is never called
+%!test
+%! pyexec (["class _PythonicBig(object):\n" ...
+%!          "    def __len__(self): return 10**6\n" ...
+%!          "    def __repr__(self): raise RuntimeError('full repr')"]);
+%! x = pyeval ("_PythonicBig()");
+%! pyexec ("del _PythonicBig");
+%! list = __py_objstore_list__ ();
+%! e = list([list.key] == id (x));
+%! assert (e.value, "<_PythonicBig of size 1000000>")
+*/
+
+// PKG_ADD: autoload ("__py_objstore_stats__", "__py_struct_from_dict__.oct");
+// PKG_DEL: autoload ("__py_objstore_stats__", which ("__py_struct_from_dict__.oct"), "remove");
+DEFUN_DLD (__py_objstore_stats__, , ,
+           R"doc(-*- texinfo -*-
+@deftypefn {} {@var{s} =} __py_objstore_stats__ ()
+Return the number and size of the Python objects in the object store.
+
+This is a private internal function not intended for direct use.
+@end deftypefn)doc")
+{
+  pythonic::py_init ();
+
+  return ovl (pythonic::py_objstore_stats ());
+}
+
+/*
+%!test
+%! x = pycall ("bytearray", 1000000);
+%! s = __py_objstore_stats__ ();
+%! assert (s.entries >= 1)
+%! assert (s.references >= s.entries)
+%! assert (s.bytes >= 1000000)
+%! assert (s.peak >= s.entries)
+%! assert (s.types(1).name, "bytearray")
+%! assert (s.types(1).bytes >= 1000000)
+%! assert (sum ([s.types.count]), s.entries)
+%! assert (sum ([s.types.bytes]), s.bytes)
+*/
+
+// PKG_ADD: autoload ("__py_profile__", "__py_struct_from_dict__.oct");
+// PKG_DEL: autoload ("__py_profile__", which ("__py_struct_from_dict__.oct"), "remove");
+DEFUN_DLD (__py_profile__, args, ,
+           R"doc(-*- texinfo -*-
+@deftypefn  {} {[@var{stacks}, @var{tf}] =} __py_profile__ ()
+@deftypefnx {} {} __py_profile__ ("on", @var{interval})
+@deftypefnx {} {} __py_profile__ ("off")
+@deftypefnx {} {} __py_profile__ ("clear")
+Control the sampling profiler of Python code called from Octave.
+
+With no arguments, return the samples in collapsed stack format and
+whether the profiler is running.
+
+This is a private internal function not intended for direct use.
+@end deftypefn)doc")
+{
+  int nargin = args.length ();
+
+  if (nargin > 2)
+    print_usage ();
+
+  pythonic::py_init ();
+
+  if (nargin == 0)
+    return ovl (pythonic::py_profile_collapsed (),
+                pythonic::py_profile.enabled ());
+
+  std::string cmd = args(0).xstring_value ("__py_profile__: argument must be a string");
+
+  if (cmd == "on" && nargin == 2)
+    {
+      double interval = args(1).xdouble_value ("__py_profile__: INTERVAL must be a positive number");
+      if (! (interval > 0))
+        error ("__py_profile__: INTERVAL must be a positive number");
+      pythonic::py_profile_start (interval);
+    }
+  else if (cmd == "off" && nargin == 1)
+    pythonic::py_profile_stop ();
+  else if (cmd == "clear" && nargin == 1)
+    pythonic::py_profile_clear ();
+  else
+    error ("__py_profile__: invalid command \"%s\"", cmd.c_str ());
+
+  return ovl ();
+}
+
+/*
+%!function __py_profile_test_caller__ ()
+%!  pyexec ("import time\nt = time.time()\nwhile time.time() - t < 0.2: pass");
+%!endfunction
+
+%!test
+%! __py_profile__ ("on", 0.001);
+%! unwind_protect
+%!   __py_profile__ ("clear");
+%!   __py_profile_test_caller__ ();
+%!   [stacks, tf] = __py_profile__ ();
+%!   assert (tf, true)
+%! unwind_protect_cleanup
+%!   __py_profile__ ("off");
+%! end_unwind_protect
+%! assert (! isempty (regexp (stacks, "^octave;.*__py_profile_test_caller__:\\d+;pyexec;<module> \\(<string>:3\\) \\d+$", "lineanchors")))
+%! [~, tf] = __py_profile__ ();
+%! assert (tf, false)
+%! __py_profile__ ("clear");
+%! assert (__py_profile__ (), "")
+
+%!error __py_profile__ (1, 2, 3)
+%!error <must be a string> __py_profile__ (1)
+%!error <invalid command> __py_profile__ ("start")
+%!error <invalid command> __py_profile__ ("on")
+%!error <positive number> __py_profile__ ("on", 0)
+*/
+
+// PKG_ADD: autoload ("__py_remote__", "__py_struct_from_dict__.oct");
+// PKG_DEL: autoload ("__py_remote__", which ("__py_struct_from_dict__.oct"), "remove");
+DEFUN_DLD (__py_remote__, args, ,
+           R"doc(-*- texinfo -*-
+@deftypefn  {} {@var{n} =} __py_remote__ ()
+@deftypefnx {} {@var{n} =} __py_remote__ (@var{nworkers})
+Start or stop out-of-process Python workers and return how many are running.
+
+With @var{nworkers} greater than zero, start that many worker processes,
+replacing any that are already running.  With @var{nworkers} equal to zero,
+stop all workers and return to evaluating Python code in the Octave process.
+
+This is a private internal function not intended for direct use.
+@end deftypefn)doc")
+{
+  pythonic::py_stats_call call ("__py_remote__");
+
+  int nargin = args.length ();
+
+  if (nargin > 1)
+    print_usage ();
+
+  pythonic::py_init ();
+
+  if (nargin == 1)
+    {
+      int n = args(0).xint_value ("__py_remote__: NWORKERS must be an integer");
+      if (n < 0)
+        error ("__py_remote__: NWORKERS must be a non-negative integer");
+
+      if (n == 0)
+        pythonic::py_remote_stop ();
+      else
+        pythonic::py_remote_start (n);
+    }
+
+  return ovl (static_cast<double> (pythonic::py_remote_workers ()));
+}
+
+/*
+%!assert (__py_remote__ (), 0)
+
+%!error __py_remote__ (1, 2)
+%!error <must be a non-negative integer> __py_remote__ (-1)
+*/
+
+// PKG_ADD: autoload ("__py_slowlog__", "__py_struct_from_dict__.oct");
+// PKG_DEL: autoload ("__py_slowlog__", which ("__py_struct_from_dict__.oct"), "remove");
+DEFUN_DLD (__py_slowlog__, args, ,
+           R"doc(-*- texinfo -*-
+@deftypefn  {} {[@var{log}, @var{tf}] =} __py_slowlog__ ()
+@deftypefnx {} {} __py_slowlog__ ("on", @var{threshold}, @var{capacity})
+@deftypefnx {} {} __py_slowlog__ ("off")
+@deftypefnx {} {} __py_slowlog__ ("clear")
+@deftypefnx {} {} __py_slowlog__ ("save", @var{file})
+Control the log of slow calls of @code{pycall}, @code{pyeval}, and
+@code{pyexec}.
+
+With no arguments, return the logged calls as a struct array and whether
+calls are being logged.
+
+This is a private internal function not intended for direct use.
+@end deftypefn)doc")
+{
+  int nargin = args.length ();
+
+  if (nargin > 3)
+    print_usage ();
+
+  if (nargin == 0)
+    return ovl (pythonic::py_slowlog_entries (), pythonic::py_slowlog.enabled ());
+
+  std::string cmd = args(0).xstring_value ("__py_slowlog__: argument must be a string");
+
+  if (cmd == "on" && nargin == 3)
+    {
+      double threshold = args(1).xdouble_value ("__py_slowlog__: THRESHOLD must be a non-negative number");
+      if (! (threshold >= 0))
+        error ("__py_slowlog__: THRESHOLD must be a non-negative number");
+      int capacity = args(2).xint_value ("__py_slowlog__: CAPACITY must be a positive integer");
+      if (capacity < 1)
+        error ("__py_slowlog__: CAPACITY must be a positive integer");
+      pythonic::py_slowlog_start (threshold, capacity);
+    }
+  else if (cmd == "off" && nargin == 1)
+    pythonic::py_slowlog_stop ();
+  else if (cmd == "clear" && nargin == 1)
+    pythonic::py_slowlog_clear ();
+  else if (cmd == "save" && nargin == 2)
+    {
+      std::string file = args(1).xstring_value ("__py_slowlog__: FILE must be a string");
+      pythonic::py_slowlog_save (file);
+    }
+  else
+    error ("__py_slowlog__: invalid command \"%s\"", cmd.c_str ());
+
+  return ovl ();
+}
+
+/*
+%!test
+%! __py_slowlog__ ("on", 0.05, 10);
+%! unwind_protect
+%!   __py_slowlog__ ("clear");
+%!   pycall ("len", [1, 2, 3]);
+%!   pycall ("time.sleep", 0.06);
+%!   pyexec ("import time; time.sleep(0.06)");
+%!   x = pyeval ("len([1, 2])");
+%!   [log, tf] = __py_slowlog__ ();
+%!   assert (tf, true)
+%!   assert (numel (log), 2)
+%!   assert (log(1).function, "pycall")
+%!   assert (log(1).target, "time.sleep")
+%!   assert (log(1).arguments, "double 1x1")
+%!   assert (log(1).bytes, 8)
+%!   assert (log(1).result, "NoneType")
+%!   assert (log(1).time >= 0.05)
+%!   assert (log(1).conversion < log(1).time)
+%!   assert (log(2).function, "pyexec")
+%!   assert (log(2).target, "import time; time.sleep(0.06)")
+%!   file = tempname ();
+%!   __py_slowlog__ ("save", file);
+%!   text = strsplit (fileread (file), "\n");
+%!   delete (file);
+%!   assert (text{1}, "timestamp\tfunction\ttarget\targuments\tbytes\tresult\ttime\tconversion")
+%!   assert (numel (text), 4)
+%! unwind_protect_cleanup
+%!   __py_slowlog__ ("off");
+%!   __py_slowlog__ ("clear");
+%! end_unwind_protect
+%! [log, tf] = __py_slowlog__ ();
+%! assert (tf, false)
+%! assert (numel (log), 0)
+
+## The log keeps only the most recent calls
+%!test
+%! __py_slowlog__ ("on", 0, 2);
+%! unwind_protect
+%!   pycall ("int", 1);
+%!   pycall ("float", 2);
+%!   pycall ("str", 3);
+%!   log = __py_slowlog__ ();
+%!   assert ({log.target}, {"builtins.float", "builtins.str"})
+%! unwind_protect_cleanup
+%!   __py_slowlog__ ("off");
+%!   __py_slowlog__ ("clear");
+%! end_unwind_protect
+
+%!error __py_slowlog__ (1, 2, 3, 4)
+%!error <must be a string> __py_slowlog__ (1)
+%!error <invalid command> __py_slowlog__ ("start")
+%!error <invalid command> __py_slowlog__ ("on", 1)
+%!error <non-negative number> __py_slowlog__ ("on", -1, 10)
+%!error <positive integer> __py_slowlog__ ("on", 1, 0)
+*/
+
+// PKG_ADD: autoload ("__py_sparse_value__", "__py_struct_from_dict__.oct");
+// PKG_DEL: autoload ("__py_sparse_value__", which ("__py_struct_from_dict__.oct"), "remove");
+DEFUN_DLD (__py_sparse_value__, args, ,
+           R"doc(-*- texinfo -*-
+@deftypefn {} {} __py_sparse_value__ (@var{obj})
+Convert the SciPy sparse matrix @var{obj} to an Octave sparse matrix.
+
+This is a private internal function not intended for direct use.
+@end deftypefn)doc")
+{
+  pythonic::py_stats_call call ("__py_sparse_value__");
+
+  if (args.length () != 1)
+    print_usage ();
+
+  if (! (args(0).isobject () && args(0).class_name () == "pyobject"))
+    error ("pyobject.sparse: argument must be a Python object");
+
+  pythonic::py_init ();
+
+  pythonic::python_object obj = pythonic::pyobject_unwrap_object (args(0));
+  if (! pythonic::py_is_sparse (obj))
+    error ("pyobject.sparse: argument must be a SciPy sparse matrix");
+
+  return ovl (pythonic::extract_py_sparse (obj));
+}
+
+/*
+%!test
+%! if (pyeval ("__import__('importlib').util.find_spec('scipy') is not None"))
+%!   A = sprand (50, 40, 0.1) + 1i * speye (50, 40);
+%!   B = __py_sparse_value__ (pyobject (A));
+%!   assert (issparse (B))
+%!   assert (B, A)
+%!   L = sparse (logical ([1, 0; 0, 1]));
+%!   assert (__py_sparse_value__ (pyobject (L)), L)
+%!   E = sparse (1e6, 1e6);
+%!   assert (__py_sparse_value__ (pyobject (E)), E)
+%! endif
+
+%!test
+%! if (pyeval ("__import__('importlib').util.find_spec('scipy') is not None"))
+%!   pyexec ("import scipy.sparse");
+%!   p = pyeval ("scipy.sparse.coo_matrix(([1.0, 2.0, 0.0, 3.0], ([0, 2, 1, 0], [0, 1, 1, 0])), shape=(3, 2))");
+%!   assert (__py_sparse_value__ (p), sparse ([4, 0; 0, 0; 0, 2]))
+%!   p = pyeval ("scipy.sparse.random(5, 5, density=0.5, format='csr', dtype='float32')");
+%!   assert (full (__py_sparse_value__ (p)), double (pydlpack (p.toarray ())))
+%! endif
+
+## Indices are checked even if the matrix claims to be canonical
+%!test
+%! if (pyeval ("__import__('importlib').util.find_spec('scipy') is not None"))
+%!   pyexec ("import scipy.sparse");
+%!   pyexec (["_pythonic_bad_sparse = scipy.sparse.csc_matrix(([1.0, 2.0], [0, 5], [0, 1, 2]), shape=(3, 2))\n" ...
+%!            "_pythonic_bad_sparse.has_canonical_format = True"]);
+%!   p = pyeval ("_pythonic_bad_sparse");
+%!   pyexec ("del _pythonic_bad_sparse");
+%!   msg = "";
+%!   try
+%!     __py_sparse_value__ (p);
+%!   catch err
+%!     msg = err.message;
+%!   end_try_catch
+%!   assert (! isempty (strfind (msg, "invalid or unsorted row index")))
+%! endif
+
+%!error __py_sparse_value__ ()
+%!error __py_sparse_value__ (pyeval ("[]"), 2)
+%!error <must be a Python object> __py_sparse_value__ (sparse (1))
+%!error <must be a SciPy sparse matrix> __py_sparse_value__ (pyeval ("[]"))
+*/
+
+// PKG_ADD: autoload ("__py_stats__", "__py_struct_from_dict__.oct");
+// PKG_DEL: autoload ("__py_stats__", which ("__py_struct_from_dict__.oct"), "remove");
+DEFUN_DLD (__py_stats__, args, ,
+           R"doc(-*- texinfo -*-
+@deftypefn  {} {@var{s} =} __py_stats__ ()
+@deftypefnx {} {} __py_stats__ ("reset")
+Return or reset the counters of calls and conversions between Octave and Python.
+
+This is a private internal function not intended for direct use.
+@end deftypefn)doc")
+{
+  int nargin = args.length ();
+
+  if (nargin > 1)
+    print_usage ();
+
+  if (nargin == 1)
+    {
+      std::string cmd = args(0).xstring_value ("__py_stats__: argument must be a string");
+      if (cmd != "reset")
+        error ("__py_stats__: invalid command \"%s\"", cmd.c_str ());
+      pythonic::py_stats_reset ();
+      return ovl ();
+    }
+
+  return ovl (pythonic::py_stats ());
+}
+
+/*
+%!test
+%! __py_stats__ ("reset");
+%! s = __py_stats__ ();
+%! assert (isempty (s.calls))
+%! assert (s.bytes, 0)
+%! pycall ("len", [1, 2, 3]);
+%! pyeval ("1.5");
+%! s = __py_stats__ ();
+%! assert (s.calls(strcmp ({s.calls.name}, "pycall")).count, 1)
+%! assert (s.calls(strcmp ({s.calls.name}, "pyeval")).count, 1)
+%! assert (s.arguments(strcmp ({s.arguments.name}, "double")).count >= 1)
+%! assert (s.returns(strcmp ({s.returns.name}, "float")).count >= 1)
+%! assert (s.bytes >= 24)
+%! assert (s.time.python > 0)
+%! assert (s.objstore.peak >= s.objstore.size)
+
+%!test
+%! __py_stats__ ("reset");
+%! try
+%!   pyeval ("1/0");
+%! end_try_catch
+%! s = __py_stats__ ();
+%! assert (s.exceptions.python, 1)
+
+%!error __py_stats__ (1, 2)
+%!error <must be a string> __py_stats__ (1)
+%!error <invalid command> __py_stats__ ("clear")
+*/
+
 // PKG_ADD: autoload ("__py_string_value__", "__py_struct_from_dict__.oct");
 // PKG_DEL: autoload ("__py_string_value__", which ("__py_struct_from_dict__.oct"), "remove");
 DEFUN_DLD (__py_string_value__, args, ,
@@ -395,6 +1136,8 @@ Return the string value or representation of the Python object @var{obj}.
 This is a private internal function not intended for direct use.
 @end deftypefn)doc")
 {
+  pythonic::py_stats_call call ("__py_string_value__");
+
   if (args.length () != 1)
     print_usage ();
 
@@ -441,29 +1184,150 @@ This is a private internal function not intended for direct use.
 %!error <must be a valid Python object> __py_string_value__ ("Octave")
 */
 
+// PKG_ADD: autoload ("__py_struct_field__", "__py_struct_from_dict__.oct");
+// PKG_DEL: autoload ("__py_struct_field__", which ("__py_struct_from_dict__.oct"), "remove");
+DEFUN_DLD (__py_struct_field__, args, ,
+           R"doc(-*- texinfo -*-
+@deftypefn  {} {@var{names} =} __py_struct_field__ (@var{dict})
+@deftypefnx {} {[@var{value}, @var{isdict}] =} __py_struct_field__ (@var{dict}, @var{name})
+Return the string keys of the Python dict @var{dict}, or convert one item.
+
+With one argument, return a column cell array of the keys of @var{dict}
+that are strings.  With two arguments, convert the item named @var{name}
+in the same way as @code{struct} converts each item, and return whether
+the item is itself a dict.
+
+This is a private internal function not intended for direct use.
+@end deftypefn)doc")
+{
+  pythonic::py_stats_call call ("__py_struct_field__");
+
+  int nargin = args.length ();
+
+  if (nargin < 1 || nargin > 2)
+    print_usage ();
+
+  if (! (args(0).isobject () && args(0).class_name () == "pyobject"))
+    error ("pystruct: DICT must be a Python dict");
+
+  std::string name;
+  if (nargin == 2)
+    name = args(1).xstring_value ("pystruct: field NAME must be a string");
+
+  pythonic::py_init ();
+
+  pythonic::python_object obj = pythonic::pyobject_unwrap_object (args(0));
+  if (! (obj && PyDict_Check (obj)))
+    error ("pystruct: DICT must be a Python dict");
+
+  if (nargin == 1)
+    {
+      Py_ssize_t pos = 0;
+      PyObject *py_key = nullptr;
+      PyObject *py_value = nullptr;
+
+      std::list<std::string> keys;
+      while (PyDict_Next (obj, &pos, &py_key, &py_value))
+        if (PyBytes_Check (py_key) || PyUnicode_Check (py_key))
+          keys.push_back (pythonic::extract_py_str (py_key));
+
+      Cell names (dim_vector (keys.size (), 1));
+      octave_idx_type i = 0;
+      for (const auto& key : keys)
+        names(i++) = key;
+
+      return ovl (names);
+    }
+
+  pythonic::python_object key = pythonic::make_py_str (name);
+  PyObject *value = PyDict_GetItem (obj, key);
+  if (! value)
+    error ("invalid use of undefined value, no field named \"%s\"",
+           name.c_str ());
+
+  return ovl (pythonic::py_implicitly_convert_return_value (value),
+              static_cast<bool> (PyDict_Check (value)));
+}
+
+/*
+%!assert (__py_struct_field__ (pyeval ("{}")), cell (0, 1))
+%!assert (__py_struct_field__ (pyeval ("{'a': 1, 2: 3, 'b': 4}")), {"a"; "b"})
+%!assert (__py_struct_field__ (pyeval ("{'a': 1.5}"), "a"), 1.5)
+
+%!test
+%! [v, isdict] = __py_struct_field__ (pyeval ("{'a': {'b': 1}}"), "a");
+%! assert (isdict)
+%! assert (class (v), "py.dict")
+%! [v, isdict] = __py_struct_field__ (pyeval ("{'a': [1]}"), "a");
+%! assert (! isdict)
+
+%!error __py_struct_field__ ()
+%!error __py_struct_field__ (pyeval ("{}"), "a", 3)
+%!error <DICT must be a Python dict> __py_struct_field__ (struct ())
+%!error <DICT must be a Python dict> __py_struct_field__ (pyeval ("[]"))
+%!error <NAME must be a string> __py_struct_field__ (pyeval ("{}"), 1)
+%!error <no field named "z"> __py_struct_field__ (pyeval ("{'a': 1}"), "z")
+*/
+
 DEFUN_DLD (__py_struct_from_dict__, args, ,
            R"doc(-*- texinfo -*-
 @deftypefn  {} {} __py_struct_from_dict__ (@var{dict})
+@deftypefnx {} {} __py_struct_from_dict__ (@var{dict}, "deep")
 Extract a scalar struct from the Python dict @var{dict}.
 
+With the @qcode{"deep"} option, nested dicts, lists, tuples, strings, and
+numbers are converted recursively in a single pass.
+
+If @var{dict} is a pandas DataFrame, the struct contains one field per
+column.  If @var{dict} is a record array, such as a NumPy structured
+array, the result is a struct array with one element per record.
+
 This is a private internal function not intended for direct use.
 @end deftypefn)doc")
 {
+  pythonic::py_stats_call call ("__py_struct_from_dict__");
+
   octave_value_list retval;
   std::string id;
 
   int nargin = args.length ();
 
-  if (nargin != 1)
+  if (nargin < 1 || nargin > 2)
     print_usage ();
 
   if (! (args(0).isobject () && args(0).class_name () == "pyobject"))
     error ("pyobject.struct: argument must be a Python object");
 
+  bool deep = false;
+  if (nargin == 2)
+    {
+      std::string mode = args(1).xstring_value ("pyobject.struct: MODE must be a string");
+      if (mode != "deep")
+        error ("pyobject.struct: invalid MODE \"%s\"", mode.c_str ());
+      deep = true;
+    }
+
   pythonic::py_init ();
 
   pythonic::python_object obj = pythonic::pyobject_unwrap_object (args(0));
-  retval(0) = pythonic::extract_py_scalar_map (obj);
+  if (deep)
+    {
+      if (! (obj && PyDict_Check (obj)))
+        error ("pyobject.struct: unable to convert to an Octave struct, "
+               "argument must be a Python dict");
+      retval(0) = pythonic::py_deeply_convert_return_value (obj);
+      if (! retval(0).isstruct ())
+        error ("unable to convert Python dict to Octave struct, "
+               "all keys in the dict must be strings");
+    }
+  else if (pythonic::py_is_dataframe (obj))
+    retval(0) = pythonic::extract_py_dataframe (obj);
+  else if (pythonic::py_is_record_buffer (obj))
+    retval(0) = pythonic::extract_py_record_array (obj);
+  else if (pythonic::py_is_lazy_view (obj))
+    retval(0) = pythonic::extract_py_lazy_view (obj);
+  else
+    retval(0) = pythonic::extract_py_scalar_map (obj);
 
   return retval;
 }
@@ -472,8 +1336,173 @@ This is a private internal function not intended for direct use.
 %!assert (__py_struct_from_dict__ (pyeval ("{}")), struct ())
 %!assert (__py_struct_from_dict__ (pyeval ("{'a': 1.0}")), struct ("a", 1))
 
+## Test conversion of a pandas DataFrame into a struct of columns
+%!test
+%! if (pyeval ("__import__('importlib').util.find_spec('pandas') is not None"))
+%!   pyexec ("import pandas");
+%!   df = pyeval ("pandas.DataFrame({'x': [1.5, 2.5], 'n': [1, 2], 'b': [True, False], 's': ['a', 'bc']})");
+%!   s = __py_struct_from_dict__ (df);
+%!   assert (fieldnames (s), {"x"; "n"; "b"; "s"})
+%!   assert (s.x, [1.5; 2.5])
+%!   assert (s.n, int64 ([1; 2]))
+%!   assert (s.b, [true; false])
+%!   assert (s.s, {"a"; "bc"})
+%! endif
+
+## Test conversion of a record array into a struct array
+%!test
+%! s = struct ("x", {1.5, 2.5, 3.5}, "n", {int32(1), int32(2), int32(3)}, ...
+%!             "b", {true, false, true});
+%! t = __py_struct_from_dict__ (pyobject (s));
+%! assert (t, s)
+
+%!test
+%! if (pyeval ("__import__('importlib').util.find_spec('numpy') is not None"))
+%!   pyexec ("import numpy");
+%!   a = pyeval ("numpy.array([(1.5, 2), (3.5, 4)], dtype=[('x', 'f8'), ('k', 'u2')])");
+%!   s = __py_struct_from_dict__ (a);
+%!   assert (size (s), [1, 2])
+%!   assert ([s.x], [1.5, 3.5])
+%!   assert ([s.k], uint16 ([2, 4]))
+%!   a = pyeval ("numpy.zeros((2, 3), dtype=numpy.dtype([('a', 'i1'), ('b', 'f4')], align=True))");
+%!   s = __py_struct_from_dict__ (a);
+%!   assert (size (s), [2, 3])
+%!   assert (s(2, 3).a, int8 (0))
+%!   assert (s(2, 3).b, single (0))
+%! endif
+
+## Test recursive conversion of nested dicts and lists
+%!test
+%! d = pyeval ("{'a': {'b': [1, 2.5], 'c': 'str'}, 'l': [True, False], 'm': [1, 'x', None, {'k': 1j}], 'n': None, 'e': [], 'big': 2**2000}");
+%! s = __py_struct_from_dict__ (d, "deep");
+%! assert (s.a, struct ("b", [1, 2.5], "c", "str"))
+%! assert (s.l, [true, false])
+%! assert (s.m, {1, "x", [], struct("k", 1i)})
+%! assert (s.n, [])
+%! assert (s.e, cell (1, 0))
+%! assert (class (s.big), "py.int")
+
+%!test
+%! d = pyeval ("{'a': {1: 2}, 'b': (1, 2j)}");
+%! s = __py_struct_from_dict__ (d, "deep");
+%! assert (class (s.a), "py.dict")
+%! assert (s.b, [1, 2i])
+
+## Ints that a double cannot hold exactly are kept as Python ints
+%!test
+%! d = pyeval ("{'id': 2**53 + 1, 'ids': [1, 2**53 + 1], 'z': [2**53 + 1, 1j], 'p': 2**60, 'q': [2**53, -2**53]}");
+%! s = __py_struct_from_dict__ (d, "deep");
+%! assert (class (s.id), "py.int")
+%! assert (iscell (s.ids))
+%! assert (s.ids{1}, 1)
+%! assert (class (s.ids{2}), "py.int")
+%! assert (iscell (s.z))
+%! assert (s.p, 2^60)
+%! assert (s.q, [2^53, -2^53])
+
 %!error __py_struct_from_dict__ ()
-%!error __py_struct_from_dict__ (pyeval ("{}"), 2)
+%!error __py_struct_from_dict__ (pyeval ("{}"), "deep", 2)
+%!error <MODE must be a string> __py_struct_from_dict__ (pyeval ("{}"), 2)
+%!error <invalid MODE> __py_struct_from_dict__ (pyeval ("{}"), "shallow")
+%!error <must be a Python dict> __py_struct_from_dict__ (pyeval ("[]"), "deep")
+%!error <keys in the dict must be strings> __py_struct_from_dict__ (pyeval ("{1: 2}"), "deep")
+%!error <maximum nesting depth> __py_struct_from_dict__ (pyeval ("(lambda d: d.__setitem__('d', d) or d)({})"), "deep")
 %!error <must be a Python object> __py_struct_from_dict__ ("Octave")
 %!error <unable to convert to an Octave struct> __py_struct_from_dict__ (pyeval ("[]"))
 */
+
+// PKG_ADD: autoload ("__py_trace__", "__py_struct_from_dict__.oct");
+// PKG_DEL: autoload ("__py_trace__", which ("__py_struct_from_dict__.oct"), "remove");
+DEFUN_DLD (__py_trace__, args, ,
+           R"doc(-*- texinfo -*-
+@deftypefn  {} {[@var{tf}, @var{n}] =} __py_trace__ ()
+@deftypefnx {} {} __py_trace__ ("on", @var{capacity})
+@deftypefnx {} {} __py_trace__ ("off")
+@deftypefnx {} {} __py_trace__ ("clear")
+@deftypefnx {} {} __py_trace__ ("save", @var{file})
+Control the tracer of calls and conversions between Octave and Python.
+
+This is a private internal function not intended for direct use.
+@end deftypefn)doc")
+{
+  int nargin = args.length ();
+
+  if (nargin > 2)
+    print_usage ();
+
+  if (nargin == 0)
+    return ovl (pythonic::py_trace.enabled (),
+                static_cast<double> (pythonic::py_trace_size ()));
+
+  std::string cmd = args(0).xstring_value ("__py_trace__: argument must be a string");
+
+  if (cmd == "on" && nargin == 2)
+    {
+      int capacity = args(1).xint_value ("__py_trace__: CAPACITY must be a positive integer");
+      if (capacity < 1)
+        error ("__py_trace__: CAPACITY must be a positive integer");
+      pythonic::py_trace_start (capacity);
+    }
+  else if (cmd == "off" && nargin == 1)
+    pythonic::py_trace_stop ();
+  else if (cmd == "clear" && nargin == 1)
+    pythonic::py_trace_clear ();
+  else if (cmd == "save" && nargin == 2)
+    {
+      std::string file = args(1).xstring_value ("__py_trace__: FILE must be a string");
+      pythonic::py_trace_save (file);
+    }
+  else
+    error ("__py_trace__: invalid command \"%s\"", cmd.c_str ());
+
+  return ovl ();
+}
+
+/*
+%!test
+%! __py_trace__ ("on", 100);
+%! unwind_protect
+%!   __py_trace__ ("clear");
+%!   pycall ("len", [1, 2, 3]);
+%!   pyeval ("1 + 1");
+%!   [tf, n] = __py_trace__ ();
+%!   assert (tf, true)
+%!   assert (n >= 4)
+%!   file = [tempname(), ".json"];
+%!   __py_trace__ ("save", file);
+%!   json = fileread (file);
+%!   delete (file);
+%!   assert (strncmp (json, "{\"displayTimeUnit\"", 18))
+%!   assert (! isempty (strfind (json, "\"name\": \"builtins.len\"")))
+%!   assert (! isempty (strfind (json, "\"name\": \"pyeval\"")))
+%!   assert (! isempty (strfind (json, "\"summary\": \"double 1x3\"")))
+%! unwind_protect_cleanup
+%!   __py_trace__ ("off");
+%! end_unwind_protect
+%! [tf, n] = __py_trace__ ();
+%! assert (tf, false)
+%! pyeval ("1 + 1");
+%! [~, m] = __py_trace__ ();
+%! assert (m, n)
+%! __py_trace__ ("clear");
+
+## The ring buffer keeps only the most recent events
+%!test
+%! __py_trace__ ("on", 2);
+%! unwind_protect
+%!   for i = 1:5
+%!     pyeval ("1");
+%!   endfor
+%!   [~, n] = __py_trace__ ();
+%!   assert (n, 2)
+%! unwind_protect_cleanup
+%!   __py_trace__ ("off");
+%! end_unwind_protect
+
+%!error __py_trace__ (1, 2, 3)
+%!error <must be a string> __py_trace__ (1)
+%!error <invalid command> __py_trace__ ("start")
+%!error <invalid command> __py_trace__ ("on")
+%!error <positive integer> __py_trace__ ("on", 0)
+%!error <positive integer> __py_trace__ ("on", 1.5)
+*/
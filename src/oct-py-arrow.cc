@@ -0,0 +1,854 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+#if defined (HAVE_CONFIG_H)
+#  include <config.h>
+#endif
+
+#include <Python.h>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include <octave/oct.h>
+#include <octave/Cell.h>
+#include <octave/oct-map.h>
+#include <octave/parse.h>
+
+#include "oct-py-arrow.h"
+#include "oct-py-buffer.h"
+#include "oct-py-error.h"
+#include "oct-py-object.h"
+#include "oct-py-types.h"
+
+// Arrow C data interface structures, as specified in
+// https://arrow.apache.org/docs/format/CDataInterface.html and
+// https://arrow.apache.org/docs/format/CStreamInterface.html
+
+#if ! defined (ARROW_C_DATA_INTERFACE)
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+extern "C"
+{
+  struct ArrowSchema
+  {
+    const char *format;
+    const char *name;
+    const char *metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema **children;
+    struct ArrowSchema *dictionary;
+    void (*release) (struct ArrowSchema *);
+    void *private_data;
+  };
+
+  struct ArrowArray
+  {
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void **buffers;
+    struct ArrowArray **children;
+    struct ArrowArray *dictionary;
+    void (*release) (struct ArrowArray *);
+    void *private_data;
+  };
+}
+
+#endif
+
+#if ! defined (ARROW_C_STREAM_INTERFACE)
+#define ARROW_C_STREAM_INTERFACE
+
+extern "C"
+{
+  struct ArrowArrayStream
+  {
+    int (*get_schema) (struct ArrowArrayStream *, struct ArrowSchema *);
+    int (*get_next) (struct ArrowArrayStream *, struct ArrowArray *);
+    const char *(*get_last_error) (struct ArrowArrayStream *);
+    void (*release) (struct ArrowArrayStream *);
+    void *private_data;
+  };
+}
+
+#endif
+
+namespace pythonic
+{
+
+  // Export of Octave values.  The exported structures own copies of the
+  // Octave arrays, which share the data with the original values.
+
+  struct arrow_schema_private
+  {
+    std::string format;
+    std::string name;
+    std::vector<ArrowSchema *> children;
+  };
+
+  static void
+  release_arrow_schema (ArrowSchema *schema)
+  {
+    arrow_schema_private *priv
+      = static_cast<arrow_schema_private *> (schema->private_data);
+
+    for (ArrowSchema *child : priv->children)
+      {
+        if (child->release)
+          child->release (child);
+        delete child;
+      }
+
+    delete priv;
+    schema->release = nullptr;
+  }
+
+  struct arrow_array_private
+  {
+    std::unique_ptr<py_array_holder> holder;
+    std::vector<uint8_t> bytes;
+    std::vector<int32_t> offsets;
+    std::vector<int64_t> large_offsets;
+    std::vector<const void *> buffers;
+    std::vector<ArrowArray *> children;
+  };
+
+  static void
+  release_arrow_array (ArrowArray *array)
+  {
+    arrow_array_private *priv
+      = static_cast<arrow_array_private *> (array->private_data);
+
+    for (ArrowArray *child : priv->children)
+      {
+        if (child->release)
+          child->release (child);
+        delete child;
+      }
+
+    delete priv;
+    array->release = nullptr;
+  }
+
+  static bool
+  is_arrow_string_cell (const Cell& cell)
+  {
+    for (octave_idx_type i = 0; i < cell.numel (); i++)
+      {
+        const octave_value& elt = cell.xelem (i);
+        if (! ((elt.is_string () && elt.rows () <= 1)
+               || (elt.isempty () && elt.isnumeric ())))
+          return false;
+      }
+    return true;
+  }
+
+  static bool
+  is_arrow_vector (const octave_value& value)
+  {
+    return (value.ndims () == 2
+            && (value.rows () <= 1 || value.columns () <= 1));
+  }
+
+  // Return the Arrow format string for an Octave value, or raise an error
+  // if the value cannot be exported.  This is called before any structure
+  // is allocated, so that exporting never fails half way.
+
+  static std::string
+  arrow_format (const octave_value& value, octave_idx_type& length)
+  {
+    if (value.isstruct ())
+      {
+        if (value.numel () != 1)
+          error ("unable to export struct array as Arrow data, must be a "
+                 "scalar struct");
+
+        octave_scalar_map map = value.scalar_map_value ();
+        string_vector names = map.fieldnames ();
+        length = -1;
+        for (octave_idx_type i = 0; i < names.numel (); i++)
+          {
+            octave_idx_type n = 0;
+            arrow_format (map.getfield (names(i)), n);
+            if (length >= 0 && n != length)
+              error ("unable to export struct as Arrow data, all fields must "
+                     "have the same number of elements");
+            length = n;
+          }
+        if (length < 0)
+          length = 0;
+        return "+s";
+      }
+
+    if (! is_arrow_vector (value) || value.issparse () || value.iscomplex ())
+      error ("unable to export Octave type \"%s\" as Arrow data, must be a "
+             "real vector, cell array of strings, or scalar struct",
+             value.type_name ().c_str ());
+
+    length = value.numel ();
+
+    if (value.iscell ())
+      {
+        Cell cell = value.cell_value ();
+        if (! is_arrow_string_cell (cell))
+          error ("unable to export cell array as Arrow data, all elements "
+                 "must be strings");
+
+        size_t nbytes = 0;
+        for (octave_idx_type i = 0; i < cell.numel (); i++)
+          nbytes += cell.xelem (i).numel ();
+        return (nbytes > static_cast<size_t> (std::numeric_limits<int32_t>::max ()))
+               ? "U" : "u";
+      }
+    else if (value.islogical ())
+      return "b";
+    else if (value.is_double_type ())
+      return "g";
+    else if (value.is_single_type ())
+      return "f";
+    else if (value.is_int8_type ())
+      return "c";
+    else if (value.is_int16_type ())
+      return "s";
+    else if (value.is_int32_type ())
+      return "i";
+    else if (value.is_int64_type ())
+      return "l";
+    else if (value.is_uint8_type ())
+      return "C";
+    else if (value.is_uint16_type ())
+      return "S";
+    else if (value.is_uint32_type ())
+      return "I";
+    else if (value.is_uint64_type ())
+      return "L";
+
+    error ("unable to export Octave type \"%s\" as Arrow data",
+           value.type_name ().c_str ());
+  }
+
+  static void
+  export_arrow_schema (const octave_value& value, const std::string& name,
+                       ArrowSchema *schema)
+  {
+    octave_idx_type length = 0;
+    std::string format = arrow_format (value, length);
+
+    arrow_schema_private *priv = new arrow_schema_private;
+    priv->format = format;
+    priv->name = name;
+
+    if (value.isstruct ())
+      {
+        octave_scalar_map map = value.scalar_map_value ();
+        string_vector names = map.fieldnames ();
+        for (octave_idx_type i = 0; i < names.numel (); i++)
+          {
+            ArrowSchema *child = new ArrowSchema ();
+            export_arrow_schema (map.getfield (names(i)), names(i), child);
+            priv->children.push_back (child);
+          }
+      }
+
+    schema->format = priv->format.c_str ();
+    schema->name = priv->name.c_str ();
+    schema->metadata = nullptr;
+    schema->flags = ARROW_FLAG_NULLABLE;
+    schema->n_children = priv->children.size ();
+    schema->children = priv->children.data ();
+    schema->dictionary = nullptr;
+    schema->release = release_arrow_schema;
+    schema->private_data = priv;
+  }
+
+  template <typename T>
+  static void
+  export_arrow_data (const Array<T>& data, arrow_array_private *priv)
+  {
+    py_typed_array_holder<T> *holder = new py_typed_array_holder<T> (data);
+    priv->holder.reset (holder);
+    priv->buffers = { nullptr, holder->data () };
+  }
+
+  template <typename O>
+  static void
+  export_arrow_strings (const Cell& cell, std::vector<O>& offsets,
+                        arrow_array_private *priv)
+  {
+    octave_idx_type n = cell.numel ();
+    offsets.resize (n + 1);
+    offsets[0] = 0;
+    for (octave_idx_type i = 0; i < n; i++)
+      {
+        const octave_value& elt = cell.xelem (i);
+        if (elt.is_string ())
+          {
+            std::string s = elt.string_value ();
+            priv->bytes.insert (priv->bytes.end (), s.begin (), s.end ());
+          }
+        offsets[i+1] = static_cast<O> (priv->bytes.size ());
+      }
+
+    // Never hand out a null data buffer, even for empty strings
+    if (priv->bytes.empty ())
+      priv->bytes.push_back (0);
+
+    priv->buffers = { nullptr, offsets.data (), priv->bytes.data () };
+  }
+
+  static void
+  export_arrow_array (const octave_value& value, ArrowArray *array)
+  {
+    octave_idx_type length = 0;
+    std::string format = arrow_format (value, length);
+
+    arrow_array_private *priv = new arrow_array_private;
+
+    if (value.isstruct ())
+      {
+        octave_scalar_map map = value.scalar_map_value ();
+        string_vector names = map.fieldnames ();
+        for (octave_idx_type i = 0; i < names.numel (); i++)
+          {
+            ArrowArray *child = new ArrowArray ();
+            export_arrow_array (map.getfield (names(i)), child);
+            priv->children.push_back (child);
+          }
+        priv->buffers = { nullptr };
+      }
+    else if (format == "u")
+      export_arrow_strings (value.cell_value (), priv->offsets, priv);
+    else if (format == "U")
+      export_arrow_strings (value.cell_value (), priv->large_offsets, priv);
+    else if (format == "b")
+      {
+        boolNDArray data = value.bool_array_value ();
+        priv->bytes.assign ((length + 7) / 8 + 1, 0);
+        for (octave_idx_type i = 0; i < length; i++)
+          if (data.xelem (i))
+            priv->bytes[i / 8] |= static_cast<uint8_t> (1 << (i % 8));
+        priv->buffers = { nullptr, priv->bytes.data () };
+      }
+    else if (format == "g")
+      export_arrow_data (value.array_value (), priv);
+    else if (format == "f")
+      export_arrow_data (value.float_array_value (), priv);
+    else if (format == "c")
+      export_arrow_data (value.int8_array_value (), priv);
+    else if (format == "s")
+      export_arrow_data (value.int16_array_value (), priv);
+    else if (format == "i")
+      export_arrow_data (value.int32_array_value (), priv);
+    else if (format == "l")
+      export_arrow_data (value.int64_array_value (), priv);
+    else if (format == "C")
+      export_arrow_data (value.uint8_array_value (), priv);
+    else if (format == "S")
+      export_arrow_data (value.uint16_array_value (), priv);
+    else if (format == "I")
+      export_arrow_data (value.uint32_array_value (), priv);
+    else if (format == "L")
+      export_arrow_data (value.uint64_array_value (), priv);
+
+    array->length = length;
+    array->null_count = 0;
+    array->offset = 0;
+    array->n_buffers = priv->buffers.size ();
+    array->n_children = priv->children.size ();
+    array->buffers = priv->buffers.data ();
+    array->children = priv->children.data ();
+    array->dictionary = nullptr;
+    array->release = release_arrow_array;
+    array->private_data = priv;
+  }
+
+  // Python type implementing the Arrow PyCapsule interface
+
+  struct py_arrow_export
+  {
+    PyObject_HEAD
+    octave_value *value;
+  };
+
+  static void
+  py_arrow_export_dealloc (PyObject *self)
+  {
+    delete reinterpret_cast<py_arrow_export *> (self)->value;
+    Py_TYPE (self)->tp_free (self);
+  }
+
+  static void
+  py_arrow_schema_capsule_destructor (PyObject *capsule)
+  {
+    ArrowSchema *schema = static_cast<ArrowSchema *>
+      (PyCapsule_GetPointer (capsule, "arrow_schema"));
+    if (schema && schema->release)
+      schema->release (schema);
+    delete schema;
+  }
+
+  static void
+  py_arrow_array_capsule_destructor (PyObject *capsule)
+  {
+    ArrowArray *array = static_cast<ArrowArray *>
+      (PyCapsule_GetPointer (capsule, "arrow_array"));
+    if (array && array->release)
+      array->release (array);
+    delete array;
+  }
+
+  static PyObject *
+  py_arrow_export_schema_capsule (const octave_value& value)
+  {
+    ArrowSchema *schema = new ArrowSchema ();
+    export_arrow_schema (value, "", schema);
+
+    PyObject *capsule = PyCapsule_New (schema, "arrow_schema",
+                                       py_arrow_schema_capsule_destructor);
+    if (! capsule)
+      {
+        schema->release (schema);
+        delete schema;
+      }
+    return capsule;
+  }
+
+  static PyObject *
+  py_arrow_export_c_schema (PyObject *self, PyObject *)
+  {
+    const octave_value& value = *reinterpret_cast<py_arrow_export *> (self)->value;
+
+    try
+      {
+        return py_arrow_export_schema_capsule (value);
+      }
+    catch (const std::bad_alloc&)
+      {
+        return PyErr_NoMemory ();
+      }
+  }
+
+  static PyObject *
+  py_arrow_export_c_array (PyObject *self, PyObject *args, PyObject *kwargs)
+  {
+    // The requested schema is ignored, the data is always exported with
+    // the types that match the Octave value.
+    static const char *keywords[] = {"requested_schema", nullptr};
+    PyObject *requested_schema = nullptr;
+    if (! PyArg_ParseTupleAndKeywords (args, kwargs, "|O", const_cast<char **> (keywords),
+                                       &requested_schema))
+      return nullptr;
+
+    const octave_value& value = *reinterpret_cast<py_arrow_export *> (self)->value;
+
+    try
+      {
+        python_object schema = py_arrow_export_schema_capsule (value);
+        if (! schema)
+          return nullptr;
+
+        ArrowArray *array = new ArrowArray ();
+        export_arrow_array (value, array);
+
+        python_object capsule = PyCapsule_New (array, "arrow_array",
+                                               py_arrow_array_capsule_destructor);
+        if (! capsule)
+          {
+            array->release (array);
+            delete array;
+            return nullptr;
+          }
+
+        return PyTuple_Pack (2, static_cast<PyObject *> (schema),
+                             static_cast<PyObject *> (capsule));
+      }
+    catch (const std::bad_alloc&)
+      {
+        return PyErr_NoMemory ();
+      }
+  }
+
+  static PyMethodDef py_arrow_export_methods[] {
+    {"__arrow_c_schema__", py_arrow_export_c_schema, METH_NOARGS,
+     "Export the Arrow schema as a PyCapsule"},
+    {"__arrow_c_array__", reinterpret_cast<PyCFunction> (reinterpret_cast<void (*) ()> (py_arrow_export_c_array)),
+     METH_VARARGS | METH_KEYWORDS,
+     "Export the Arrow schema and array as a pair of PyCapsules"},
+    {nullptr, nullptr, 0, nullptr}
+  };
+
+  static PyTypeObject py_arrow_export_type = PyTypeObject ();
+
+  static PyTypeObject *
+  py_arrow_export_type_ready ()
+  {
+    static bool ready = false;
+    if (! ready)
+      {
+        py_arrow_export_type.tp_name = "pythonic.OctaveArrowArray";
+        py_arrow_export_type.tp_basicsize = sizeof (py_arrow_export);
+        py_arrow_export_type.tp_dealloc = py_arrow_export_dealloc;
+        py_arrow_export_type.tp_methods = py_arrow_export_methods;
+        py_arrow_export_type.tp_flags = Py_TPFLAGS_DEFAULT;
+        py_arrow_export_type.tp_doc = "Octave value exported as Arrow data";
+        Py_INCREF (&py_arrow_export_type);
+        if (PyType_Ready (&py_arrow_export_type) < 0)
+          error_python_exception ();
+        ready = true;
+      }
+    return &py_arrow_export_type;
+  }
+
+  PyObject *
+  make_py_arrow (const octave_value& value)
+  {
+    octave_idx_type length = 0;
+    arrow_format (value, length);
+
+    PyTypeObject *type = py_arrow_export_type_ready ();
+    py_arrow_export *obj = PyObject_New (py_arrow_export, type);
+    if (! obj)
+      error_python_exception ();
+
+    obj->value = new octave_value (value);
+
+    return reinterpret_cast<PyObject *> (obj);
+  }
+
+  // Import of Arrow data into Octave values, always copies into a new
+  // Octave array.
+
+  static bool
+  arrow_is_valid (const ArrowArray *array, int64_t i)
+  {
+    const uint8_t *bitmap = static_cast<const uint8_t *> (array->buffers[0]);
+    return ! bitmap || (bitmap[i / 8] >> (i % 8)) & 1;
+  }
+
+  static bool
+  arrow_has_nulls (const ArrowArray *array)
+  {
+    return (array->null_count != 0 && array->n_buffers > 0
+            && array->buffers[0]);
+  }
+
+  template <typename A, typename T>
+  static octave_value
+  import_arrow_primitive (const ArrowArray *array, int64_t start, int64_t n)
+  {
+    const T *src = static_cast<const T *> (array->buffers[1]);
+    int64_t base = array->offset + start;
+    bool nulls = arrow_has_nulls (array);
+
+    // Integer arrays with nulls are returned as double with NaN
+    if (nulls && std::numeric_limits<T>::is_integer)
+      {
+        NDArray retval (dim_vector (n, 1));
+        for (int64_t k = 0; k < n; k++)
+          retval.xelem (k) = arrow_is_valid (array, base + k)
+                             ? static_cast<double> (src[base + k])
+                             : std::numeric_limits<double>::quiet_NaN ();
+        return retval;
+      }
+
+    A retval (dim_vector (n, 1));
+    if (n > 0)
+      std::memcpy (static_cast<void *> (retval.fortran_vec ()), src + base, n * sizeof (T));
+
+    if (nulls)
+      for (int64_t k = 0; k < n; k++)
+        if (! arrow_is_valid (array, base + k))
+          retval.xelem (k) = std::numeric_limits<T>::quiet_NaN ();
+
+    return retval;
+  }
+
+  static octave_value
+  import_arrow_bool (const ArrowArray *array, int64_t start, int64_t n)
+  {
+    if (arrow_has_nulls (array))
+      error ("unable to convert Arrow boolean array with null values");
+
+    const uint8_t *bits = static_cast<const uint8_t *> (array->buffers[1]);
+    int64_t base = array->offset + start;
+
+    boolNDArray retval (dim_vector (n, 1));
+    for (int64_t k = 0; k < n; k++)
+      retval.xelem (k) = (bits[(base + k) / 8] >> ((base + k) % 8)) & 1;
+
+    return retval;
+  }
+
+  template <typename O>
+  static octave_value
+  import_arrow_strings (const ArrowArray *array, int64_t start, int64_t n)
+  {
+    const O *offsets = static_cast<const O *> (array->buffers[1]);
+    const char *data = static_cast<const char *> (array->buffers[2]);
+    int64_t base = array->offset + start;
+
+    Cell retval (dim_vector (n, 1));
+    for (int64_t k = 0; k < n; k++)
+      {
+        int64_t i = base + k;
+        if (arrow_is_valid (array, i))
+          retval.xelem (k) = std::string (data + offsets[i],
+                                          offsets[i+1] - offsets[i]);
+        else
+          retval.xelem (k) = "";
+      }
+
+    return retval;
+  }
+
+  static octave_value
+  import_arrow (const ArrowSchema *schema, const ArrowArray *array,
+                int64_t start, int64_t n)
+  {
+    std::string fmt = schema->format ? schema->format : "";
+
+    if (schema->dictionary)
+      error ("unable to convert dictionary-encoded Arrow array");
+
+    if (fmt == "+s")
+      {
+        octave_scalar_map map;
+        for (int64_t i = 0; i < schema->n_children; i++)
+          {
+            const ArrowSchema *child = schema->children[i];
+            std::string name = child->name ? child->name : "";
+            map.setfield (name, import_arrow (child, array->children[i],
+                                              array->offset + start, n));
+          }
+        return map;
+      }
+    else if (fmt == "b")
+      return import_arrow_bool (array, start, n);
+    else if (fmt == "u")
+      return import_arrow_strings<int32_t> (array, start, n);
+    else if (fmt == "U")
+      return import_arrow_strings<int64_t> (array, start, n);
+    else if (fmt == "g")
+      return import_arrow_primitive<NDArray, double> (array, start, n);
+    else if (fmt == "f")
+      return import_arrow_primitive<FloatNDArray, float> (array, start, n);
+    else if (fmt == "c")
+      return import_arrow_primitive<int8NDArray, int8_t> (array, start, n);
+    else if (fmt == "s")
+      return import_arrow_primitive<int16NDArray, int16_t> (array, start, n);
+    else if (fmt == "i" || fmt == "tdD" || fmt == "tts" || fmt == "ttm")
+      return import_arrow_primitive<int32NDArray, int32_t> (array, start, n);
+    else if (fmt == "l" || fmt == "tdm" || fmt == "ttu" || fmt == "ttn"
+             || fmt.compare (0, 2, "ts") == 0 || fmt.compare (0, 2, "tD") == 0)
+      return import_arrow_primitive<int64NDArray, int64_t> (array, start, n);
+    else if (fmt == "C")
+      return import_arrow_primitive<uint8NDArray, uint8_t> (array, start, n);
+    else if (fmt == "S")
+      return import_arrow_primitive<uint16NDArray, uint16_t> (array, start, n);
+    else if (fmt == "I")
+      return import_arrow_primitive<uint32NDArray, uint32_t> (array, start, n);
+    else if (fmt == "L")
+      return import_arrow_primitive<uint64NDArray, uint64_t> (array, start, n);
+
+    error ("unable to convert Arrow array with format '%s'", fmt.c_str ());
+  }
+
+  // An empty value with the shape of an Arrow schema, for streams that
+  // contain no record batches.
+
+  static octave_value
+  empty_arrow_value (const ArrowSchema *schema)
+  {
+    std::string fmt = schema->format ? schema->format : "";
+
+    if (fmt == "+s")
+      {
+        octave_scalar_map map;
+        for (int64_t i = 0; i < schema->n_children; i++)
+          {
+            const ArrowSchema *child = schema->children[i];
+            map.setfield (child->name ? child->name : "",
+                          empty_arrow_value (child));
+          }
+        return map;
+      }
+    else if (fmt == "u" || fmt == "U")
+      return Cell (dim_vector (0, 1));
+    else
+      return NDArray (dim_vector (0, 1));
+  }
+
+  // Concatenate values imported from consecutive record batches.
+
+  static octave_value
+  concatenate_arrow_values (const std::vector<octave_value>& values)
+  {
+    if (values.size () == 1)
+      return values[0];
+
+    if (values[0].isstruct ())
+      {
+        octave_scalar_map first = values[0].scalar_map_value ();
+        string_vector names = first.fieldnames ();
+        octave_scalar_map map;
+        for (octave_idx_type i = 0; i < names.numel (); i++)
+          {
+            std::vector<octave_value> columns;
+            for (const octave_value& v : values)
+              columns.push_back (v.scalar_map_value ().getfield (names(i)));
+            map.setfield (names(i), concatenate_arrow_values (columns));
+          }
+        return map;
+      }
+
+    octave_value_list args;
+    for (const octave_value& v : values)
+      args.append (v);
+
+    octave_value_list retval = octave::feval ("vertcat", args, 1);
+    return retval(0);
+  }
+
+  // Release an Arrow structure when leaving scope, including on error.
+
+  template <typename T>
+  class arrow_release_guard
+  {
+  public:
+    arrow_release_guard (T& obj) : m_obj (obj) { }
+
+    ~arrow_release_guard ()
+    {
+      if (m_obj.release)
+        m_obj.release (&m_obj);
+    }
+
+  private:
+    T& m_obj;
+  };
+
+  // The last error message of a stream, which may be null.
+
+  static const char *
+  arrow_stream_error (ArrowArrayStream *stream)
+  {
+    const char *msg = stream->get_last_error (stream);
+    return msg ? msg : "unknown error";
+  }
+
+  static octave_value
+  extract_py_arrow_stream (PyObject *obj)
+  {
+    python_object capsule = PyObject_CallMethod (obj, "__arrow_c_stream__",
+                                                 nullptr);
+    if (! capsule)
+      error_python_exception ();
+
+    ArrowArrayStream *stream = static_cast<ArrowArrayStream *>
+      (PyCapsule_GetPointer (capsule, "arrow_array_stream"));
+    if (! stream)
+      error_python_exception ();
+    if (! stream->release)
+      error ("unable to convert Arrow stream, it has already been released");
+
+    ArrowSchema schema = ArrowSchema ();
+    if (stream->get_schema (stream, &schema) != 0)
+      error ("unable to get Arrow stream schema: %s",
+             arrow_stream_error (stream));
+    arrow_release_guard<ArrowSchema> schema_guard (schema);
+
+    std::vector<octave_value> batches;
+    for (;;)
+      {
+        ArrowArray array = ArrowArray ();
+        if (stream->get_next (stream, &array) != 0)
+          error ("unable to get next Arrow record batch: %s",
+                 arrow_stream_error (stream));
+        if (! array.release)
+          break;
+
+        arrow_release_guard<ArrowArray> array_guard (array);
+        batches.push_back (import_arrow (&schema, &array, 0, array.length));
+      }
+
+    if (batches.empty ())
+      return empty_arrow_value (&schema);
+
+    return concatenate_arrow_values (batches);
+  }
+
+  bool
+  py_is_arrow (PyObject *obj)
+  {
+    return (obj && (PyObject_HasAttrString (obj, "__arrow_c_array__")
+                    || PyObject_HasAttrString (obj, "__arrow_c_stream__")));
+  }
+
+  octave_value
+  extract_py_arrow (PyObject *obj)
+  {
+    if (! PyObject_HasAttrString (obj, "__arrow_c_array__"))
+      {
+        if (PyObject_HasAttrString (obj, "__arrow_c_stream__"))
+          return extract_py_arrow_stream (obj);
+
+        error_conversion_mismatch_python_type ("Arrow data",
+                                               "an Arrow array or stream");
+      }
+
+    python_object capsules = PyObject_CallMethod (obj, "__arrow_c_array__",
+                                                  nullptr);
+    if (! capsules)
+      error_python_exception ();
+
+    if (! (PyTuple_Check (static_cast<PyObject *> (capsules))
+           && PyTuple_Size (capsules) == 2))
+      error ("unable to convert Arrow data, __arrow_c_array__ must return "
+             "a tuple of two capsules");
+
+    ArrowSchema *schema = static_cast<ArrowSchema *>
+      (PyCapsule_GetPointer (PyTuple_GET_ITEM (static_cast<PyObject *> (capsules), 0),
+                             "arrow_schema"));
+    ArrowArray *array = static_cast<ArrowArray *>
+      (PyCapsule_GetPointer (PyTuple_GET_ITEM (static_cast<PyObject *> (capsules), 1),
+                             "arrow_array"));
+    if (! (schema && array))
+      error_python_exception ();
+
+    if (! (schema->release && array->release))
+      error ("unable to convert Arrow data, it has already been released");
+
+    return import_arrow (schema, array, 0, array->length);
+  }
+
+}
@@ -0,0 +1,75 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+#if ! defined (pythonic_oct_py_arrow_h)
+#define pythonic_oct_py_arrow_h 1
+
+#include <Python.h>
+
+class octave_value;
+
+namespace pythonic
+{
+
+  //! Check whether an object exports Arrow data.
+  //!
+  //! @param obj Python object
+  //! @return @c true if @a obj implements the @c __arrow_c_array__ or
+  //!         @c __arrow_c_stream__ method of the Arrow PyCapsule interface,
+  //!         @c false otherwise
+  bool
+  py_is_arrow (PyObject *obj);
+
+  //! Convert an Arrow array exported by a Python object to an Octave value.
+  //!
+  //! Primitive arrays become column vectors of the matching type, boolean
+  //! arrays become logical column vectors, string arrays become cell arrays
+  //! of strings, and struct arrays, such as record batches, become a scalar
+  //! struct of columns.  Null values become @c NaN in floating point arrays,
+  //! integer arrays with nulls are converted to @c double.  The record
+  //! batches of a stream, such as a table, are concatenated.
+  //!
+  //! @param obj Python object that implements @c __arrow_c_array__ or
+  //!            @c __arrow_c_stream__
+  //! @return Octave value
+  octave_value
+  extract_py_arrow (PyObject *obj);
+
+  //! Return a Python object that exports an Octave value as Arrow data.
+  //!
+  //! The object implements the Arrow PyCapsule interface, so it can be
+  //! passed to @c pyarrow.array, @c pyarrow.record_batch, and other
+  //! consumers of the Arrow C Data Interface.  Numeric arrays are exported
+  //! without copying their data.  Logical arrays and cell arrays of strings
+  //! are converted to the Arrow layout.  A scalar struct of equal-length
+  //! vectors is exported as a struct array.
+  //!
+  //! @param value Octave value
+  //! @return a reference to a new Python object
+  PyObject *
+  make_py_arrow (const octave_value& value);
+
+}
+
+#endif
@@ -0,0 +1,188 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+#if defined (HAVE_CONFIG_H)
+#  include <config.h>
+#endif
+
+#include <Python.h>
+#include <algorithm>
+#include <octave/error.h>
+#include <octave/quit.h>
+
+#include "oct-py-async.h"
+#include "oct-py-error.h"
+#include "oct-py-eval.h"
+#include "oct-py-object.h"
+
+namespace pythonic
+{
+
+  // Python code for the background event loop.  Futures are created with
+  // run_coroutine_threadsafe, so Octave only ever deals with thread-safe
+  // concurrent.futures.Future objects.  The loop thread runs whenever the
+  // main thread releases the GIL, which it does while running Python code
+  // and while waiting for futures to complete.
+
+  static const char *py_async_source = R"py(
+import asyncio
+import concurrent.futures
+import inspect
+import threading
+
+_loop = None
+
+
+def _run(loop, started):
+    asyncio.set_event_loop(loop)
+    loop.call_soon(started.set)
+    loop.run_forever()
+
+
+def _event_loop():
+    """Return the background event loop, starting it on first use."""
+    global _loop
+    if _loop is None:
+        loop = asyncio.new_event_loop()
+        started = threading.Event()
+        thread = threading.Thread(target=_run, args=(loop, started), name="pythonic-asyncio")
+        thread.daemon = True
+        thread.start()
+        started.wait()
+        _loop = loop
+    return _loop
+
+
+async def _await(awaitable):
+    return await awaitable
+
+
+def submit(obj):
+    if isinstance(obj, concurrent.futures.Future):
+        return obj
+    if not asyncio.iscoroutine(obj):
+        if not inspect.isawaitable(obj):
+            raise TypeError("object of type %s is not awaitable" % type(obj).__name__)
+        obj = _await(obj)
+    return asyncio.run_coroutine_threadsafe(obj, _event_loop())
+
+
+def wait(futures, timeout):
+    _, pending = concurrent.futures.wait(futures, timeout)
+    return not pending
+
+
+def forget():
+    global _loop
+    _loop = None
+)py";
+
+  static PyObject *async_module = nullptr;
+
+  static PyObject *
+  py_async_module ()
+  {
+#if PY_VERSION_HEX < 0x03050000
+    error ("pythonic: asynchronous Python calls require Python 3.5 or newer");
+#else
+    if (! async_module)
+      {
+        python_object module = PyModule_New ("_pythonic_async");
+        if (! module)
+          error_python_exception ();
+
+        PyObject *dict = PyModule_GetDict (module);
+        python_object res = py_exec_string (py_async_source, dict, dict);
+
+        async_module = module.release ();
+      }
+#endif
+    return async_module;
+  }
+
+  bool
+  py_async_is_coroutine (PyObject *obj)
+  {
+#if PY_VERSION_HEX >= 0x03050000
+    return obj && PyCoro_CheckExact (obj);
+#else
+    return false;
+#endif
+  }
+
+  PyObject *
+  py_async_submit (PyObject *obj)
+  {
+    python_object name = PyUnicode_FromString ("submit");
+    python_object future = PyObject_CallMethodObjArgs (py_async_module (),
+                                                       name, obj, nullptr);
+    if (! future)
+      error_python_exception ();
+
+    return future.release ();
+  }
+
+  bool
+  py_async_wait (PyObject *futures, double timeout)
+  {
+    // Wait in short intervals so that an interrupt is seen promptly.
+    const double interval = 0.1;
+
+    PyObject *module = py_async_module ();
+
+    for (;;)
+      {
+        double t = (timeout < 0) ? interval : std::min (timeout, interval);
+
+        python_object done = PyObject_CallMethod (module, "wait", "Od",
+                                                  futures, t);
+        if (! done)
+          error_python_exception ();
+
+        if (PyObject_IsTrue (done))
+          return true;
+
+        if (timeout >= 0)
+          {
+            timeout -= t;
+            if (timeout <= 0)
+              return false;
+          }
+
+        octave_quit ();
+      }
+  }
+
+  void
+  py_async_reset_after_fork ()
+  {
+    if (! async_module)
+      return;
+
+    python_object res = PyObject_CallMethod (async_module, "forget", nullptr);
+    if (! res)
+      PyErr_Clear ();
+  }
+
+}
@@ -0,0 +1,71 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+#if ! defined (pythonic_oct_py_async_h)
+#define pythonic_oct_py_async_h 1
+
+#include <Python.h>
+
+namespace pythonic
+{
+
+  //! Check whether an object is a coroutine.
+  //!
+  //! @param obj Python object
+  //! @return @c true if @a obj is a native coroutine object, @c false
+  //!         otherwise
+  bool
+  py_async_is_coroutine (PyObject *obj);
+
+  //! Schedule an awaitable object on the background event loop.
+  //!
+  //! The event loop runs in a separate thread that is started on first use.
+  //! A future that is already scheduled is returned unchanged.
+  //!
+  //! @param obj coroutine, awaitable, or concurrent.futures.Future object
+  //! @return a reference to a concurrent.futures.Future object
+  PyObject *
+  py_async_submit (PyObject *obj);
+
+  //! Wait for futures scheduled on the background event loop to complete.
+  //!
+  //! The wait is interruptible from Octave.
+  //!
+  //! @param futures list of concurrent.futures.Future objects
+  //! @param timeout maximum time to wait in seconds, or a negative value to
+  //!        wait without a time limit
+  //! @return @c true if all futures are done, @c false on timeout
+  bool
+  py_async_wait (PyObject *futures, double timeout);
+
+  //! Forget the background event loop in a forked child.
+  //!
+  //! The event loop thread does not exist in the child, a new one is
+  //! started the next time an awaitable object is scheduled.
+  void
+  py_async_reset_after_fork ();
+
+}
+
+#endif
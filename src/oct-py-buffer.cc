@@ -0,0 +1,1322 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+#if defined (HAVE_CONFIG_H)
+#  include <config.h>
+#endif
+
+#include <Python.h>
+#include <cctype>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <octave/oct.h>
+#include <octave/oct-map.h>
+
+#include "oct-py-buffer.h"
+#include "oct-py-error.h"
+#include "oct-py-object.h"
+#include "oct-py-stats.h"
+#include "oct-py-util.h"
+
+// DLPack tensor structures, as specified in
+// https://github.com/dmlc/dlpack/blob/main/include/dlpack/dlpack.h
+
+#if ! defined (DLPACK_VERSION)
+#define DLPACK_VERSION 80
+
+#define DLPACK_FLAG_BITMASK_READ_ONLY (UINT64_C (1) << 0)
+#define DLPACK_FLAG_BITMASK_IS_COPIED (UINT64_C (1) << 1)
+
+extern "C"
+{
+  enum DLDeviceType
+  {
+    kDLCPU = 1
+  };
+
+  struct DLDevice
+  {
+    int32_t device_type;
+    int32_t device_id;
+  };
+
+  enum DLDataTypeCode
+  {
+    kDLInt = 0,
+    kDLUInt = 1,
+    kDLFloat = 2,
+    kDLComplex = 5,
+    kDLBool = 6
+  };
+
+  struct DLDataType
+  {
+    uint8_t code;
+    uint8_t bits;
+    uint16_t lanes;
+  };
+
+  struct DLTensor
+  {
+    void *data;
+    DLDevice device;
+    int32_t ndim;
+    DLDataType dtype;
+    int64_t *shape;
+    int64_t *strides;
+    uint64_t byte_offset;
+  };
+
+  struct DLManagedTensor
+  {
+    DLTensor dl_tensor;
+    void *manager_ctx;
+    void (*deleter) (DLManagedTensor *);
+  };
+
+  struct DLPackVersion
+  {
+    uint32_t major;
+    uint32_t minor;
+  };
+
+  struct DLManagedTensorVersioned
+  {
+    DLPackVersion version;
+    void *manager_ctx;
+    void (*deleter) (DLManagedTensorVersioned *);
+    uint64_t flags;
+    DLTensor dl_tensor;
+  };
+}
+
+#endif
+
+namespace pythonic
+{
+
+  struct py_octave_array
+  {
+    PyObject_HEAD
+    py_array_holder *holder;
+    std::string *format;
+    DLDataType dtype;
+    bool readonly;
+    Py_ssize_t itemsize;
+    Py_ssize_t nbytes;
+    int ndim;
+    Py_ssize_t *shape;
+    Py_ssize_t *strides;
+  };
+
+  static void
+  py_octave_array_dealloc (PyObject *self)
+  {
+    py_octave_array *arr = reinterpret_cast<py_octave_array *> (self);
+    delete arr->holder;
+    delete arr->format;
+    delete [] arr->shape;
+    Py_TYPE (self)->tp_free (self);
+  }
+
+  static PyObject *
+  py_octave_array_repr (PyObject *self)
+  {
+    py_octave_array *arr = reinterpret_cast<py_octave_array *> (self);
+    std::string dims;
+    for (int i = 0; i < arr->ndim; i++)
+      dims += (i ? "x" : "") + std::to_string (arr->shape[i]);
+    std::string s = "<Octave array of shape " + dims + " and format '"
+                    + *arr->format + "'>";
+    return PyUnicode_FromString (s.c_str ());
+  }
+
+  static int
+  py_octave_array_getbuffer (PyObject *self, Py_buffer *view, int flags)
+  {
+    py_octave_array *arr = reinterpret_cast<py_octave_array *> (self);
+
+    view->obj = nullptr;
+
+    if (arr->readonly && (flags & PyBUF_WRITABLE) == PyBUF_WRITABLE)
+      {
+        PyErr_SetString (PyExc_BufferError, "Octave array is read-only");
+        return -1;
+      }
+
+    // Data is in Fortran order, only vectors are also C-contiguous.
+    bool c_order_ok = (arr->ndim <= 1);
+    if (! c_order_ok
+        && ((flags & PyBUF_STRIDES) != PyBUF_STRIDES
+            || (flags & PyBUF_C_CONTIGUOUS) == PyBUF_C_CONTIGUOUS))
+      {
+        PyErr_SetString (PyExc_BufferError,
+                         "Octave array is not C-contiguous");
+        return -1;
+      }
+
+    view->buf = const_cast<void *> (arr->holder->data ());
+    view->len = arr->nbytes;
+    view->readonly = arr->readonly;
+    view->itemsize = arr->itemsize;
+    view->format = ((flags & PyBUF_FORMAT) == PyBUF_FORMAT)
+                   ? const_cast<char *> (arr->format->c_str ()) : nullptr;
+    if ((flags & PyBUF_ND) == PyBUF_ND)
+      {
+        view->ndim = arr->ndim;
+        view->shape = arr->shape;
+      }
+    else
+      {
+        view->ndim = 1;
+        view->shape = nullptr;
+      }
+    view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES)
+                    ? arr->strides : nullptr;
+    view->suboffsets = nullptr;
+    view->internal = nullptr;
+
+    Py_INCREF (self);
+    view->obj = self;
+
+    return 0;
+  }
+
+  static PyBufferProcs py_octave_array_as_buffer {
+#if PY_VERSION_HEX < 0x03000000
+    nullptr, nullptr, nullptr, nullptr,
+#endif
+    py_octave_array_getbuffer,
+    nullptr
+  };
+
+  // DLPack export.  The tensor holds a reference to the Octave array
+  // object, which keeps the Octave data alive until the consumer calls
+  // the deleter.  A copied tensor owns its data instead.
+
+  struct py_dlpack_context
+  {
+    PyObject *owner;
+    std::vector<int64_t> shape;
+    std::vector<int64_t> strides;
+    std::vector<unsigned char> data;
+  };
+
+  static void
+  py_dlpack_context_free (void *ctx)
+  {
+    py_dlpack_context *context = static_cast<py_dlpack_context *> (ctx);
+    PyGILState_STATE state = PyGILState_Ensure ();
+    Py_DECREF (context->owner);
+    PyGILState_Release (state);
+    delete context;
+  }
+
+  static void
+  py_dlpack_deleter (DLManagedTensor *tensor)
+  {
+    py_dlpack_context_free (tensor->manager_ctx);
+    delete tensor;
+  }
+
+  static void
+  py_dlpack_versioned_deleter (DLManagedTensorVersioned *tensor)
+  {
+    py_dlpack_context_free (tensor->manager_ctx);
+    delete tensor;
+  }
+
+  static void
+  py_dlpack_capsule_destructor (PyObject *capsule)
+  {
+    // A consumer renames the capsule when it takes ownership of the tensor
+    if (PyCapsule_IsValid (capsule, "dltensor"))
+      {
+        DLManagedTensor *tensor = static_cast<DLManagedTensor *>
+          (PyCapsule_GetPointer (capsule, "dltensor"));
+        tensor->deleter (tensor);
+      }
+    else if (PyCapsule_IsValid (capsule, "dltensor_versioned"))
+      {
+        DLManagedTensorVersioned *tensor = static_cast<DLManagedTensorVersioned *>
+          (PyCapsule_GetPointer (capsule, "dltensor_versioned"));
+        tensor->deleter (tensor);
+      }
+  }
+
+  static PyObject *
+  py_octave_array_dlpack (PyObject *self, PyObject *args, PyObject *kwargs)
+  {
+    py_octave_array *arr = reinterpret_cast<py_octave_array *> (self);
+
+    // The stream argument does not apply to CPU arrays.
+    static const char *keywords[] = {"stream", "max_version", "dl_device",
+                                     "copy", nullptr};
+    PyObject *stream = Py_None;
+    PyObject *max_version = Py_None;
+    PyObject *dl_device = Py_None;
+    PyObject *copy = Py_None;
+    if (! PyArg_ParseTupleAndKeywords (args, kwargs, "|OOOO",
+                                       const_cast<char **> (keywords),
+                                       &stream, &max_version, &dl_device,
+                                       &copy))
+      return nullptr;
+
+    if (arr->dtype.bits == 0)
+      {
+        PyErr_SetString (PyExc_BufferError,
+                         "record arrays cannot be exported with DLPack");
+        return nullptr;
+      }
+
+    if (dl_device != Py_None)
+      {
+        long device_type = -1;
+        if (PyTuple_Check (dl_device) && PyTuple_Size (dl_device) == 2)
+          {
+            device_type = PyLong_AsLong (PyTuple_GET_ITEM (dl_device, 0));
+            if (device_type == -1 && PyErr_Occurred ())
+              return nullptr;
+          }
+        if (device_type != kDLCPU)
+          {
+            PyErr_SetString (PyExc_BufferError,
+                             "Octave arrays can only be exported to the CPU");
+            return nullptr;
+          }
+      }
+
+    int copy_requested = -1;
+    if (copy != Py_None)
+      {
+        copy_requested = PyObject_IsTrue (copy);
+        if (copy_requested < 0)
+          return nullptr;
+      }
+
+    long major = 0;
+    if (max_version != Py_None)
+      {
+        if (! (PyTuple_Check (max_version) && PyTuple_Size (max_version) >= 1))
+          {
+            PyErr_SetString (PyExc_TypeError,
+                             "max_version must be a tuple of two integers");
+            return nullptr;
+          }
+        major = PyLong_AsLong (PyTuple_GET_ITEM (max_version, 0));
+        if (major == -1 && PyErr_Occurred ())
+          return nullptr;
+      }
+
+    // The unversioned protocol cannot mark the tensor as read-only, so a
+    // consumer of it gets a copy rather than Octave's shared data.
+    bool copied = (copy_requested == 1 || (major < 1 && arr->readonly));
+    if (copied && copy_requested == 0)
+      {
+        PyErr_SetString (PyExc_BufferError,
+                         "read-only Octave arrays can only be exported "
+                         "without a copy with DLPack version 1 or later");
+        return nullptr;
+      }
+
+    py_dlpack_context *context = new py_dlpack_context;
+    context->shape.assign (arr->shape, arr->shape + arr->ndim);
+    for (int i = 0; i < arr->ndim; i++)
+      context->strides.push_back (arr->strides[i] / arr->itemsize);
+    Py_INCREF (self);
+    context->owner = self;
+
+    void *data = const_cast<void *> (arr->holder->data ());
+    if (copied)
+      {
+        const unsigned char *bytes = static_cast<const unsigned char *> (data);
+        context->data.assign (bytes, bytes + arr->nbytes);
+        data = context->data.data ();
+      }
+
+    DLTensor tensor;
+    tensor.data = data;
+    tensor.device.device_type = kDLCPU;
+    tensor.device.device_id = 0;
+    tensor.ndim = arr->ndim;
+    tensor.dtype = arr->dtype;
+    tensor.shape = context->shape.data ();
+    tensor.strides = context->strides.data ();
+    tensor.byte_offset = 0;
+
+    PyObject *capsule = nullptr;
+    if (major >= 1)
+      {
+        DLManagedTensorVersioned *managed = new DLManagedTensorVersioned;
+        managed->version.major = 1;
+        managed->version.minor = 0;
+        managed->manager_ctx = context;
+        managed->deleter = py_dlpack_versioned_deleter;
+        managed->flags = copied ? DLPACK_FLAG_BITMASK_IS_COPIED
+                                : DLPACK_FLAG_BITMASK_READ_ONLY;
+        managed->dl_tensor = tensor;
+        capsule = PyCapsule_New (managed, "dltensor_versioned",
+                                 py_dlpack_capsule_destructor);
+        if (! capsule)
+          managed->deleter (managed);
+      }
+    else
+      {
+        DLManagedTensor *managed = new DLManagedTensor;
+        managed->dl_tensor = tensor;
+        managed->manager_ctx = context;
+        managed->deleter = py_dlpack_deleter;
+        capsule = PyCapsule_New (managed, "dltensor",
+                                 py_dlpack_capsule_destructor);
+        if (! capsule)
+          managed->deleter (managed);
+      }
+
+    return capsule;
+  }
+
+  static PyObject *
+  py_octave_array_dlpack_device (PyObject *, PyObject *)
+  {
+    return Py_BuildValue ("(ii)", static_cast<int> (kDLCPU), 0);
+  }
+
+  static PyMethodDef py_octave_array_methods[] {
+    {"__dlpack__", reinterpret_cast<PyCFunction> (reinterpret_cast<void (*) ()> (py_octave_array_dlpack)),
+     METH_VARARGS | METH_KEYWORDS,
+     "Export the array as a DLPack capsule"},
+    {"__dlpack_device__", py_octave_array_dlpack_device, METH_NOARGS,
+     "Return the DLPack device type and id of the array"},
+    {nullptr, nullptr, 0, nullptr}
+  };
+
+  static PyTypeObject py_octave_array_type = PyTypeObject ();
+
+  static PyTypeObject *
+  py_octave_array_type_ready ()
+  {
+    static bool ready = false;
+    if (! ready)
+      {
+        py_octave_array_type.tp_name = "pythonic.OctaveArray";
+        py_octave_array_type.tp_basicsize = sizeof (py_octave_array);
+        py_octave_array_type.tp_dealloc = py_octave_array_dealloc;
+        py_octave_array_type.tp_repr = py_octave_array_repr;
+        py_octave_array_type.tp_as_buffer = &py_octave_array_as_buffer;
+        py_octave_array_type.tp_methods = py_octave_array_methods;
+        py_octave_array_type.tp_flags = Py_TPFLAGS_DEFAULT
+#if PY_VERSION_HEX < 0x03000000
+                                        | Py_TPFLAGS_HAVE_NEWBUFFER
+#endif
+                                        ;
+        py_octave_array_type.tp_doc = "Read-only view of an Octave array";
+        Py_INCREF (&py_octave_array_type);
+        if (PyType_Ready (&py_octave_array_type) < 0)
+          error_python_exception ();
+        ready = true;
+      }
+    return &py_octave_array_type;
+  }
+
+  template <typename T>
+  static py_array_holder *
+  make_holder (const Array<T>& array)
+  {
+    return new py_typed_array_holder<T> (array);
+  }
+
+  PyObject *
+  make_py_buffer (const octave_value& value)
+  {
+    if (! (value.isnumeric () || value.islogical ()) || value.issparse ())
+      error ("unable to export Octave type \"%s\" as a Python buffer",
+             value.type_name ().c_str ());
+
+    py_array_holder *holder = nullptr;
+    const char *format = nullptr;
+    Py_ssize_t itemsize = 0;
+
+    if (value.islogical ())
+      {
+        holder = make_holder (value.bool_array_value ());
+        format = "?";
+        itemsize = sizeof (bool);
+      }
+    else if (value.is_double_type () && value.iscomplex ())
+      {
+        holder = make_holder (value.complex_array_value ());
+        format = "Zd";
+        itemsize = sizeof (Complex);
+      }
+    else if (value.is_double_type ())
+      {
+        holder = make_holder (value.array_value ());
+        format = "d";
+        itemsize = sizeof (double);
+      }
+    else if (value.is_single_type () && value.iscomplex ())
+      {
+        holder = make_holder (value.float_complex_array_value ());
+        format = "Zf";
+        itemsize = sizeof (FloatComplex);
+      }
+    else if (value.is_single_type ())
+      {
+        holder = make_holder (value.float_array_value ());
+        format = "f";
+        itemsize = sizeof (float);
+      }
+    else if (value.is_int8_type ())
+      {
+        holder = make_holder (value.int8_array_value ());
+        format = "b";
+        itemsize = 1;
+      }
+    else if (value.is_int16_type ())
+      {
+        holder = make_holder (value.int16_array_value ());
+        format = "h";
+        itemsize = 2;
+      }
+    else if (value.is_int32_type ())
+      {
+        holder = make_holder (value.int32_array_value ());
+        format = "i";
+        itemsize = 4;
+      }
+    else if (value.is_int64_type ())
+      {
+        holder = make_holder (value.int64_array_value ());
+        format = "q";
+        itemsize = 8;
+      }
+    else if (value.is_uint8_type ())
+      {
+        holder = make_holder (value.uint8_array_value ());
+        format = "B";
+        itemsize = 1;
+      }
+    else if (value.is_uint16_type ())
+      {
+        holder = make_holder (value.uint16_array_value ());
+        format = "H";
+        itemsize = 2;
+      }
+    else if (value.is_uint32_type ())
+      {
+        holder = make_holder (value.uint32_array_value ());
+        format = "I";
+        itemsize = 4;
+      }
+    else if (value.is_uint64_type ())
+      {
+        holder = make_holder (value.uint64_array_value ());
+        format = "Q";
+        itemsize = 8;
+      }
+    else
+      error ("unable to export Octave type \"%s\" as a Python buffer",
+             value.type_name ().c_str ());
+
+    return make_py_buffer (holder, format, itemsize, value.dims ());
+  }
+
+  // The DLPack data type of a buffer format, or a zero type if the format
+  // cannot be exported with DLPack.
+
+  static DLDataType
+  dlpack_dtype (const std::string& format, Py_ssize_t itemsize)
+  {
+    uint8_t bits = static_cast<uint8_t> (8 * itemsize);
+
+    if (format == "?")
+      return DLDataType {kDLBool, bits, 1};
+    else if (format == "d" || format == "f")
+      return DLDataType {kDLFloat, bits, 1};
+    else if (format == "Zd" || format == "Zf")
+      return DLDataType {kDLComplex, bits, 1};
+    else if (format.size () == 1 && std::strchr ("bhilqn", format[0]))
+      return DLDataType {kDLInt, bits, 1};
+    else if (format.size () == 1 && std::strchr ("BHILQN", format[0]))
+      return DLDataType {kDLUInt, bits, 1};
+
+    return DLDataType {0, 0, 0};
+  }
+
+  PyObject *
+  make_py_buffer (py_array_holder *holder, const std::string& format,
+                  Py_ssize_t itemsize, dim_vector dims, bool readonly)
+  {
+    octave_idx_type numel = dims.numel ();
+    int ndim = dims.ndims ();
+    if (ndim == 2 && (dims(0) == 1 || dims(1) == 1))
+      {
+        ndim = 1;
+        dims = dim_vector (numel, 1);
+      }
+
+    PyTypeObject *type = py_octave_array_type_ready ();
+    py_octave_array *arr = PyObject_New (py_octave_array, type);
+    if (! arr)
+      {
+        delete holder;
+        error_python_exception ();
+      }
+
+    arr->holder = holder;
+    arr->format = new std::string (format);
+    arr->dtype = dlpack_dtype (format, itemsize);
+    arr->readonly = readonly;
+    arr->itemsize = itemsize;
+    arr->nbytes = numel * itemsize;
+    arr->ndim = ndim;
+    arr->shape = new Py_ssize_t [2 * ndim];
+    arr->strides = arr->shape + ndim;
+
+    Py_ssize_t stride = itemsize;
+    for (int i = 0; i < ndim; i++)
+      {
+        arr->shape[i] = dims(i);
+        arr->strides[i] = stride;
+        stride *= dims(i);
+      }
+
+    return reinterpret_cast<PyObject *> (arr);
+  }
+
+  bool
+  py_is_buffer (PyObject *obj)
+  {
+    return (obj && PyObject_CheckBuffer (obj) && ! PyBytes_Check (obj)
+            && ! PyByteArray_Check (obj) && ! PyUnicode_Check (obj));
+  }
+
+  // Copy the elements of a strided array into a Fortran-ordered array.
+  // Strides are in bytes.
+
+  template <typename S>
+  static void
+  copy_strided (const char *src, int ndim, const S *shape, const S *strides,
+                Py_ssize_t itemsize, char *dst)
+  {
+    Py_ssize_t n = 1;
+    for (int i = 0; i < ndim; i++)
+      n *= shape[i];
+
+    std::vector<S> index (ndim, 0);
+
+    for (Py_ssize_t k = 0; k < n; k++)
+      {
+        std::memcpy (dst, src, itemsize);
+        dst += itemsize;
+
+        // Advance the first index fastest, as in Octave's memory order.
+        for (int i = 0; i < ndim; i++)
+          {
+            src += strides[i];
+            if (++index[i] < shape[i])
+              break;
+            src -= strides[i] * shape[i];
+            index[i] = 0;
+          }
+      }
+  }
+
+  static void
+  copy_py_buffer (const Py_buffer& view, char *dst)
+  {
+    py_stats_add_bytes (view.ndim == 0 ? view.itemsize : view.len);
+
+    if (view.ndim == 0)
+      {
+        std::memcpy (dst, view.buf, view.itemsize);
+        return;
+      }
+
+    if (PyBuffer_IsContiguous (&view, 'F'))
+      {
+        std::memcpy (dst, view.buf, view.len);
+        return;
+      }
+
+    copy_strided (static_cast<const char *> (view.buf), view.ndim,
+                  view.shape, view.strides, view.itemsize, dst);
+  }
+
+  template <typename A>
+  static octave_value
+  extract_py_buffer_as (const Py_buffer& view, const dim_vector& dims)
+  {
+    A array (dims);
+    copy_py_buffer (view, reinterpret_cast<char *> (array.fortran_vec ()));
+    return octave_value (array);
+  }
+
+  static octave_value
+  extract_py_buffer_integer (const Py_buffer& view, const dim_vector& dims,
+                             bool is_signed)
+  {
+    switch (view.itemsize)
+      {
+      case 1:
+        return is_signed ? extract_py_buffer_as<int8NDArray> (view, dims)
+                         : extract_py_buffer_as<uint8NDArray> (view, dims);
+      case 2:
+        return is_signed ? extract_py_buffer_as<int16NDArray> (view, dims)
+                         : extract_py_buffer_as<uint16NDArray> (view, dims);
+      case 4:
+        return is_signed ? extract_py_buffer_as<int32NDArray> (view, dims)
+                         : extract_py_buffer_as<uint32NDArray> (view, dims);
+      case 8:
+        return is_signed ? extract_py_buffer_as<int64NDArray> (view, dims)
+                         : extract_py_buffer_as<uint64NDArray> (view, dims);
+      default:
+        return octave_value ();
+      }
+  }
+
+  static bool
+  is_native_byte_order (char c)
+  {
+    switch (c)
+      {
+      case '@':
+      case '=':
+      case '^':
+        return true;
+#if (PY_LITTLE_ENDIAN)
+      case '<':
+        return true;
+#else
+      case '>':
+      case '!':
+        return true;
+#endif
+      default:
+        return false;
+      }
+  }
+
+  octave_value
+  extract_py_buffer (PyObject *obj)
+  {
+    Py_buffer view;
+    if (PyObject_GetBuffer (obj, &view, PyBUF_RECORDS_RO) < 0)
+      error_python_exception ();
+
+    std::string format = view.format ? view.format : "B";
+    if (! format.empty () && std::strchr ("@=<>!", format[0]))
+      {
+        if (! is_native_byte_order (format[0]))
+          format.clear ();
+        else
+          format.erase (0, 1);
+      }
+
+    dim_vector dims (1, 1);
+    if (view.ndim == 1)
+      dims = dim_vector (1, view.shape[0]);
+    else if (view.ndim > 1)
+      {
+        dims = dim_vector::alloc (view.ndim);
+        for (int i = 0; i < view.ndim; i++)
+          dims(i) = view.shape[i];
+      }
+
+    octave_value retval;
+
+    if (format == "d" && view.itemsize == sizeof (double))
+      retval = extract_py_buffer_as<NDArray> (view, dims);
+    else if (format == "f" && view.itemsize == sizeof (float))
+      retval = extract_py_buffer_as<FloatNDArray> (view, dims);
+    else if (format == "Zd" && view.itemsize == sizeof (Complex))
+      retval = extract_py_buffer_as<ComplexNDArray> (view, dims);
+    else if (format == "Zf" && view.itemsize == sizeof (FloatComplex))
+      retval = extract_py_buffer_as<FloatComplexNDArray> (view, dims);
+    else if (format == "?" && view.itemsize == sizeof (bool))
+      retval = extract_py_buffer_as<boolNDArray> (view, dims);
+    else if (format.size () == 1 && std::strchr ("bhilqn", format[0]))
+      retval = extract_py_buffer_integer (view, dims, true);
+    else if (format.size () == 1 && std::strchr ("BHILQN", format[0]))
+      retval = extract_py_buffer_integer (view, dims, false);
+
+    std::string fmt = view.format ? view.format : "B";
+    PyBuffer_Release (&view);
+
+    if (retval.is_undefined ())
+      error ("unable to convert Python buffer with format '%s' to an Octave "
+             "array", fmt.c_str ());
+
+    return retval;
+  }
+
+  bool
+  py_is_dlpack (PyObject *obj)
+  {
+    return (obj && ! PyType_Check (obj)
+            && PyObject_HasAttrString (obj, "__dlpack__")
+            && PyObject_HasAttrString (obj, "__dlpack_device__"));
+  }
+
+  template <typename A>
+  static octave_value
+  extract_dlpack_as (const DLTensor& tensor, const dim_vector& dims,
+                     Py_ssize_t itemsize)
+  {
+    A array (dims);
+    char *dst = reinterpret_cast<char *> (array.fortran_vec ());
+    const char *src = static_cast<const char *> (tensor.data)
+                      + tensor.byte_offset;
+
+    // Strides are in elements, a null pointer means a compact C-order array
+    int ndim = tensor.ndim;
+    std::vector<int64_t> strides (ndim);
+    int64_t stride = itemsize;
+    for (int i = ndim - 1; i >= 0; i--)
+      {
+        strides[i] = tensor.strides ? tensor.strides[i] * itemsize : stride;
+        stride *= tensor.shape[i];
+      }
+
+    bool fortran_order = true;
+    stride = itemsize;
+    for (int i = 0; i < ndim; i++)
+      {
+        if (tensor.shape[i] != 1 && strides[i] != stride)
+          fortran_order = false;
+        stride *= tensor.shape[i];
+      }
+
+    if (fortran_order)
+      std::memcpy (dst, src, array.numel () * itemsize);
+    else
+      copy_strided (src, ndim, tensor.shape, strides.data (), itemsize, dst);
+
+    return octave_value (array);
+  }
+
+  static octave_value
+  extract_dlpack_tensor (const DLTensor& tensor)
+  {
+    if (tensor.device.device_type != kDLCPU)
+      error ("unable to convert DLPack tensor on device type %d, only CPU "
+             "tensors are supported",
+             static_cast<int> (tensor.device.device_type));
+
+    dim_vector dims (1, 1);
+    if (tensor.ndim == 1)
+      dims = dim_vector (1, tensor.shape[0]);
+    else if (tensor.ndim > 1)
+      {
+        dims = dim_vector::alloc (tensor.ndim);
+        for (int i = 0; i < tensor.ndim; i++)
+          dims(i) = tensor.shape[i];
+      }
+
+    const DLDataType& dt = tensor.dtype;
+    Py_ssize_t itemsize = dt.bits / 8;
+
+    if (dt.lanes == 1)
+      switch (dt.code)
+        {
+        case kDLFloat:
+          if (dt.bits == 64)
+            return extract_dlpack_as<NDArray> (tensor, dims, itemsize);
+          else if (dt.bits == 32)
+            return extract_dlpack_as<FloatNDArray> (tensor, dims, itemsize);
+          break;
+
+        case kDLComplex:
+          if (dt.bits == 128)
+            return extract_dlpack_as<ComplexNDArray> (tensor, dims, itemsize);
+          else if (dt.bits == 64)
+            return extract_dlpack_as<FloatComplexNDArray> (tensor, dims,
+                                                           itemsize);
+          break;
+
+        case kDLBool:
+          if (dt.bits == 8)
+            return extract_dlpack_as<boolNDArray> (tensor, dims, itemsize);
+          break;
+
+        case kDLInt:
+          if (dt.bits == 8)
+            return extract_dlpack_as<int8NDArray> (tensor, dims, itemsize);
+          else if (dt.bits == 16)
+            return extract_dlpack_as<int16NDArray> (tensor, dims, itemsize);
+          else if (dt.bits == 32)
+            return extract_dlpack_as<int32NDArray> (tensor, dims, itemsize);
+          else if (dt.bits == 64)
+            return extract_dlpack_as<int64NDArray> (tensor, dims, itemsize);
+          break;
+
+        case kDLUInt:
+          if (dt.bits == 8)
+            return extract_dlpack_as<uint8NDArray> (tensor, dims, itemsize);
+          else if (dt.bits == 16)
+            return extract_dlpack_as<uint16NDArray> (tensor, dims, itemsize);
+          else if (dt.bits == 32)
+            return extract_dlpack_as<uint32NDArray> (tensor, dims, itemsize);
+          else if (dt.bits == 64)
+            return extract_dlpack_as<uint64NDArray> (tensor, dims, itemsize);
+          break;
+
+        default:
+          break;
+        }
+
+    error ("unable to convert DLPack tensor with type code %d, %d bits, and "
+           "%d lanes to an Octave array", dt.code, dt.bits, dt.lanes);
+  }
+
+  octave_value
+  extract_py_dlpack (PyObject *obj)
+  {
+    // Ask for a versioned tensor first, older producers do not accept the
+    // max_version argument.
+    python_object capsule;
+    {
+      python_object args = PyTuple_New (0);
+      python_object kwargs = Py_BuildValue ("{s:(ii)}", "max_version", 1, 0);
+      python_object method = PyObject_GetAttrString (obj, "__dlpack__");
+      if (! (args && kwargs && method))
+        error_python_exception ();
+      capsule = python_object (PyObject_Call (method, args, kwargs));
+      if (! capsule && PyErr_ExceptionMatches (PyExc_TypeError))
+        {
+          PyErr_Clear ();
+          capsule = python_object (PyObject_CallObject (method, nullptr));
+        }
+    }
+
+    if (! capsule)
+      error_python_exception ();
+
+    // The producer's capsule destructor calls the deleter when the capsule
+    // is released, since its name is never changed here.
+    if (PyCapsule_IsValid (capsule, "dltensor_versioned"))
+      {
+        DLManagedTensorVersioned *tensor = static_cast<DLManagedTensorVersioned *>
+          (PyCapsule_GetPointer (capsule, "dltensor_versioned"));
+        if (tensor->version.major != 1)
+          error ("unable to convert DLPack tensor with version %u.%u",
+                 tensor->version.major, tensor->version.minor);
+        return extract_dlpack_tensor (tensor->dl_tensor);
+      }
+    else if (PyCapsule_IsValid (capsule, "dltensor"))
+      {
+        DLManagedTensor *tensor = static_cast<DLManagedTensor *>
+          (PyCapsule_GetPointer (capsule, "dltensor"));
+        return extract_dlpack_tensor (tensor->dl_tensor);
+      }
+
+    error ("unable to convert DLPack tensor, __dlpack__ did not return a "
+           "DLPack capsule");
+  }
+
+  // Record arrays.  Each element of a struct array is packed into one
+  // record, with the fields in order and without padding.
+
+  struct py_record_field
+  {
+    std::string name;
+    std::string code;
+    Py_ssize_t offset;
+    Py_ssize_t size;
+  };
+
+  static bool
+  record_field_code (const octave_value& value, std::string& code,
+                     Py_ssize_t& size)
+  {
+    if (! (value.isnumeric () || value.islogical ()) || value.issparse ()
+        || value.numel () != 1)
+      return false;
+
+    if (value.islogical ())
+      code = "?", size = 1;
+    else if (value.is_double_type ())
+      code = value.iscomplex () ? "Zd" : "d", size = value.iscomplex () ? 16 : 8;
+    else if (value.is_single_type ())
+      code = value.iscomplex () ? "Zf" : "f", size = value.iscomplex () ? 8 : 4;
+    else if (value.is_int8_type ())
+      code = "b", size = 1;
+    else if (value.is_int16_type ())
+      code = "h", size = 2;
+    else if (value.is_int32_type ())
+      code = "i", size = 4;
+    else if (value.is_int64_type ())
+      code = "q", size = 8;
+    else if (value.is_uint8_type ())
+      code = "B", size = 1;
+    else if (value.is_uint16_type ())
+      code = "H", size = 2;
+    else if (value.is_uint32_type ())
+      code = "I", size = 4;
+    else if (value.is_uint64_type ())
+      code = "Q", size = 8;
+    else
+      return false;
+
+    return true;
+  }
+
+  template <typename T>
+  static inline void
+  store_record_value (char *dst, T value)
+  {
+    std::memcpy (dst, &value, sizeof (T));
+  }
+
+  static void
+  pack_record_value (const octave_value& value, const std::string& code,
+                     char *dst)
+  {
+    switch (code[0])
+      {
+      case '?':
+        store_record_value<uint8_t> (dst, value.bool_value ());
+        break;
+      case 'd':
+        store_record_value (dst, value.double_value ());
+        break;
+      case 'f':
+        store_record_value (dst, value.float_value ());
+        break;
+      case 'Z':
+        if (code[1] == 'd')
+          store_record_value (dst, value.complex_value ());
+        else
+          store_record_value (dst, value.float_complex_value ());
+        break;
+      case 'b':
+        store_record_value (dst, value.int8_scalar_value ().value ());
+        break;
+      case 'h':
+        store_record_value (dst, value.int16_scalar_value ().value ());
+        break;
+      case 'i':
+        store_record_value (dst, value.int32_scalar_value ().value ());
+        break;
+      case 'q':
+        store_record_value (dst, value.int64_scalar_value ().value ());
+        break;
+      case 'B':
+        store_record_value (dst, value.uint8_scalar_value ().value ());
+        break;
+      case 'H':
+        store_record_value (dst, value.uint16_scalar_value ().value ());
+        break;
+      case 'I':
+        store_record_value (dst, value.uint32_scalar_value ().value ());
+        break;
+      case 'Q':
+        store_record_value (dst, value.uint64_scalar_value ().value ());
+        break;
+      }
+  }
+
+  PyObject *
+  make_py_record_array (const octave_map& map)
+  {
+    string_vector names = map.fieldnames ();
+    octave_idx_type n = map.numel ();
+
+    if (n == 0 || names.numel () == 0)
+      error ("unable to convert empty Octave struct array to a Python object");
+
+    std::vector<py_record_field> fields;
+    std::string format = "T{=";
+    Py_ssize_t itemsize = 0;
+
+    for (octave_idx_type i = 0; i < names.numel (); i++)
+      {
+        std::string name = names(i);
+        const Cell values = map.contents (name);
+
+        std::string code;
+        Py_ssize_t size = 0;
+        for (octave_idx_type k = 0; k < n; k++)
+          {
+            std::string elt_code;
+            Py_ssize_t elt_size = 0;
+            if (! record_field_code (values.xelem (k), elt_code, elt_size))
+              error ("unable to convert Octave struct array to a Python "
+                     "object, field \"%s\" must contain only numeric or "
+                     "logical scalars", name.c_str ());
+
+            // Real and complex values of the same precision are combined
+            if (k == 0 || elt_code == code || code == "Z" + elt_code)
+              ;
+            else if (elt_code == "Z" + code)
+              code.clear ();
+            else
+              error ("unable to convert Octave struct array to a Python "
+                     "object, field \"%s\" must have the same type in all "
+                     "elements", name.c_str ());
+
+            if (code.empty ())
+              {
+                code = elt_code;
+                size = elt_size;
+              }
+          }
+
+        fields.push_back ({name, code, itemsize, size});
+        format += code + ":" + name + ":";
+        itemsize += size;
+      }
+
+    format += "}";
+
+    Array<char> data (dim_vector (n * itemsize, 1));
+    char *dst = data.fortran_vec ();
+
+    for (const py_record_field& field : fields)
+      {
+        const Cell values = map.contents (field.name);
+        for (octave_idx_type k = 0; k < n; k++)
+          pack_record_value (values.xelem (k), field.code,
+                             dst + k * itemsize + field.offset);
+      }
+
+    // The packed data is not shared with any Octave value, so it is
+    // exported writable.
+    python_object buf = make_py_buffer (make_holder (data), format, itemsize,
+                                        map.dims (), false);
+
+    // Prefer a NumPy structured array when NumPy is available
+    python_object numpy = py_import_module ("numpy");
+    python_object retval;
+    if (numpy)
+      retval = python_object (PyObject_CallMethod (numpy, "asarray", "(O)",
+                                                   static_cast<PyObject *> (buf)));
+    else
+      retval = python_object (PyMemoryView_FromObject (buf));
+
+    if (! retval)
+      error_python_exception ();
+
+    return retval.release ();
+  }
+
+  // Parse a struct format string of the form "T{...}" into fields.  Only
+  // named scalar fields and padding are supported.
+
+  static bool
+  parse_record_format (const std::string& format, Py_ssize_t itemsize,
+                       std::vector<py_record_field>& fields)
+  {
+    std::string::size_type pos = format.find_first_not_of ("@=<>!^");
+    if (pos == std::string::npos || format.compare (pos, 2, "T{") != 0)
+      return false;
+    pos += 2;
+
+    Py_ssize_t offset = 0;
+    bool native_size = true;
+
+    while (pos < format.size () && format[pos] != '}')
+      {
+        char c = format[pos];
+        if (std::strchr ("@=<>!^", c))
+          {
+            if (! is_native_byte_order (c))
+              return false;
+            native_size = (c == '@' || c == '^');
+            pos++;
+            continue;
+          }
+
+        Py_ssize_t count = 1;
+        if (std::isdigit (static_cast<unsigned char> (c)))
+          {
+            std::string::size_type end = format.find_first_not_of ("0123456789", pos);
+            if (end == std::string::npos)
+              return false;
+            count = std::stol (format.substr (pos, end - pos));
+            pos = end;
+          }
+
+        std::string code (1, format[pos++]);
+        if (code == "Z" && pos < format.size ())
+          code += format[pos++];
+
+        if (code == "x")
+          {
+            offset += count;
+            continue;
+          }
+
+        Py_ssize_t size = 0;
+        if (code == "d" || code == "q" || code == "Q" || code == "Zf")
+          size = 8;
+        else if (code == "f" || code == "i" || code == "I")
+          size = 4;
+        else if (code == "h" || code == "H")
+          size = 2;
+        else if (code == "b" || code == "B" || code == "?")
+          size = 1;
+        else if (code == "Zd")
+          size = 16;
+        else if (code == "l" || code == "L")
+          size = native_size ? sizeof (long) : 4;
+        else if (code == "n" || code == "N")
+          size = sizeof (Py_ssize_t);
+        else
+          return false;
+
+        std::string::size_type end = std::string::npos;
+        if (count != 1 || pos >= format.size () || format[pos] != ':'
+            || (end = format.find (':', pos + 1)) == std::string::npos)
+          return false;
+
+        fields.push_back ({format.substr (pos + 1, end - pos - 1), code,
+                           offset, size});
+        offset += size;
+        pos = end + 1;
+      }
+
+    return (pos < format.size () && offset == itemsize);
+  }
+
+  template <typename T>
+  static inline T
+  load_record_value (const char *src)
+  {
+    T value;
+    std::memcpy (&value, src, sizeof (T));
+    return value;
+  }
+
+  static octave_value
+  unpack_record_value (const char *src, const py_record_field& field)
+  {
+    bool is_signed = std::strchr ("bhilqn", field.code[0]);
+
+    switch (field.code[0])
+      {
+      case '?':
+        return octave_value (load_record_value<uint8_t> (src) != 0);
+      case 'd':
+        return octave_value (load_record_value<double> (src));
+      case 'f':
+        return octave_value (load_record_value<float> (src));
+      case 'Z':
+        if (field.code[1] == 'd')
+          return octave_value (load_record_value<Complex> (src));
+        else
+          return octave_value (load_record_value<FloatComplex> (src));
+      default:
+        break;
+      }
+
+    switch (field.size)
+      {
+      case 1:
+        return is_signed ? octave_value (octave_int8 (load_record_value<int8_t> (src)))
+                         : octave_value (octave_uint8 (load_record_value<uint8_t> (src)));
+      case 2:
+        return is_signed ? octave_value (octave_int16 (load_record_value<int16_t> (src)))
+                         : octave_value (octave_uint16 (load_record_value<uint16_t> (src)));
+      case 4:
+        return is_signed ? octave_value (octave_int32 (load_record_value<int32_t> (src)))
+                         : octave_value (octave_uint32 (load_record_value<uint32_t> (src)));
+      default:
+        return is_signed ? octave_value (octave_int64 (load_record_value<int64_t> (src)))
+                         : octave_value (octave_uint64 (load_record_value<uint64_t> (src)));
+      }
+  }
+
+  bool
+  py_is_record_buffer (PyObject *obj)
+  {
+    if (! py_is_buffer (obj))
+      return false;
+
+    Py_buffer view;
+    if (PyObject_GetBuffer (obj, &view, PyBUF_RECORDS_RO) < 0)
+      {
+        PyErr_Clear ();
+        return false;
+      }
+
+    std::string format = view.format ? view.format : "";
+    PyBuffer_Release (&view);
+
+    std::string::size_type pos = format.find_first_not_of ("@=<>!^");
+    return (pos != std::string::npos && format.compare (pos, 2, "T{") == 0);
+  }
+
+  octave_map
+  extract_py_record_array (PyObject *obj)
+  {
+    Py_buffer view;
+    if (PyObject_GetBuffer (obj, &view, PyBUF_RECORDS_RO) < 0)
+      error_python_exception ();
+
+    std::string format = view.format ? view.format : "B";
+    std::vector<py_record_field> fields;
+    bool ok = parse_record_format (format, view.itemsize, fields);
+
+    dim_vector dims (1, 1);
+    if (view.ndim == 1)
+      dims = dim_vector (1, view.shape[0]);
+    else if (view.ndim > 1)
+      {
+        dims = dim_vector::alloc (view.ndim);
+        for (int i = 0; i < view.ndim; i++)
+          dims(i) = view.shape[i];
+      }
+
+    std::vector<char> data;
+    if (ok)
+      {
+        data.resize (view.len);
+        copy_py_buffer (view, data.data ());
+      }
+
+    PyBuffer_Release (&view);
+
+    if (! ok)
+      error ("unable to convert Python buffer with format '%s' to an Octave "
+             "struct array", format.c_str ());
+
+    octave_idx_type n = dims.numel ();
+    Py_ssize_t itemsize = (n > 0) ? data.size () / n : 0;
+
+    octave_map retval (dims);
+    for (const py_record_field& field : fields)
+      {
+        Cell values (dims);
+        const char *src = data.data () + field.offset;
+        for (octave_idx_type k = 0; k < n; k++)
+          values.xelem (k) = unpack_record_value (src + k * itemsize, field);
+        retval.setfield (field.name, values);
+      }
+
+    return retval;
+  }
+
+}
@@ -0,0 +1,162 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+#if ! defined (pythonic_oct_py_buffer_h)
+#define pythonic_oct_py_buffer_h 1
+
+#include <Python.h>
+#include <octave/Array.h>
+
+class octave_map;
+class octave_value;
+
+namespace pythonic
+{
+
+  //! Reference to the data of an Octave array of any element type.
+  //!
+  //! Holding the array keeps its data alive, Octave arrays share their data
+  //! until one of the copies is modified.
+  class py_array_holder
+  {
+  public:
+    virtual ~py_array_holder () = default;
+
+    virtual const void *data () const = 0;
+  };
+
+  template <typename T>
+  class py_typed_array_holder : public py_array_holder
+  {
+  public:
+    py_typed_array_holder (const Array<T>& array) : m_array (array) { }
+
+    const void *data () const { return m_array.data (); }
+
+  private:
+    Array<T> m_array;
+  };
+
+  //! Check whether an object can be converted with extract_py_buffer.
+  //!
+  //! Strings and byte strings are not considered buffers.
+  //!
+  //! @param obj Python object
+  //! @return @c true if @a obj implements the buffer protocol
+  bool
+  py_is_buffer (PyObject *obj);
+
+  //! Convert a Python object that implements the buffer protocol to an
+  //! Octave array.
+  //!
+  //! The data is copied once into a new Octave array of the matching type.
+  //! A one-dimensional buffer becomes a row vector, a buffer with more
+  //! dimensions keeps its shape.  Strided buffers in any memory order are
+  //! supported.
+  //!
+  //! @param obj Python object that implements the buffer protocol
+  //! @return Octave array
+  octave_value
+  extract_py_buffer (PyObject *obj);
+
+  //! Check whether an object can be converted with extract_py_dlpack.
+  //!
+  //! @param obj Python object
+  //! @return @c true if @a obj implements the @c __dlpack__ and
+  //!         @c __dlpack_device__ methods
+  bool
+  py_is_dlpack (PyObject *obj);
+
+  //! Convert a Python object that exports a DLPack tensor to an Octave array.
+  //!
+  //! The tensor must be on the CPU.  The data is copied once into a new
+  //! Octave array of the matching type, with the same layout rules as
+  //! extract_py_buffer.
+  //!
+  //! @param obj Python object that implements @c __dlpack__
+  //! @return Octave array
+  octave_value
+  extract_py_dlpack (PyObject *obj);
+
+  //! Return a Python object that exports the data of an Octave array.
+  //!
+  //! The returned object implements the buffer protocol and the DLPack
+  //! @c __dlpack__ protocol, and refers to the data of the Octave array
+  //! without copying it.  The data is read-only and in Fortran order.
+  //! Vectors are exported as one-dimensional arrays.
+  //!
+  //! @param value numeric, logical, or complex Octave array
+  //! @return a reference to a new Python object
+  PyObject *
+  make_py_buffer (const octave_value& value);
+
+  //! Return a Python object that exports data referenced by an array holder.
+  //!
+  //! @param holder reference to the data, owned by the returned object
+  //! @param format struct format string of one element
+  //! @param itemsize size of one element in bytes
+  //! @param dims dimensions of the data in Fortran order, vectors are
+  //!        exported as one-dimensional buffers
+  //! @param readonly whether the buffer is read-only
+  //! @return a reference to a new Python object
+  PyObject *
+  make_py_buffer (py_array_holder *holder, const std::string& format,
+                  Py_ssize_t itemsize, dim_vector dims, bool readonly = true);
+
+  //! Check whether an object is a buffer of records with named fields.
+  //!
+  //! @param obj Python object
+  //! @return @c true if @a obj implements the buffer protocol with a
+  //!         struct format of the form @c T{...}, such as a NumPy
+  //!         structured array
+  bool
+  py_is_record_buffer (PyObject *obj);
+
+  //! Convert a buffer of records to an Octave struct array.
+  //!
+  //! Each named field of the records becomes a field of the struct array
+  //! holding a scalar of the matching type.  The struct array has the shape
+  //! of the buffer, a one-dimensional buffer becomes a row.
+  //!
+  //! @param obj Python object that implements the buffer protocol
+  //! @return Octave struct array
+  octave_map
+  extract_py_record_array (PyObject *obj);
+
+  //! Pack an Octave struct array into a Python array of records.
+  //!
+  //! All fields must hold numeric or logical scalars of the same type in
+  //! every element.  The records are packed into one contiguous buffer
+  //! with a struct format string, in the order of the fields and without
+  //! padding.  The result is a NumPy structured array if NumPy can be
+  //! imported, otherwise a memoryview of the packed buffer.
+  //!
+  //! @param map Octave struct array
+  //! @return a reference to a new Python object
+  PyObject *
+  make_py_record_array (const octave_map& map);
+
+}
+
+#endif
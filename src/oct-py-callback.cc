@@ -0,0 +1,270 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+#if defined (HAVE_CONFIG_H)
+#  include <config.h>
+#endif
+
+#include <Python.h>
+#include <exception>
+#include <new>
+#if PY_VERSION_HEX < 0x03070000
+#  include <pythread.h>
+#endif
+#include <octave/oct.h>
+#include <octave/ov-fcn-handle.h>
+#include <octave/parse.h>
+#include <octave/quit.h>
+
+#include "oct-py-buffer.h"
+#include "oct-py-callback.h"
+#include "oct-py-error.h"
+#include "oct-py-lazy.h"
+#include "oct-py-object.h"
+#include "oct-py-sparse.h"
+#include "oct-py-stats.h"
+#include "oct-py-trace.h"
+#include "oct-py-types.h"
+#include "oct-py-util.h"
+
+namespace pythonic
+{
+
+  struct py_octave_function
+  {
+    PyObject_HEAD
+    octave_value *fcn;
+    unsigned long thread_id;
+  };
+
+  static void
+  py_octave_function_dealloc (PyObject *self)
+  {
+    py_octave_function *f = reinterpret_cast<py_octave_function *> (self);
+    delete f->fcn;
+    Py_TYPE (self)->tp_free (self);
+  }
+
+  static PyObject *
+  py_octave_function_repr (PyObject *self)
+  {
+    py_octave_function *f = reinterpret_cast<py_octave_function *> (self);
+    octave_fcn_handle *fh = f->fcn->fcn_handle_value ();
+    std::string s = "<Octave function " + (fh ? fh->fcn_name () : "") + ">";
+    return PyUnicode_FromString (s.c_str ());
+  }
+
+  // Convert an argument passed from Python into an Octave value.
+
+  static octave_value
+  py_callback_convert_argument (PyObject *obj)
+  {
+    if (PyBool_Check (obj))
+      return octave_value (obj == Py_True);
+    else if (PyFloat_Check (obj))
+      return octave_value (PyFloat_AsDouble (obj));
+    else if (PyLong_Check (obj))
+      {
+        // An int that a double cannot hold exactly is passed as int64 if
+        // it fits, otherwise as a Python int
+        double d = 0;
+        if (py_long_as_exact_double (obj, d))
+          return octave_value (d);
+
+        int overflow = 0;
+        PY_LONG_LONG value = PyLong_AsLongLongAndOverflow (obj, &overflow);
+        if (overflow || (value == -1 && PyErr_Occurred ()))
+          {
+            PyErr_Clear ();
+            return pyobject_wrap_object (obj);
+          }
+        return octave_value (octave_int64 (static_cast<int64_t> (value)));
+      }
+#if PY_VERSION_HEX < 0x03000000
+    else if (PyInt_Check (obj))
+      return octave_value (static_cast<double> (PyInt_AsLong (obj)));
+#endif
+    else if (PyComplex_Check (obj))
+      return octave_value (extract_py_complex (obj));
+    else if (PyUnicode_Check (obj))
+      return octave_value (extract_py_str (obj));
+    else if (py_is_buffer (obj))
+      return extract_py_buffer (obj);
+    else if (py_is_dlpack (obj))
+      return extract_py_dlpack (obj);
+    else if (py_is_sparse (obj))
+      return extract_py_sparse (obj);
+    else if (py_is_lazy_view (obj))
+      return extract_py_lazy_view (obj);
+    else
+      return pyobject_wrap_object (obj);
+  }
+
+  // Convert the value returned by the Octave function into a Python object.
+
+  static PyObject *
+  py_callback_convert_return_value (const octave_value& value)
+  {
+    if (value.is_undefined ())
+      Py_RETURN_NONE;
+
+    if ((value.isnumeric () || value.islogical ()) && ! value.issparse ()
+        && value.numel () != 1)
+      {
+        python_object buf = make_py_buffer (value);
+        return PyMemoryView_FromObject (buf);
+      }
+
+    return py_implicitly_convert_argument (value);
+  }
+
+  static PyObject *
+  py_octave_function_call (PyObject *self, PyObject *args, PyObject *kwargs)
+  {
+    py_octave_function *f = reinterpret_cast<py_octave_function *> (self);
+
+    if (static_cast<unsigned long> (PyThread_get_thread_ident ()) != f->thread_id)
+      {
+        PyErr_SetString (PyExc_RuntimeError,
+                         "Octave functions can only be called from the "
+                         "thread that created them");
+        return nullptr;
+      }
+
+    if (kwargs && PyDict_Size (kwargs) > 0)
+      {
+        PyErr_SetString (PyExc_TypeError,
+                         "Octave functions do not accept keyword arguments");
+        return nullptr;
+      }
+
+    try
+      {
+        Py_ssize_t nargs = PyTuple_Size (args);
+        octave_value_list arglist (nargs);
+        for (Py_ssize_t i = 0; i < nargs; i++)
+          arglist(i) = py_callback_convert_argument (PyTuple_GET_ITEM (args, i));
+
+        octave_value_list retval;
+        {
+          py_stats_timer timer (PY_STATS_OCTAVE);
+          py_trace_scope trace ("callback", "octave");
+          if (trace.active ())
+            {
+              octave_fcn_handle *fh = f->fcn->fcn_handle_value ();
+              if (fh)
+                trace.name ("@" + fh->fcn_name ());
+              trace.args (py_trace_summary (arglist));
+            }
+
+          retval = octave::feval (*f->fcn, arglist, 1);
+        }
+
+        return py_callback_convert_return_value (retval.length () > 0
+                                                 ? retval(0) : octave_value ());
+      }
+    catch (const octave::execution_exception& e)
+      {
+        // A Python exception raised during conversion is already set.
+        set_python_exception (PyExc_RuntimeError, e);
+      }
+    catch (const octave::interrupt_exception&)
+      {
+        PyErr_SetNone (PyExc_KeyboardInterrupt);
+      }
+    catch (const std::bad_alloc&)
+      {
+        PyErr_NoMemory ();
+      }
+    catch (const std::exception& e)
+      {
+        PyErr_SetString (PyExc_RuntimeError, e.what ());
+      }
+    catch (...)
+      {
+        PyErr_SetString (PyExc_RuntimeError,
+                         "unknown exception in Octave function");
+      }
+
+    return nullptr;
+  }
+
+  static PyTypeObject py_octave_function_type = PyTypeObject ();
+
+  static PyTypeObject *
+  py_octave_function_type_ready ()
+  {
+    static bool ready = false;
+    if (! ready)
+      {
+        py_octave_function_type.tp_name = "pythonic.OctaveFunction";
+        py_octave_function_type.tp_basicsize = sizeof (py_octave_function);
+        py_octave_function_type.tp_dealloc = py_octave_function_dealloc;
+        py_octave_function_type.tp_repr = py_octave_function_repr;
+        py_octave_function_type.tp_call = py_octave_function_call;
+        py_octave_function_type.tp_flags = Py_TPFLAGS_DEFAULT;
+        py_octave_function_type.tp_doc = "Callable Octave function handle";
+        Py_INCREF (&py_octave_function_type);
+        if (PyType_Ready (&py_octave_function_type) < 0)
+          error_python_exception ();
+        ready = true;
+      }
+    return &py_octave_function_type;
+  }
+
+  PyObject *
+  make_py_function (const octave_value& fcn)
+  {
+    if (! fcn.is_function_handle ())
+      error ("unable to convert non-function type \"%s\" to a Python callable",
+             fcn.type_name ().c_str ());
+
+    PyTypeObject *type = py_octave_function_type_ready ();
+    py_octave_function *f = PyObject_New (py_octave_function, type);
+    if (! f)
+      error_python_exception ();
+
+    f->fcn = new octave_value (fcn);
+    f->thread_id = static_cast<unsigned long> (PyThread_get_thread_ident ());
+
+    return reinterpret_cast<PyObject *> (f);
+  }
+
+  bool
+  py_is_octave_function (PyObject *obj)
+  {
+    return obj && Py_TYPE (obj) == py_octave_function_type_ready ();
+  }
+
+  octave_value
+  extract_py_function (PyObject *obj)
+  {
+    if (! py_is_octave_function (obj))
+      error_conversion_mismatch_python_type ("a function handle",
+                                             "an Octave function");
+
+    return *reinterpret_cast<py_octave_function *> (obj)->fcn;
+  }
+
+}
@@ -0,0 +1,66 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+#if ! defined (pythonic_oct_py_callback_h)
+#define pythonic_oct_py_callback_h 1
+
+#include <Python.h>
+
+class octave_value;
+
+namespace pythonic
+{
+
+  //! Return a Python callable that calls an Octave function handle.
+  //!
+  //! Positional arguments are converted to Octave values, with objects that
+  //! implement the buffer protocol or DLPack, such as NumPy arrays and CPU
+  //! tensors, copied directly into Octave arrays.  A numeric array returned by the function is passed
+  //! back to Python as a read-only memoryview of the Octave array, without
+  //! copying.  Errors in the Octave function raise a Python exception.
+  //!
+  //! The callable may only be called from the thread that created it.
+  //!
+  //! @param fcn Octave function handle
+  //! @return a reference to a new Python callable object
+  PyObject *
+  make_py_function (const octave_value& fcn);
+
+  //! Check whether an object is a Python callable for an Octave function.
+  //!
+  //! @param obj Python object
+  //! @return @c true if @a obj was created by make_py_function
+  bool
+  py_is_octave_function (PyObject *obj);
+
+  //! Return the Octave function handle called by a Python callable.
+  //!
+  //! @param obj Python object created by make_py_function
+  //! @return Octave function handle
+  octave_value
+  extract_py_function (PyObject *obj);
+
+}
+
+#endif
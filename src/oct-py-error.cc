@@ -28,10 +28,13 @@ along with Octave Pythonic; see the file COPYING.  If not, see
 
 #include <Python.h>
 #include <octave/error.h>
+#include <octave/quit.h>
+#include <octave/version.h>
 
 #include "oct-py-error.h"
 #include "oct-py-eval.h"
 #include "oct-py-object.h"
+#include "oct-py-stats.h"
 #include "oct-py-types.h"
 
 namespace pythonic
@@ -56,6 +59,8 @@ namespace pythonic
   {
     const char *format_exception_only = "traceback.format_exception_only";
 
+    py_stats_count_python_exception ();
+
     PyObject *ptype, *pvalue, *ptraceback;
     PyErr_Fetch (&ptype, &pvalue, &ptraceback);
     PyErr_NormalizeException (&ptype, &pvalue, &ptraceback);
@@ -83,4 +88,21 @@ namespace pythonic
       }
   }
 
+  void
+  set_python_exception (PyObject *type, const octave::execution_exception& e)
+  {
+    if (PyErr_Occurred ())
+      return;
+
+    py_stats_count_octave_exception ();
+
+#if OCTAVE_MAJOR_VERSION >= 6
+    std::string msg = e.message ();
+#else
+    octave_unused_parameter (e);
+    std::string msg = last_error_message ();
+#endif
+    PyErr_SetString (type, msg.c_str ());
+  }
+
 }
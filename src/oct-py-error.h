@@ -25,6 +25,7 @@ along with Octave Pythonic; see the file COPYING.  If not, see
 #if ! defined (pythonic_oct_py_error_h)
 #define pythonic_oct_py_error_h 1
 
+#include <Python.h>
 #include <string>
 
 #if defined (__GNUC__)
@@ -33,6 +34,11 @@ along with Octave Pythonic; see the file COPYING.  If not, see
 #  define PYTHONIC_ATTR_NORETURN
 #endif
 
+namespace octave
+{
+  class execution_exception;
+}
+
 namespace pythonic
 {
 
@@ -49,6 +55,41 @@ namespace pythonic
   error_python_exception ()
   PYTHONIC_ATTR_NORETURN;
 
+  //! Set a Python exception with the message of an Octave error, unless a
+  //! Python exception is already set.
+  //!
+  //! @param type Python exception type
+  //! @param e Octave error
+  void
+  set_python_exception (PyObject *type, const octave::execution_exception& e);
+
+  //! Keep the pending Python exception, if any, while calling into Python,
+  //! and restore it when the scope ends.
+  class py_error_preserve
+  {
+  public:
+
+    py_error_preserve ()
+    {
+      PyErr_Fetch (&m_type, &m_value, &m_traceback);
+    }
+
+    ~py_error_preserve ()
+    {
+      PyErr_Restore (m_type, m_value, m_traceback);
+    }
+
+    py_error_preserve (const py_error_preserve&) = delete;
+
+    py_error_preserve& operator = (const py_error_preserve&) = delete;
+
+  private:
+
+    PyObject *m_type;
+    PyObject *m_value;
+    PyObject *m_traceback;
+  };
+
 }
 
 #undef PYTHONIC_ATTR_NORETURN
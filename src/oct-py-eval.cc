@@ -30,16 +30,49 @@ along with Octave Pythonic; see the file COPYING.  If not, see
 #include <string>
 #include <octave/ov.h>
 #include <octave/ovl.h>
+#include <octave/version.h>
+#if OCTAVE_MAJOR_VERSION >= 6
+#  include <octave/interpreter.h>
+#  include <octave/profiler.h>
+#endif
 
 #include "oct-py-error.h"
 #include "oct-py-eval.h"
 #include "oct-py-object.h"
+#include "oct-py-profile.h"
+#include "oct-py-stats.h"
+#include "oct-py-trace.h"
 #include "oct-py-util.h"
 #include "oct-py-types.h"
 
 namespace pythonic
 {
 
+#if OCTAVE_MAJOR_VERSION >= 6
+  // Entry in the Octave profiler for a call to a Python function, so that
+  // profshow lists the time spent in it as "py:module.qualname" under the
+  // Octave function that called it.  The name is only looked up while the
+  // profiler is on.
+
+  class py_profiler_entry
+  {
+  public:
+
+    py_profiler_entry (PyObject *callable)
+      : m_callable (callable)
+    { }
+
+    std::string profiler_name () const
+    {
+      return "py:" + py_trace_function_name (m_callable);
+    }
+
+  private:
+
+    PyObject *m_callable;
+  };
+#endif
+
   PyObject *
   py_call_function (const std::string& func, const octave_value_list& args)
   {
@@ -60,21 +93,30 @@ namespace pythonic
   py_call_function (PyObject *callable, const octave_value_list& args)
   {
     python_object kwargs;
-    python_object args_list = PyList_New (0);
-    if (! args_list)
-      throw std::bad_alloc ();
+    python_object args_tuple;
 
-    for (int i = 0; i < args.length (); ++i)
-      {
-        python_object obj = py_implicitly_convert_argument (args(i));
+    {
+      py_stats_timer timer (PY_STATS_CONVERSION);
+      py_trace_scope trace ("convert arguments", "conversion");
+      if (trace.active ())
+        trace.args (py_trace_summary (args));
 
-        if (pythonic::is_py_kwargs_argument (obj))
-          kwargs = pythonic::update_py_dict (kwargs, obj);
-        else
-          PyList_Append (args_list, obj.release ());
-      }
+      python_object args_list = PyList_New (0);
+      if (! args_list)
+        throw std::bad_alloc ();
+
+      for (int i = 0; i < args.length (); ++i)
+        {
+          python_object obj = py_implicitly_convert_argument (args(i));
+
+          if (pythonic::is_py_kwargs_argument (obj))
+            kwargs = python_object (pythonic::update_py_dict (kwargs, obj));
+          else if (PyList_Append (args_list, obj) < 0)
+            error_python_exception ();
+        }
 
-    python_object args_tuple = PyList_AsTuple (args_list);
+      args_tuple = python_object (PyList_AsTuple (args_list));
+    }
 
     python_object retval = py_call_function (callable, args_tuple, kwargs);
 
@@ -84,7 +126,27 @@ namespace pythonic
   PyObject *
   py_call_function (PyObject *callable, PyObject *args, PyObject *kwargs)
   {
-    python_object retval = PyEval_CallObjectWithKeywords (callable, args, kwargs);
+    python_object retval;
+
+    {
+      py_stats_timer timer (PY_STATS_PYTHON);
+      py_trace_scope trace ("pycall", "python");
+      if (trace.active ())
+        {
+          trace.name (py_trace_function_name (callable));
+          trace.args (py_trace_summary (args));
+        }
+
+      py_profile_scope profile ("pycall");
+#if OCTAVE_MAJOR_VERSION >= 6
+      octave::profiler& profiler
+        = octave::interpreter::the_interpreter ()->get_profiler ();
+      octave::profiler::enter<py_profiler_entry>
+        block (profiler, py_profiler_entry (callable));
+#endif
+      retval = python_object (PyEval_CallObjectWithKeywords (callable, args, kwargs));
+    }
+
     if (! retval)
       error_python_exception ();
 
@@ -118,8 +180,19 @@ namespace pythonic
 #endif
     };
 
-    python_object retval = PyRun_StringFlags (expr.c_str (), start, globals, locals,
-                                              &flags);
+    python_object retval;
+
+    {
+      py_stats_timer timer (PY_STATS_PYTHON);
+      py_trace_scope trace (start == Py_eval_input ? "pyeval" : "pyexec",
+                            "python");
+      if (trace.active ())
+        trace.args (expr.substr (0, 80));
+
+      py_profile_scope profile (start == Py_eval_input ? "pyeval" : "pyexec");
+      retval = python_object (PyRun_StringFlags (expr.c_str (), start,
+                                                 globals, locals, &flags));
+    }
 
     if (alloc)
       Py_DECREF (globals);
@@ -28,7 +28,23 @@ along with Octave Pythonic; see the file COPYING.  If not, see
 
 #include <Python.h>
 
+#if (PY_VERSION_HEX >= 0x03070000) && ! defined (_WIN32)
+#  define PYTHONIC_FORK_HOOKS 1
+#  include <pthread.h>
+#endif
+
+#include <octave/version.h>
+#if OCTAVE_MAJOR_VERSION >= 6
+#  include <octave/interpreter.h>
+#else
+#  include <octave/variables.h>
+#endif
+
+#include "oct-py-async.h"
 #include "oct-py-init.h"
+#include "oct-py-profile.h"
+#include "oct-py-remote.h"
+#include "oct-py-util.h"
 
 namespace pythonic
 {
@@ -41,6 +57,144 @@ namespace pythonic
   static char *sys_argv[] {sys_argv0, nullptr};
 #endif
 
+#if defined (PYTHONIC_FORK_HOOKS)
+
+  // True from the time the interpreter runs its before-fork callbacks until
+  // it runs its after-fork callbacks.  A fork started by Python's own
+  // os.fork is already handled by the interpreter.
+  static bool fork_in_progress = false;
+
+  // True if the interpreter was prepared for a fork started by Octave.
+  static bool prepared_for_fork = false;
+
+  static PyObject *
+  py_fork_before (PyObject *, PyObject *)
+  {
+    fork_in_progress = true;
+    Py_RETURN_NONE;
+  }
+
+  static PyObject *
+  py_fork_after_in_parent (PyObject *, PyObject *)
+  {
+    fork_in_progress = false;
+    Py_RETURN_NONE;
+  }
+
+  static PyObject *
+  py_fork_after_in_child (PyObject *, PyObject *)
+  {
+    fork_in_progress = false;
+    py_reset_after_fork ();
+    Py_RETURN_NONE;
+  }
+
+  static PyMethodDef py_fork_methods[] {
+    {"before", py_fork_before, METH_NOARGS, nullptr},
+    {"after_in_parent", py_fork_after_in_parent, METH_NOARGS, nullptr},
+    {"after_in_child", py_fork_after_in_child, METH_NOARGS, nullptr},
+  };
+
+  // Handlers for a fork started by Octave, for example by the fork function
+  // used by the parallel package.  The interpreter state is only touched if
+  // this thread holds the GIL and is not running any Python code.  Python
+  // forks from its own code, for example in subprocess, without always
+  // running its before-fork callbacks, and the child may be about to exec.
+  // A fork started by Octave code called back from Python is therefore not
+  // prepared either.
+
+  static void
+  py_atfork_prepare ()
+  {
+    prepared_for_fork = (! fork_in_progress && Py_IsInitialized ()
+                         && PyGILState_Check () && ! PyEval_GetFrame ());
+    if (prepared_for_fork)
+      PyOS_BeforeFork ();
+  }
+
+  static void
+  py_atfork_parent ()
+  {
+    if (prepared_for_fork)
+      PyOS_AfterFork_Parent ();
+    prepared_for_fork = false;
+  }
+
+  static void
+  py_atfork_child ()
+  {
+    if (prepared_for_fork)
+      PyOS_AfterFork_Child ();
+    prepared_for_fork = false;
+  }
+
+  // Keep the .oct file that is being called loaded for the rest of the
+  // session, the fork handlers it registers can not be removed.
+
+  static void
+  py_lock_oct_file ()
+  {
+#if OCTAVE_MAJOR_VERSION >= 6
+    octave::interpreter::the_interpreter ()->mlock ();
+#else
+    mlock ();
+#endif
+  }
+
+  // Every .oct file registers its own Python fork callbacks to reset its
+  // own cached state.  The pthread_atfork handlers are registered only once
+  // in the process, marked by an attribute of the sys module, so that the
+  // interpreter is prepared for each fork only once.
+
+  static void
+  py_register_fork_hooks ()
+  {
+    static bool registered = false;
+    if (registered)
+      return;
+
+    PyObject *os = PyImport_ImportModule ("os");
+    PyObject *reg = os ? PyObject_GetAttrString (os, "register_at_fork")
+                       : nullptr;
+    PyObject *args = PyTuple_New (0);
+    PyObject *kwargs = PyDict_New ();
+    bool ok = (reg && args && kwargs);
+
+    for (PyMethodDef& def : py_fork_methods)
+      {
+        PyObject *func = ok ? PyCFunction_New (&def, nullptr) : nullptr;
+        ok = (func && PyDict_SetItemString (kwargs, def.ml_name, func) == 0);
+        Py_XDECREF (func);
+      }
+
+    if (ok)
+      py_lock_oct_file ();
+
+    PyObject *res = ok ? PyObject_Call (reg, args, kwargs) : nullptr;
+    ok = (res != nullptr);
+
+    Py_XDECREF (res);
+    Py_XDECREF (kwargs);
+    Py_XDECREF (args);
+    Py_XDECREF (reg);
+    Py_XDECREF (os);
+
+    if (! ok)
+      {
+        PyErr_Clear ();
+        return;
+      }
+
+    registered = true;
+
+    if (! PySys_GetObject ("_pythonic_atfork")
+        && PySys_SetObject ("_pythonic_atfork", Py_True) == 0)
+      pthread_atfork (py_atfork_prepare, py_atfork_parent, py_atfork_child);
+    PyErr_Clear ();
+  }
+
+#endif
+
   void
   py_init ()
   {
@@ -50,6 +204,19 @@ namespace pythonic
 
     if (! is_initialized)
       PySys_SetArgvEx (1, sys_argv, 0);
+
+#if defined (PYTHONIC_FORK_HOOKS)
+    py_register_fork_hooks ();
+#endif
+  }
+
+  void
+  py_reset_after_fork ()
+  {
+    py_objstore_reset ();
+    py_async_reset_after_fork ();
+    py_profile_reset_after_fork ();
+    py_remote_reset_after_fork ();
   }
 
 }
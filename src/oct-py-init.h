@@ -32,6 +32,13 @@ namespace pythonic
   void
   py_init ();
 
+  //! Reset cached interpreter state in a child process after a fork.
+  //!
+  //! Called automatically in the child of a fork started either by Octave
+  //! or by Python, once the interpreter itself has been made safe to use.
+  void
+  py_reset_after_fork ();
+
 }
 
 #endif
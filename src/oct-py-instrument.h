@@ -0,0 +1,77 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+#if ! defined (pythonic_oct_py_instrument_h)
+#define pythonic_oct_py_instrument_h 1
+
+namespace pythonic
+{
+
+  //! Switch of an optional instrument of the calls between Octave and
+  //! Python, such as the tracer or the profiler.
+  //!
+  //! Scopes test the switch inline, so that an instrument that is off costs
+  //! a single load and branch per call.
+  class py_instrument
+  {
+  public:
+
+    bool enabled () const { return m_enabled; }
+
+    void enable (bool on = true) { m_enabled = on; }
+
+  private:
+
+    bool m_enabled = false;
+  };
+
+  //! Base of the scope of one call seen by an instrument.
+  //!
+  //! Whether the instrument is on is recorded when the scope begins, so
+  //! that a scope that began also ends if the instrument is switched off
+  //! during the call.  A derived class begins in its constructor and ends
+  //! in its destructor, only if active () is true.
+  class py_instrument_scope
+  {
+  public:
+
+    explicit py_instrument_scope (const py_instrument& instrument)
+      : m_active (instrument.enabled ())
+    { }
+
+    py_instrument_scope (const py_instrument_scope&) = delete;
+
+    py_instrument_scope& operator = (const py_instrument_scope&) = delete;
+
+    bool active () const { return m_active; }
+
+  protected:
+
+    ~py_instrument_scope () = default;
+
+    bool m_active;
+  };
+
+}
+
+#endif
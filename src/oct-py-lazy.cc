@@ -0,0 +1,469 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+#if defined (HAVE_CONFIG_H)
+#  include <config.h>
+#endif
+
+#include <Python.h>
+#if PY_VERSION_HEX < 0x03070000
+#  include <pythread.h>
+#endif
+#include <string>
+#include <vector>
+#include <octave/oct.h>
+#include <octave/Cell.h>
+#include <octave/oct-map.h>
+#include <octave/quit.h>
+
+#include "oct-py-error.h"
+#include "oct-py-eval.h"
+#include "oct-py-lazy.h"
+#include "oct-py-object.h"
+#include "oct-py-types.h"
+
+namespace pythonic
+{
+
+  static bool lazy_conversion = false;
+
+  bool
+  py_lazy_conversion ()
+  {
+    return lazy_conversion;
+  }
+
+  void
+  py_set_lazy_conversion (bool enable)
+  {
+    lazy_conversion = enable;
+  }
+
+  // Convert one element on access, with Octave errors raised as Python
+  // exceptions.
+
+  static PyObject *
+  py_lazy_convert (const octave_value& value)
+  {
+    try
+      {
+        return py_implicitly_convert_argument (value);
+      }
+    catch (const octave::execution_exception& e)
+      {
+        set_python_exception (PyExc_TypeError, e);
+      }
+    catch (const octave::interrupt_exception&)
+      {
+        PyErr_SetNone (PyExc_KeyboardInterrupt);
+      }
+    catch (const std::bad_alloc&)
+      {
+        PyErr_NoMemory ();
+      }
+
+    return nullptr;
+  }
+
+  // Elements are converted with the Octave API, which may only be used
+  // from the thread that created the view.
+
+  static bool
+  py_lazy_check_thread (unsigned long thread_id)
+  {
+    if (static_cast<unsigned long> (PyThread_get_thread_ident ()) == thread_id)
+      return true;
+
+    PyErr_SetString (PyExc_RuntimeError,
+                     "Octave cell arrays and structs can only be accessed "
+                     "from the thread that created them");
+    return false;
+  }
+
+  // Sequence view of a cell array
+
+  struct py_lazy_cell
+  {
+    PyObject_HEAD
+    Cell *cell;
+    std::vector<PyObject *> *items;
+    unsigned long thread_id;
+  };
+
+  static void
+  py_lazy_cell_dealloc (PyObject *self)
+  {
+    py_lazy_cell *obj = reinterpret_cast<py_lazy_cell *> (self);
+    if (obj->items)
+      for (PyObject *item : *obj->items)
+        Py_XDECREF (item);
+    delete obj->items;
+    delete obj->cell;
+    Py_TYPE (self)->tp_free (self);
+  }
+
+  static PyObject *
+  py_lazy_cell_repr (PyObject *self)
+  {
+    py_lazy_cell *obj = reinterpret_cast<py_lazy_cell *> (self);
+    std::string s = "<Octave cell with " + std::to_string (obj->cell->numel ())
+                    + " elements>";
+    return PyUnicode_FromString (s.c_str ());
+  }
+
+  static Py_ssize_t
+  py_lazy_cell_length (PyObject *self)
+  {
+    return reinterpret_cast<py_lazy_cell *> (self)->cell->numel ();
+  }
+
+  static PyObject *
+  py_lazy_cell_item (PyObject *self, Py_ssize_t i)
+  {
+    py_lazy_cell *obj = reinterpret_cast<py_lazy_cell *> (self);
+
+    if (! py_lazy_check_thread (obj->thread_id))
+      return nullptr;
+
+    if (i < 0 || i >= obj->cell->numel ())
+      {
+        PyErr_SetString (PyExc_IndexError, "index out of range");
+        return nullptr;
+      }
+
+    PyObject *& item = (*obj->items)[i];
+    if (! item)
+      item = py_lazy_convert (obj->cell->xelem (i));
+
+    Py_XINCREF (item);
+    return item;
+  }
+
+  static PyObject *
+  py_lazy_cell_subscript (PyObject *self, PyObject *key)
+  {
+    Py_ssize_t len = py_lazy_cell_length (self);
+
+    if (PySlice_Check (key))
+      {
+        Py_ssize_t start, stop, step, slicelen;
+#if PY_VERSION_HEX < 0x03020000
+        if (PySlice_GetIndicesEx (reinterpret_cast<PySliceObject *> (key), len,
+                                  &start, &stop, &step, &slicelen) < 0)
+#else
+        if (PySlice_GetIndicesEx (key, len, &start, &stop, &step,
+                                  &slicelen) < 0)
+#endif
+          return nullptr;
+
+        python_object tuple = PyTuple_New (slicelen);
+        if (! tuple)
+          return nullptr;
+
+        for (Py_ssize_t k = 0, i = start; k < slicelen; k++, i += step)
+          {
+            PyObject *item = py_lazy_cell_item (self, i);
+            if (! item)
+              return nullptr;
+            PyTuple_SET_ITEM (static_cast<PyObject *> (tuple), k, item);
+          }
+
+        return tuple.release ();
+      }
+
+    Py_ssize_t i = PyNumber_AsSsize_t (key, PyExc_IndexError);
+    if (i == -1 && PyErr_Occurred ())
+      return nullptr;
+    if (i < 0)
+      i += len;
+
+    return py_lazy_cell_item (self, i);
+  }
+
+  static PySequenceMethods py_lazy_cell_as_sequence = PySequenceMethods ();
+  static PyMappingMethods py_lazy_cell_as_mapping = PyMappingMethods ();
+  static PyTypeObject py_lazy_cell_type = PyTypeObject ();
+
+  // Mapping view of a scalar struct
+
+  struct py_lazy_struct
+  {
+    PyObject_HEAD
+    octave_scalar_map *map;
+    PyObject *keys;
+    PyObject *cache;
+    unsigned long thread_id;
+  };
+
+  static void
+  py_lazy_struct_dealloc (PyObject *self)
+  {
+    py_lazy_struct *obj = reinterpret_cast<py_lazy_struct *> (self);
+    Py_XDECREF (obj->keys);
+    Py_XDECREF (obj->cache);
+    delete obj->map;
+    Py_TYPE (self)->tp_free (self);
+  }
+
+  static PyObject *
+  py_lazy_struct_repr (PyObject *self)
+  {
+    py_lazy_struct *obj = reinterpret_cast<py_lazy_struct *> (self);
+    string_vector names = obj->map->fieldnames ();
+    std::string s = "<Octave struct with fields";
+    for (octave_idx_type i = 0; i < names.numel (); i++)
+      s += (i ? ", " : " ") + names(i);
+    s += ">";
+    return PyUnicode_FromString (s.c_str ());
+  }
+
+  static Py_ssize_t
+  py_lazy_struct_length (PyObject *self)
+  {
+    return reinterpret_cast<py_lazy_struct *> (self)->map->nfields ();
+  }
+
+  static bool
+  py_lazy_struct_field (PyObject *key, std::string& name)
+  {
+    if (! PyUnicode_Check (key))
+      return false;
+
+    Py_ssize_t size = 0;
+    const char *str = PyUnicode_AsUTF8AndSize (key, &size);
+    if (! str)
+      {
+        PyErr_Clear ();
+        return false;
+      }
+
+    name.assign (str, size);
+    return true;
+  }
+
+  static PyObject *
+  py_lazy_struct_subscript (PyObject *self, PyObject *key)
+  {
+    py_lazy_struct *obj = reinterpret_cast<py_lazy_struct *> (self);
+
+    if (! py_lazy_check_thread (obj->thread_id))
+      return nullptr;
+
+    PyObject *value = PyDict_GetItem (obj->cache, key);
+    if (value)
+      {
+        Py_INCREF (value);
+        return value;
+      }
+
+    std::string name;
+    if (! (py_lazy_struct_field (key, name) && obj->map->isfield (name)))
+      {
+        PyErr_SetObject (PyExc_KeyError, key);
+        return nullptr;
+      }
+
+    value = py_lazy_convert (obj->map->getfield (name));
+    if (value && PyDict_SetItem (obj->cache, key, value) < 0)
+      Py_CLEAR (value);
+
+    return value;
+  }
+
+  static int
+  py_lazy_struct_contains (PyObject *self, PyObject *key)
+  {
+    py_lazy_struct *obj = reinterpret_cast<py_lazy_struct *> (self);
+    std::string name;
+    return py_lazy_struct_field (key, name) && obj->map->isfield (name);
+  }
+
+  static PyObject *
+  py_lazy_struct_iter (PyObject *self)
+  {
+    return PyObject_GetIter (reinterpret_cast<py_lazy_struct *> (self)->keys);
+  }
+
+  static PySequenceMethods py_lazy_struct_as_sequence = PySequenceMethods ();
+  static PyMappingMethods py_lazy_struct_as_mapping = PyMappingMethods ();
+  static PyTypeObject py_lazy_struct_type = PyTypeObject ();
+
+  // The public types derive from the C types and from the abstract base
+  // classes, which provide iteration, keys, items, and the other mixin
+  // methods.
+
+  static const char *py_lazy_source = R"py(
+try:
+    from collections.abc import Mapping, Sequence
+except ImportError:
+    from collections import Mapping, Sequence
+
+
+class OctaveCell(_OctaveCellBase, Sequence):
+    """Read-only view of an Octave cell array, converted on access."""
+    __slots__ = ()
+
+
+class OctaveStruct(_OctaveStructBase, Mapping):
+    """Read-only view of an Octave struct, converted on access."""
+    __slots__ = ()
+)py";
+
+  static PyTypeObject *py_lazy_cell_subtype = nullptr;
+  static PyTypeObject *py_lazy_struct_subtype = nullptr;
+
+  static void
+  py_lazy_types_ready ()
+  {
+    if (py_lazy_cell_subtype)
+      return;
+
+    py_lazy_cell_as_sequence.sq_length = py_lazy_cell_length;
+    py_lazy_cell_as_sequence.sq_item = py_lazy_cell_item;
+    py_lazy_cell_as_mapping.mp_length = py_lazy_cell_length;
+    py_lazy_cell_as_mapping.mp_subscript = py_lazy_cell_subscript;
+
+    py_lazy_cell_type.tp_name = "pythonic._OctaveCellBase";
+    py_lazy_cell_type.tp_basicsize = sizeof (py_lazy_cell);
+    py_lazy_cell_type.tp_dealloc = py_lazy_cell_dealloc;
+    py_lazy_cell_type.tp_repr = py_lazy_cell_repr;
+    py_lazy_cell_type.tp_as_sequence = &py_lazy_cell_as_sequence;
+    py_lazy_cell_type.tp_as_mapping = &py_lazy_cell_as_mapping;
+    py_lazy_cell_type.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE;
+    py_lazy_cell_type.tp_doc = "Base type of lazy views of Octave cell arrays";
+
+    py_lazy_struct_as_sequence.sq_contains = py_lazy_struct_contains;
+    py_lazy_struct_as_mapping.mp_length = py_lazy_struct_length;
+    py_lazy_struct_as_mapping.mp_subscript = py_lazy_struct_subscript;
+
+    py_lazy_struct_type.tp_name = "pythonic._OctaveStructBase";
+    py_lazy_struct_type.tp_basicsize = sizeof (py_lazy_struct);
+    py_lazy_struct_type.tp_dealloc = py_lazy_struct_dealloc;
+    py_lazy_struct_type.tp_repr = py_lazy_struct_repr;
+    py_lazy_struct_type.tp_iter = py_lazy_struct_iter;
+    py_lazy_struct_type.tp_as_sequence = &py_lazy_struct_as_sequence;
+    py_lazy_struct_type.tp_as_mapping = &py_lazy_struct_as_mapping;
+    py_lazy_struct_type.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE;
+    py_lazy_struct_type.tp_doc = "Base type of lazy views of Octave structs";
+
+    Py_INCREF (&py_lazy_cell_type);
+    Py_INCREF (&py_lazy_struct_type);
+    if (PyType_Ready (&py_lazy_cell_type) < 0
+        || PyType_Ready (&py_lazy_struct_type) < 0)
+      error_python_exception ();
+
+    python_object module = PyModule_New ("pythonic");
+    if (! module)
+      error_python_exception ();
+
+    PyObject *dict = PyModule_GetDict (module);
+    if (PyDict_SetItemString (dict, "_OctaveCellBase",
+                              reinterpret_cast<PyObject *> (&py_lazy_cell_type)) < 0
+        || PyDict_SetItemString (dict, "_OctaveStructBase",
+                                 reinterpret_cast<PyObject *> (&py_lazy_struct_type)) < 0)
+      error_python_exception ();
+
+    python_object res = py_exec_string (py_lazy_source, dict, dict);
+
+    PyObject *cell_type = PyDict_GetItemString (dict, "OctaveCell");
+    PyObject *struct_type = PyDict_GetItemString (dict, "OctaveStruct");
+    if (! (cell_type && PyType_Check (cell_type)
+           && struct_type && PyType_Check (struct_type)))
+      error ("pythonic: unable to create lazy view types");
+
+    Py_INCREF (cell_type);
+    Py_INCREF (struct_type);
+    py_lazy_cell_subtype = reinterpret_cast<PyTypeObject *> (cell_type);
+    py_lazy_struct_subtype = reinterpret_cast<PyTypeObject *> (struct_type);
+  }
+
+  PyObject *
+  make_py_lazy_sequence (const Cell& cell)
+  {
+    py_lazy_types_ready ();
+
+    PyTypeObject *type = py_lazy_cell_subtype;
+    PyObject *self = type->tp_alloc (type, 0);
+    if (! self)
+      error_python_exception ();
+
+    py_lazy_cell *obj = reinterpret_cast<py_lazy_cell *> (self);
+    obj->cell = new Cell (cell);
+    obj->items = new std::vector<PyObject *> (cell.numel (), nullptr);
+    obj->thread_id = static_cast<unsigned long> (PyThread_get_thread_ident ());
+
+    return self;
+  }
+
+  PyObject *
+  make_py_lazy_mapping (const octave_scalar_map& map)
+  {
+    py_lazy_types_ready ();
+
+    string_vector names = map.fieldnames ();
+    python_object keys = PyTuple_New (names.numel ());
+    python_object cache = PyDict_New ();
+    if (! (keys && cache))
+      error_python_exception ();
+
+    for (octave_idx_type i = 0; i < names.numel (); i++)
+      PyTuple_SET_ITEM (static_cast<PyObject *> (keys), i,
+                        make_py_str (names(i)));
+
+    PyTypeObject *type = py_lazy_struct_subtype;
+    PyObject *self = type->tp_alloc (type, 0);
+    if (! self)
+      error_python_exception ();
+
+    py_lazy_struct *obj = reinterpret_cast<py_lazy_struct *> (self);
+    obj->map = new octave_scalar_map (map);
+    obj->keys = keys.release ();
+    obj->cache = cache.release ();
+    obj->thread_id = static_cast<unsigned long> (PyThread_get_thread_ident ());
+
+    return self;
+  }
+
+  bool
+  py_is_lazy_view (PyObject *obj)
+  {
+    return (py_lazy_cell_subtype
+            && (PyObject_TypeCheck (obj, &py_lazy_cell_type)
+                || PyObject_TypeCheck (obj, &py_lazy_struct_type)));
+  }
+
+  octave_value
+  extract_py_lazy_view (PyObject *obj)
+  {
+    if (py_lazy_cell_subtype && PyObject_TypeCheck (obj, &py_lazy_cell_type))
+      return *reinterpret_cast<py_lazy_cell *> (obj)->cell;
+    else if (py_lazy_cell_subtype
+             && PyObject_TypeCheck (obj, &py_lazy_struct_type))
+      return *reinterpret_cast<py_lazy_struct *> (obj)->map;
+
+    error_conversion_mismatch_python_type ("an Octave value",
+                                           "lazy view of an Octave value");
+  }
+
+}
@@ -0,0 +1,90 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+#if ! defined (pythonic_oct_py_lazy_h)
+#define pythonic_oct_py_lazy_h 1
+
+#include <Python.h>
+
+class Cell;
+class octave_scalar_map;
+class octave_value;
+
+namespace pythonic
+{
+
+  //! Check whether cell arrays and structs are passed to Python as lazy
+  //! views instead of being converted eagerly.
+  //!
+  //! @return @c true if lazy conversion is enabled
+  bool
+  py_lazy_conversion ();
+
+  //! Enable or disable lazy conversion of cell arrays and structs.
+  //!
+  //! @param enable @c true to pass lazy views, @c false to convert eagerly
+  void
+  py_set_lazy_conversion (bool enable);
+
+  //! Return a read-only Python sequence that views an Octave cell array.
+  //!
+  //! Elements are converted to Python objects when they are first accessed,
+  //! and the converted objects are cached.  The sequence is an instance of
+  //! @c collections.abc.Sequence.
+  //!
+  //! @param cell Octave cell array
+  //! @return a reference to a new Python object
+  PyObject *
+  make_py_lazy_sequence (const Cell& cell);
+
+  //! Return a read-only Python mapping that views an Octave scalar struct.
+  //!
+  //! Field values are converted to Python objects when they are first
+  //! accessed, and the converted objects are cached.  The mapping is an
+  //! instance of @c collections.abc.Mapping.
+  //!
+  //! @param map Octave scalar struct
+  //! @return a reference to a new Python object
+  PyObject *
+  make_py_lazy_mapping (const octave_scalar_map& map);
+
+  //! Check whether an object is a lazy view of an Octave value.
+  //!
+  //! @param obj Python object
+  //! @return @c true if @a obj was created by make_py_lazy_sequence or
+  //!         make_py_lazy_mapping
+  bool
+  py_is_lazy_view (PyObject *obj);
+
+  //! Return the Octave value viewed by a lazy view.
+  //!
+  //! @param obj Python object created by make_py_lazy_sequence or
+  //!        make_py_lazy_mapping
+  //! @return the original Octave cell array or struct
+  octave_value
+  extract_py_lazy_view (PyObject *obj);
+
+}
+
+#endif
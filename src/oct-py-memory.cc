@@ -0,0 +1,349 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+#if defined (HAVE_CONFIG_H)
+#  include <config.h>
+#endif
+
+#include <Python.h>
+#include <string>
+#include <octave/oct.h>
+#include <octave/oct-map.h>
+#include <octave/parse.h>
+#include <octave/version.h>
+#if OCTAVE_MAJOR_VERSION >= 6
+#  include <octave/interpreter.h>
+#  include <octave/pt-eval.h>
+#  include <octave/stack-frame.h>
+#endif
+
+#include "oct-py-error.h"
+#include "oct-py-eval.h"
+#include "oct-py-memory.h"
+#include "oct-py-object.h"
+#include "oct-py-types.h"
+#include "oct-py-util.h"
+
+namespace pythonic
+{
+
+  py_instrument py_memory;
+
+  // Python code for the memory accounting.  Each entry from Octave pushes
+  // the caller and the traced memory at that point, each exit adds the
+  // growth to the caller, less the growth already added to nested callers.
+  // Tracing that was already started by the user is used as it is, and is
+  // neither restarted, cleared, nor stopped.
+
+  static const char *py_memory_source = R"py(
+import tracemalloc
+
+_callers = {}
+_stack = []
+_active = False
+_started = False
+
+
+def start(nframe):
+    global _active, _started
+    if not tracemalloc.is_tracing():
+        tracemalloc.start(nframe)
+        _started = True
+    elif _started and tracemalloc.get_traceback_limit() != nframe:
+        tracemalloc.stop()
+        tracemalloc.start(nframe)
+    _active = True
+
+
+def stop():
+    global _active, _started
+    if _started:
+        tracemalloc.stop()
+    _active = _started = False
+    del _stack[:]
+
+
+def clear():
+    _callers.clear()
+    if _started and tracemalloc.is_tracing():
+        tracemalloc.clear_traces()
+
+
+def enter(caller):
+    _stack.append([caller, tracemalloc.get_traced_memory()[0], 0])
+
+
+def leave():
+    if not _stack:
+        return
+    caller, size, nested = _stack.pop()
+    growth = tracemalloc.get_traced_memory()[0] - size
+    if _stack:
+        _stack[-1][2] += growth
+    counts = _callers.setdefault(caller, [0, 0])
+    counts[0] += 1
+    counts[1] += growth - nested
+
+
+def snapshot(limit):
+    current, peak = tracemalloc.get_traced_memory()
+    callers = sorted(((name, calls, size)
+                      for name, (calls, size) in _callers.items()),
+                     key=lambda c: (-c[2], c[0]))
+    sites = []
+    if tracemalloc.is_tracing():
+        snap = tracemalloc.take_snapshot().filter_traces((
+            tracemalloc.Filter(False, tracemalloc.__file__),
+            tracemalloc.Filter(False, "<frozen importlib._bootstrap>"),
+        ))
+        for stat in snap.statistics("lineno")[:limit]:
+            frame = stat.traceback[0]
+            sites.append((frame.filename, frame.lineno, stat.count, stat.size))
+    return (_active, current, peak, callers, sites)
+)py";
+
+  static PyObject *memory_module = nullptr;
+
+  static PyObject *
+  py_memory_module ()
+  {
+    if (! memory_module)
+      {
+        python_object module = PyModule_New ("_pythonic_memory");
+        if (! module)
+          error_python_exception ();
+
+        PyObject *dict = PyModule_GetDict (module);
+        python_object res = py_exec_string (py_memory_source, dict, dict);
+
+        memory_module = module.release ();
+      }
+
+    return memory_module;
+  }
+
+  void
+  py_memory_start (int nframe)
+  {
+    if (nframe < 1)
+      error ("pythonic: number of traced frames must be a positive integer");
+
+    python_object res = PyObject_CallMethod (py_memory_module (), "start",
+                                             "i", nframe);
+    if (! res)
+      error_python_exception ();
+
+    py_memory.enable ();
+  }
+
+  void
+  py_memory_stop ()
+  {
+    py_memory.enable (false);
+
+    if (! memory_module)
+      return;
+
+    python_object res = PyObject_CallMethod (memory_module, "stop", nullptr);
+    if (! res)
+      error_python_exception ();
+  }
+
+  void
+  py_memory_clear ()
+  {
+    if (! memory_module)
+      return;
+
+    python_object res = PyObject_CallMethod (memory_module, "clear", nullptr);
+    if (! res)
+      error_python_exception ();
+  }
+
+  octave_scalar_map
+  py_memory_snapshot (int limit)
+  {
+    python_object res = PyObject_CallMethod (py_memory_module (), "snapshot",
+                                             "i", limit);
+    if (! res)
+      error_python_exception ();
+
+    int tracing = 0;
+    Py_ssize_t current = 0, peak = 0;
+    PyObject *callers = nullptr, *sites = nullptr;
+    if (! PyArg_ParseTuple (res, "pnnO!O!", &tracing, &current, &peak,
+                            &PyList_Type, &callers, &PyList_Type, &sites))
+      error_python_exception ();
+
+    Py_ssize_t ncallers = PyList_GET_SIZE (callers);
+    dim_vector caller_dims (ncallers, 1);
+    Cell caller_name (caller_dims), caller_calls (caller_dims);
+    Cell caller_bytes (caller_dims);
+
+    for (Py_ssize_t i = 0; i < ncallers; i++)
+      {
+        PyObject *name = nullptr;
+        Py_ssize_t calls = 0, bytes = 0;
+        if (! PyArg_ParseTuple (PyList_GET_ITEM (callers, i), "Unn",
+                                &name, &calls, &bytes))
+          error_python_exception ();
+        caller_name(i) = extract_py_str (name);
+        caller_calls(i) = static_cast<double> (calls);
+        caller_bytes(i) = static_cast<double> (bytes);
+      }
+
+    octave_map caller_map (caller_dims);
+    caller_map.setfield ("name", caller_name);
+    caller_map.setfield ("calls", caller_calls);
+    caller_map.setfield ("bytes", caller_bytes);
+
+    Py_ssize_t nsites = PyList_GET_SIZE (sites);
+    dim_vector site_dims (nsites, 1);
+    Cell site_file (site_dims), site_line (site_dims);
+    Cell site_count (site_dims), site_bytes (site_dims);
+
+    for (Py_ssize_t i = 0; i < nsites; i++)
+      {
+        PyObject *file = nullptr;
+        int line = 0;
+        Py_ssize_t count = 0, bytes = 0;
+        if (! PyArg_ParseTuple (PyList_GET_ITEM (sites, i), "Uinn",
+                                &file, &line, &count, &bytes))
+          error_python_exception ();
+        site_file(i) = extract_py_str (file);
+        site_line(i) = line;
+        site_count(i) = static_cast<double> (count);
+        site_bytes(i) = static_cast<double> (bytes);
+      }
+
+    octave_map site_map (site_dims);
+    site_map.setfield ("file", site_file);
+    site_map.setfield ("line", site_line);
+    site_map.setfield ("count", site_count);
+    site_map.setfield ("bytes", site_bytes);
+
+    octave_scalar_map map;
+    map.assign ("enabled", static_cast<bool> (tracing));
+    map.assign ("current", static_cast<double> (current));
+    map.assign ("peak", static_cast<double> (peak));
+    map.assign ("objstore", py_objstore_stats ().getfield ("bytes"));
+    map.assign ("callers", caller_map);
+    map.assign ("sites", site_map);
+    return map;
+  }
+
+  // Return the directory holding the functions of this package, so that
+  // calls made by pyobject methods are attributed to their caller.
+
+  static std::string
+  package_directory ()
+  {
+    static std::string dir;
+
+    if (dir.empty ())
+      {
+        octave_value_list out = octave::feval ("which", ovl ("pythonic"), 1);
+        if (out.length () > 0 && out(0).is_string ())
+          {
+            std::string file = out(0).string_value ();
+            std::size_t pos = file.find_last_of ("/\\");
+            if (pos != std::string::npos)
+              dir = file.substr (0, pos + 1);
+          }
+      }
+
+    return dir;
+  }
+
+  // Return the innermost line of Octave code outside of this package, for
+  // example "myfunction:12", or "(command line)" at the top level.  This is
+  // looked up for every call while tracing, so the call stack is read
+  // directly where the Octave API allows it instead of calling dbstack.
+
+  static std::string
+  octave_caller ()
+  {
+    std::string dir = package_directory ();
+
+#if OCTAVE_MAJOR_VERSION >= 6
+    octave::tree_evaluator& tw
+      = octave::interpreter::the_interpreter ()->get_evaluator ();
+
+    for (const auto& frame : tw.backtrace_frames ())
+      {
+        if (frame->is_scope_frame ())
+          continue;
+        std::string file = frame->fcn_file_name ();
+        if (! dir.empty () && file.compare (0, dir.length (), dir) == 0)
+          continue;
+        return frame->fcn_name () + ':' + std::to_string (frame->line ());
+      }
+#else
+    octave_value_list out = octave::feval ("dbstack", octave_value_list (), 1);
+    if (out.length () < 1 || ! out(0).isstruct ())
+      return "(command line)";
+
+    octave_map frames = out(0).map_value ();
+    Cell files = frames.contents ("file");
+    Cell names = frames.contents ("name");
+    Cell lines = frames.contents ("line");
+
+    for (octave_idx_type i = 0; i < frames.numel (); i++)
+      {
+        std::string file = files(i).string_value ();
+        if (! dir.empty () && file.compare (0, dir.length (), dir) == 0)
+          continue;
+        return names(i).string_value () + ':'
+               + std::to_string (lines(i).int_value ());
+      }
+#endif
+
+    return "(command line)";
+  }
+
+  void
+  py_memory_scope::enter ()
+  {
+    std::string caller = octave_caller ();
+
+    python_object str = make_py_str (caller);
+    python_object res = PyObject_CallMethod (py_memory_module (), "enter", "O",
+                                             static_cast<PyObject *> (str));
+    if (! res)
+      {
+        PyErr_Clear ();
+        m_active = false;
+      }
+  }
+
+  void
+  py_memory_scope::leave ()
+  {
+    py_error_preserve preserve;
+
+    python_object res = PyObject_CallMethod (memory_module, "leave", nullptr);
+    if (! res)
+      PyErr_Clear ();
+  }
+
+}
@@ -0,0 +1,100 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+#if ! defined (pythonic_oct_py_memory_h)
+#define pythonic_oct_py_memory_h 1
+
+#include <Python.h>
+
+#include "oct-py-instrument.h"
+
+class octave_scalar_map;
+
+namespace pythonic
+{
+
+  //! On while Python allocations are being traced.
+  extern py_instrument py_memory;
+
+  //! Start tracing Python memory allocations with tracemalloc.
+  //!
+  //! @param nframe number of Python frames stored for each allocation
+  void
+  py_memory_start (int nframe);
+
+  //! Stop tracing Python memory allocations.
+  //!
+  //! Stopping tracemalloc discards the traced allocations, the growth
+  //! recorded for each Octave caller is kept.
+  void
+  py_memory_stop ();
+
+  //! Discard the traced allocations and the growth of each Octave caller.
+  void
+  py_memory_clear ();
+
+  //! Return a snapshot of the Python memory in use.
+  //!
+  //! The snapshot holds the current and peak size of the traced memory,
+  //! the size of the objects in the object store, the net growth of the
+  //! traced memory over the calls made from each line of Octave code, and
+  //! the Python source lines with the most memory allocated.
+  //!
+  //! @param limit maximum number of Python source lines returned
+  //! @return snapshot as an Octave struct
+  octave_scalar_map
+  py_memory_snapshot (int limit);
+
+  //! Scope of a call from Octave into Python.
+  //!
+  //! While allocations are being traced, measure the growth of the traced
+  //! memory over the scope, and add it to the innermost line of Octave
+  //! code outside of this package.  Growth over nested scopes, in Octave
+  //! callbacks called from Python, is only added to the nested caller.
+  class py_memory_scope : public py_instrument_scope
+  {
+  public:
+
+    py_memory_scope ()
+      : py_instrument_scope (py_memory)
+    {
+      if (m_active)
+        enter ();
+    }
+
+    ~py_memory_scope ()
+    {
+      if (m_active)
+        leave ();
+    }
+
+  private:
+
+    void enter ();
+
+    void leave ();
+  };
+
+}
+
+#endif
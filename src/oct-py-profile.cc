@@ -0,0 +1,278 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+#if defined (HAVE_CONFIG_H)
+#  include <config.h>
+#endif
+
+#include <Python.h>
+#include <string>
+#include <octave/oct.h>
+#include <octave/oct-map.h>
+#include <octave/parse.h>
+
+#include "oct-py-error.h"
+#include "oct-py-eval.h"
+#include "oct-py-object.h"
+#include "oct-py-profile.h"
+#include "oct-py-types.h"
+
+namespace pythonic
+{
+
+  py_instrument py_profile;
+
+  // Python code for the sampler.  The context is the Octave call stack at
+  // the innermost call into Python and the depth of the Python stack at
+  // that point, so that frames belonging to an outer call are not repeated
+  // when Python calls back into Octave which calls into Python again.
+
+  static const char *py_profile_source = R"py(
+import collections
+import os
+import sys
+import threading
+
+_context = None
+_samples = collections.Counter()
+_thread = None
+_stop = None
+
+
+def _frame_name(frame):
+    code = frame.f_code
+    name = getattr(code, "co_qualname", code.co_name)
+    filename = os.path.basename(code.co_filename)
+    return "%s (%s:%d)" % (name, filename, frame.f_lineno)
+
+
+def _sample(target, interval, stop):
+    while not stop.wait(interval):
+        context = _context
+        if context is None:
+            continue
+        stack, depth = context
+        names = []
+        frame = sys._current_frames().get(target)
+        while frame is not None:
+            names.append(_frame_name(frame).replace(";", ":"))
+            frame = frame.f_back
+        names.reverse()
+        _samples[";".join([stack] + names[depth:])] += 1
+
+
+def enter(stack):
+    global _context
+    previous = _context
+    depth = 0
+    try:
+        frame = sys._getframe(1)
+    except ValueError:
+        frame = None
+    while frame is not None:
+        depth += 1
+        frame = frame.f_back
+    _context = (stack, depth)
+    return previous
+
+
+def leave(previous):
+    global _context
+    _context = previous
+
+
+def start(interval):
+    global _thread, _stop
+    stop()
+    _stop = threading.Event()
+    _thread = threading.Thread(target=_sample, name="pythonic-profile",
+                               args=(threading.get_ident(), interval, _stop))
+    _thread.daemon = True
+    _thread.start()
+
+
+def stop():
+    global _thread, _stop
+    if _thread is not None:
+        _stop.set()
+        _thread.join()
+    _thread = None
+    _stop = None
+
+
+def clear():
+    _samples.clear()
+
+
+def collapsed():
+    return "".join("%s %d\n" % item for item in sorted(_samples.items()))
+
+
+def forget():
+    global _context, _thread, _stop
+    _context = None
+    _thread = None
+    _stop = None
+)py";
+
+  static PyObject *profile_module = nullptr;
+
+  static PyObject *
+  py_profile_module ()
+  {
+    if (! profile_module)
+      {
+        python_object module = PyModule_New ("_pythonic_profile");
+        if (! module)
+          error_python_exception ();
+
+        PyObject *dict = PyModule_GetDict (module);
+        python_object res = py_exec_string (py_profile_source, dict, dict);
+
+        profile_module = module.release ();
+      }
+
+    return profile_module;
+  }
+
+  void
+  py_profile_start (double interval)
+  {
+    if (! (interval > 0))
+      error ("pythonic: profile sampling interval must be positive");
+
+    python_object res = PyObject_CallMethod (py_profile_module (), "start",
+                                             "d", interval);
+    if (! res)
+      error_python_exception ();
+
+    py_profile.enable ();
+  }
+
+  void
+  py_profile_stop ()
+  {
+    py_profile.enable (false);
+
+    if (! profile_module)
+      return;
+
+    python_object res = PyObject_CallMethod (profile_module, "stop", nullptr);
+    if (! res)
+      error_python_exception ();
+  }
+
+  void
+  py_profile_clear ()
+  {
+    if (! profile_module)
+      return;
+
+    python_object res = PyObject_CallMethod (profile_module, "clear", nullptr);
+    if (! res)
+      error_python_exception ();
+  }
+
+  std::string
+  py_profile_collapsed ()
+  {
+    if (! profile_module)
+      return "";
+
+    python_object res = PyObject_CallMethod (profile_module, "collapsed",
+                                             nullptr);
+    if (! res)
+      error_python_exception ();
+
+    return extract_py_str (res);
+  }
+
+  void
+  py_profile_reset_after_fork ()
+  {
+    py_profile.enable (false);
+
+    if (! profile_module)
+      return;
+
+    python_object res = PyObject_CallMethod (profile_module, "forget", nullptr);
+    if (! res)
+      PyErr_Clear ();
+  }
+
+  // Return the Octave call stack from the outermost frame, for example
+  // "octave;myscript:3;myfunction:12".
+
+  static std::string
+  octave_call_stack ()
+  {
+    std::string stack = "octave";
+
+    octave_value_list out = octave::feval ("dbstack", octave_value_list (), 1);
+    if (out.length () < 1 || ! out(0).isstruct ())
+      return stack;
+
+    octave_map frames = out(0).map_value ();
+    Cell names = frames.contents ("name");
+    Cell lines = frames.contents ("line");
+
+    for (octave_idx_type i = frames.numel () - 1; i >= 0; i--)
+      stack += ';' + names(i).string_value () + ':'
+               + std::to_string (lines(i).int_value ());
+
+    return stack;
+  }
+
+  void
+  py_profile_scope::enter (const char *entry)
+  {
+    std::string stack = octave_call_stack () + ';' + entry;
+
+    python_object str = make_py_str (stack);
+    m_previous = PyObject_CallMethod (py_profile_module (), "enter", "O",
+                                      static_cast<PyObject *> (str));
+    if (! m_previous)
+      {
+        PyErr_Clear ();
+        m_active = false;
+      }
+  }
+
+  void
+  py_profile_scope::leave ()
+  {
+    py_error_preserve preserve;
+
+    python_object previous = m_previous;
+    m_previous = nullptr;
+    if (profile_module)
+      {
+        python_object res = PyObject_CallMethod (profile_module, "leave", "O",
+                                                 static_cast<PyObject *> (previous));
+        if (! res)
+          PyErr_Clear ();
+      }
+  }
+
+}
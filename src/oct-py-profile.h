@@ -0,0 +1,103 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+#if ! defined (pythonic_oct_py_profile_h)
+#define pythonic_oct_py_profile_h 1
+
+#include <Python.h>
+#include <string>
+
+#include "oct-py-instrument.h"
+
+namespace pythonic
+{
+
+  //! On while the sampling profiler is running.
+  extern py_instrument py_profile;
+
+  //! Start sampling the Python stack of the main thread.
+  //!
+  //! Samples are taken by a background Python thread, which only runs
+  //! while the main thread is running Python code or has released the GIL.
+  //!
+  //! @param interval time between samples in seconds
+  void
+  py_profile_start (double interval);
+
+  //! Stop sampling, keeping the samples taken so far.
+  void
+  py_profile_stop ();
+
+  //! Discard all samples.
+  void
+  py_profile_clear ();
+
+  //! Return the samples in collapsed stack format.
+  //!
+  //! Each line holds the Octave call stack at entry to Python followed by
+  //! the Python stack, separated by semicolons, and the number of samples.
+  //! The output can be passed to flamegraph.pl or speedscope.
+  //!
+  //! @return collapsed stacks, one per line
+  std::string
+  py_profile_collapsed ();
+
+  //! Stop the sampler thread in a forked child.
+  void
+  py_profile_reset_after_fork ();
+
+  //! Scope of a call from Octave into Python.
+  //!
+  //! While the profiler is running, record the Octave call stack so that
+  //! samples taken during the call are attributed to the Octave code that
+  //! made it.  The previous stack is restored when the scope ends.
+  class py_profile_scope : public py_instrument_scope
+  {
+  public:
+
+    py_profile_scope (const char *entry)
+      : py_instrument_scope (py_profile)
+    {
+      if (m_active)
+        enter (entry);
+    }
+
+    ~py_profile_scope ()
+    {
+      if (m_active)
+        leave ();
+    }
+
+  private:
+
+    void enter (const char *entry);
+
+    void leave ();
+
+    PyObject *m_previous = nullptr;
+  };
+
+}
+
+#endif
@@ -0,0 +1,715 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+#if defined (HAVE_CONFIG_H)
+#  include <config.h>
+#endif
+
+#include <Python.h>
+#include <string>
+#include <octave/error.h>
+
+#include "oct-py-error.h"
+#include "oct-py-eval.h"
+#include "oct-py-object.h"
+#include "oct-py-remote.h"
+#include "oct-py-types.h"
+
+namespace pythonic
+{
+
+  // Python support code shared by the client and the worker processes.
+  // Messages are pickled and framed with their length over a Unix domain
+  // socket.  Array payloads of at least _SHM_MIN_NBYTES bytes are placed in
+  // POSIX shared memory files and mapped by the receiving side instead of
+  // being written to the socket.  This is not a zero-copy transfer: the
+  // sender copies each payload into its file, and an array.array is copied
+  // once more out of the mapping by the receiver.  Only out-of-band buffers
+  // of pickle protocol 5, for example of NumPy arrays, are used in place.
+
+  static const char *py_remote_common_source = R"py(
+import array
+import builtins
+import io
+import mmap
+import os
+import pickle
+import struct
+import tempfile
+import traceback
+
+_HEADER = struct.Struct("!Q")
+_PROTOCOL = pickle.HIGHEST_PROTOCOL
+_SHM_DIR = "/dev/shm" if os.path.isdir("/dev/shm") else tempfile.gettempdir()
+_SHM_MIN_NBYTES = 1 << 16
+
+
+def _send(sock, data):
+    sock.sendall(_HEADER.pack(len(data)))
+    sock.sendall(data)
+
+
+def _recv(sock):
+    (n,) = _HEADER.unpack(_recv_exact(sock, _HEADER.size))
+    return _recv_exact(sock, n)
+
+
+def _recv_exact(sock, n):
+    buf = bytearray(n)
+    view = memoryview(buf)
+    while view.nbytes:
+        k = sock.recv_into(view)
+        if not k:
+            raise EOFError("connection closed")
+        view = view[k:]
+    return buf
+
+
+class _Segments(object):
+    """Shared memory segments that carry the array payloads of a message."""
+
+    def __init__(self):
+        self.specs = []
+
+    def put(self, data):
+        data = memoryview(data).cast("B")
+        path = os.path.join(_SHM_DIR, "pythonic-%d-%s" % (os.getpid(), os.urandom(8).hex()))
+        fd = os.open(path, os.O_CREAT | os.O_EXCL | os.O_RDWR, 0o600)
+        try:
+            os.ftruncate(fd, max(data.nbytes, 1))
+            with mmap.mmap(fd, max(data.nbytes, 1)) as m:
+                m[:data.nbytes] = data
+        finally:
+            os.close(fd)
+        self.specs.append((path, data.nbytes))
+        return len(self.specs) - 1
+
+    def unlink(self):
+        _unlink(self.specs)
+        self.specs = []
+
+
+def _unlink(specs):
+    for path, _ in specs:
+        try:
+            os.unlink(path)
+        except OSError:
+            pass
+
+
+def _attach(specs):
+    views = []
+    for path, nbytes in specs:
+        fd = os.open(path, os.O_RDWR)
+        try:
+            m = mmap.mmap(fd, max(nbytes, 1))
+        finally:
+            os.close(fd)
+        views.append(memoryview(m)[:nbytes])
+    return views
+
+
+class _Pickler(pickle.Pickler):
+    """Pickler that moves large buffers into shared memory segments."""
+
+    def __init__(self, stream, segments):
+        kwargs = {}
+        if _PROTOCOL >= 5:
+            kwargs["buffer_callback"] = self._out_of_band
+        pickle.Pickler.__init__(self, stream, _PROTOCOL, **kwargs)
+        self.segments = segments
+        self.buffers = []
+
+    def _out_of_band(self, buf):
+        raw = buf.raw()
+        if raw.nbytes < _SHM_MIN_NBYTES:
+            return True
+        self.buffers.append(self.segments.put(raw))
+        return False
+
+    def persistent_id(self, obj):
+        if type(obj) is array.array and obj.itemsize * len(obj) >= _SHM_MIN_NBYTES:
+            return ("array", obj.typecode, self.segments.put(obj))
+        return None
+
+
+class _Unpickler(pickle.Unpickler):
+    """Unpickler that maps array payloads from shared memory segments."""
+
+    def __init__(self, data, views, oob):
+        kwargs = {}
+        if _PROTOCOL >= 5:
+            kwargs["buffers"] = [views[i] for i in oob]
+        pickle.Unpickler.__init__(self, io.BytesIO(data), **kwargs)
+        self.views = views
+
+    def persistent_load(self, pid):
+        if pid[0] == "array":
+            # An array.array owns its memory, its payload has to be copied
+            a = array.array(pid[1])
+            a.frombytes(self.views[pid[2]])
+            return a
+        raise pickle.UnpicklingError("unsupported persistent object")
+
+
+def _send_message(sock, header, obj, pickler_type, *args):
+    """Send one message, return the shared memory segments it refers to."""
+    segments = _Segments()
+    stream = io.BytesIO()
+    try:
+        p = pickler_type(stream, segments, *args)
+        p.dump(obj)
+        _send(sock, pickle.dumps(header + (segments.specs, p.buffers), _PROTOCOL))
+        _send(sock, stream.getbuffer())
+    except BaseException:
+        segments.unlink()
+        raise
+    return segments
+
+
+def _recv_message(sock):
+    """Receive one message, return its header and unpickling arguments."""
+    header = pickle.loads(_recv(sock))
+    payload = _recv(sock)
+    specs, oob = header[-2:]
+    return header[:-2], payload, specs, oob
+
+
+def _format_exception(e):
+    return traceback.format_exception_only(type(e), e)[-1].strip()
+)py";
+
+  // Client side, executed in a private module of the embedded interpreter.
+  // Objects that a worker does not pass back by value are represented by
+  // _RemoteRef proxies, which are stored in the object store like any other
+  // Python object.
+
+  static const char *py_remote_client_source = R"py(
+import hmac
+import itertools
+import shutil
+import socket
+import subprocess
+import sys
+
+
+class _RemoteRef(object):
+    """Local proxy for a Python object held by a worker process."""
+
+    __slots__ = ("_worker", "_key", "__weakref__")
+
+    def __init__(self, worker, key):
+        self._worker = worker
+        self._key = key
+
+    def __call__(self, *args, **kwargs):
+        return self._worker.client.call(self, args, kwargs)
+
+    def __str__(self):
+        return self._worker.request(("str", self))
+
+    def __repr__(self):
+        return self._worker.request(("repr", self))
+
+    def __len__(self):
+        return self._worker.request(("len", self))
+
+    def __del__(self):
+        try:
+            self._worker.drops.append(self._key)
+        except Exception:
+            pass
+
+
+class _RemoteFunction(object):
+    """Local proxy for a function looked up by name in a worker process."""
+
+    __slots__ = ("_client", "_name")
+
+    def __init__(self, client, name):
+        self._client = client
+        self._name = name
+
+    def __call__(self, *args, **kwargs):
+        return self._client.call(self._name, args, kwargs)
+
+    def __repr__(self):
+        return "<remote function %s>" % self._name
+
+
+class _ClientPickler(_Pickler):
+    def __init__(self, stream, segments, worker):
+        _Pickler.__init__(self, stream, segments)
+        self.worker = worker
+
+    def persistent_id(self, obj):
+        if type(obj) is _RemoteRef:
+            if obj._worker is not self.worker:
+                raise ValueError("Python objects held by different remote workers cannot be combined")
+            return ("ref", obj._key)
+        if type(obj) is _RemoteFunction:
+            return ("function", obj._name)
+        return _Pickler.persistent_id(self, obj)
+
+
+class _ClientUnpickler(_Unpickler):
+    def __init__(self, data, views, oob, worker):
+        _Unpickler.__init__(self, data, views, oob)
+        self.worker = worker
+
+    def persistent_load(self, pid):
+        if pid[0] == "ref":
+            return _RemoteRef(self.worker, pid[1])
+        return _Unpickler.persistent_load(self, pid)
+
+
+class _Worker(object):
+    def __init__(self, client, index, executable, directory):
+        self.client = client
+        self.index = index
+        self.drops = []
+        self.sock = None
+        address = os.path.join(directory, "worker-%d" % index)
+        token = os.urandom(16)
+        listener = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        try:
+            listener.bind(address)
+            listener.listen(1)
+            listener.settimeout(60)
+            self.process = subprocess.Popen([executable, "-c", _WORKER_SOURCE, address],
+                                            stdin=subprocess.PIPE, close_fds=True)
+            self.process.stdin.write(token.hex().encode("ascii") + b"\n")
+            self.process.stdin.close()
+            try:
+                self.sock, _ = listener.accept()
+                self.sock.settimeout(None)
+                ok = hmac.compare_digest(bytes(_recv(self.sock)), token)
+            except (OSError, EOFError):
+                ok = False
+        finally:
+            listener.close()
+            try:
+                os.unlink(address)
+            except OSError:
+                pass
+        if not ok:
+            self.close()
+            raise RuntimeError("remote Python worker %d failed to start" % index)
+
+    def request(self, request):
+        if self.sock is None:
+            raise ReferenceError("remote Python worker %d is no longer running" % self.index)
+        drops, self.drops = self.drops, []
+        segments = None
+        try:
+            segments = _send_message(self.sock, (drops,), request, _ClientPickler, self)
+            header, payload, specs, oob = _recv_message(self.sock)
+        except (OSError, EOFError):
+            self.client.restart(self)
+            raise RuntimeError("remote Python worker %d exited unexpectedly" % self.index)
+        finally:
+            if segments:
+                segments.unlink()
+        try:
+            views = _attach(specs)
+        finally:
+            _unlink(specs)
+        if header[0] == "error":
+            raise _remote_exception(*header[1:])
+        return _ClientUnpickler(payload, views, oob, self).load()
+
+    def close(self):
+        if self.sock is not None:
+            self.sock.close()
+            self.sock = None
+        if self.process is not None and self.process.poll() is None:
+            try:
+                self.process.wait(5)
+            except subprocess.TimeoutExpired:
+                self.process.kill()
+                self.process.wait()
+
+
+def _remote_exception(name, message):
+    exc = getattr(builtins, name, None)
+    if isinstance(exc, type) and issubclass(exc, Exception):
+        try:
+            return exc(message.partition(": ")[2])
+        except Exception:
+            pass
+    return RuntimeError(message)
+
+
+def _python_executable():
+    exe = sys.executable
+    if exe and os.path.basename(exe).startswith("python"):
+        return exe
+    version = "python%d.%d" % sys.version_info[:2]
+    for exe in (os.path.join(sys.exec_prefix, "bin", version), shutil.which(version),
+                shutil.which("python%d" % sys.version_info[0])):
+        if exe and os.access(exe, os.X_OK):
+            return exe
+    raise RuntimeError("unable to find a Python executable to start remote workers")
+
+
+class _Client(object):
+    """Dispatcher for calls forwarded to a pool of worker processes."""
+
+    def __init__(self, nworkers):
+        self.executable = _python_executable()
+        self.directory = tempfile.mkdtemp(prefix="pythonic-")
+        self.workers = []
+        try:
+            for i in range(nworkers):
+                self.workers.append(_Worker(self, i, self.executable, self.directory))
+        except BaseException:
+            self.close()
+            raise
+        self.next = itertools.cycle(range(nworkers))
+
+    def restart(self, worker):
+        worker.close()
+        if self.workers[worker.index] is worker:
+            self.workers[worker.index] = _Worker(self, worker.index, self.executable, self.directory)
+
+    def select(self, *objs):
+        """Choose the worker holding the referenced objects, or the next one."""
+        worker = None
+        stack = list(objs)
+        while stack:
+            obj = stack.pop()
+            t = type(obj)
+            if t is _RemoteRef:
+                if worker is not None and obj._worker is not worker:
+                    raise ValueError("Python objects held by different remote workers cannot be combined")
+                worker = obj._worker
+            elif t in (tuple, list):
+                stack.extend(obj)
+            elif isinstance(obj, dict):
+                stack.extend(obj.values())
+        return worker or self.workers[next(self.next)]
+
+    def function(self, name):
+        return _RemoteFunction(self, name)
+
+    def call(self, func, args, kwargs):
+        return self.select(func, args, kwargs).request(("call", func, args, kwargs))
+
+    def eval(self, expr, locals=None):
+        return self.select(locals).request(("eval", expr, locals))
+
+    def exec(self, expr, locals=None):
+        if locals is not None:
+            return self.select(locals).request(("exec", expr, locals))
+        for worker in list(self.workers):
+            worker.request(("exec", expr, None))
+        return None
+
+    def close(self):
+        for worker in self.workers:
+            worker.close()
+        self.workers = []
+        shutil.rmtree(self.directory, ignore_errors=True)
+
+    def forget(self):
+        """Disconnect from the workers without stopping them, after a fork."""
+        for worker in self.workers:
+            if worker.sock is not None:
+                worker.sock.close()
+                worker.sock = None
+            worker.process = None
+        self.workers = []
+)py";
+
+  // Worker side, run with "python -c" and the socket address as argument.
+
+  static const char *py_remote_worker_source = R"py(
+import importlib
+import numbers
+import socket
+import sys
+
+
+class _RefId(object):
+    __slots__ = ("key",)
+
+    def __init__(self, key):
+        self.key = key
+
+
+class _WorkerPickler(_Pickler):
+    def persistent_id(self, obj):
+        if type(obj) is _RefId:
+            return ("ref", obj.key)
+        return _Pickler.persistent_id(self, obj)
+
+
+class _WorkerUnpickler(_Unpickler):
+    def __init__(self, data, views, oob, objects, namespace):
+        _Unpickler.__init__(self, data, views, oob)
+        self.objects = objects
+        self.namespace = namespace
+
+    def persistent_load(self, pid):
+        if pid[0] == "ref":
+            try:
+                return self.objects[pid[1]][1]
+            except KeyError:
+                raise ReferenceError("remote Python object no longer exists")
+        if pid[0] == "function":
+            return _find_function(pid[1], self.namespace)
+        return _Unpickler.persistent_load(self, pid)
+
+
+_VALUE_TYPES = (type(None), bool, int, float, complex, str, bytes, array.array)
+
+
+def _is_value(obj):
+    t = type(obj)
+    if t in _VALUE_TYPES:
+        return True
+    if t.__module__ == "numpy":
+        return t.__name__ == "ndarray" and not obj.dtype.hasobject or isinstance(obj, numbers.Number)
+    return False
+
+
+def _mark(obj, objects):
+    """Replace everything that is not passed by value with a reference."""
+    if type(obj) is tuple:
+        return tuple(_mark(x, objects) for x in obj)
+    if _is_value(obj):
+        return obj
+    key = id(obj)
+    entry = objects.get(key)
+    if entry:
+        entry[0] += 1
+    else:
+        objects[key] = [1, obj]
+    return _RefId(key)
+
+
+def _find_function(name, namespace):
+    module, _, func = name.rpartition(".")
+    if module:
+        obj = getattr(importlib.import_module(module), func, None)
+    else:
+        obj = namespace.get(name, getattr(builtins, name, None))
+    if obj is None or not callable(obj):
+        raise NameError("no such Python function or callable: %s" % name)
+    return obj
+
+
+def _serve(sock):
+    objects = {}
+    namespace = {"__name__": "__main__", "__builtins__": builtins}
+    while True:
+        try:
+            (drops,), payload, specs, oob = _recv_message(sock)
+        except EOFError:
+            return
+        for key in drops:
+            entry = objects.get(key)
+            if entry:
+                entry[0] -= 1
+                if entry[0] <= 0:
+                    del objects[key]
+        try:
+            request = _WorkerUnpickler(payload, _attach(specs), oob, objects, namespace).load()
+            del payload
+            op, args = request[0], request[1:]
+            if op == "call":
+                func, fargs, fkwargs = args
+                if isinstance(func, str):
+                    func = _find_function(func, namespace)
+                result = func(*fargs, **fkwargs)
+            elif op == "eval":
+                result = eval(args[0], namespace, args[1])
+            elif op == "exec":
+                exec(args[0], namespace, args[1])
+                result = None
+            elif op == "str":
+                result = str(args[0])
+            elif op == "repr":
+                result = repr(args[0])
+            elif op == "len":
+                result = len(args[0])
+            else:
+                raise ValueError("unknown request %r" % (op,))
+            reply = (("ok",), _mark(result, objects))
+            del request, args, result
+        except (Exception, SystemExit) as e:
+            reply = (("error", type(e).__name__, _format_exception(e)), None)
+        try:
+            _send_message(sock, reply[0], reply[1], _WorkerPickler)
+        except OSError:
+            return
+        except Exception as e:
+            _send_message(sock, ("error", type(e).__name__, _format_exception(e)), None, _WorkerPickler)
+
+
+def _worker_main(address):
+    token = bytes.fromhex(sys.stdin.readline().strip())
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    sock.connect(address)
+    _send(sock, token)
+    try:
+        _serve(sock)
+    finally:
+        sock.close()
+
+
+_worker_main(sys.argv[1])
+)py";
+
+  static PyObject *remote_client = nullptr;
+
+  static PyObject *
+  py_remote_client ()
+  {
+    if (! remote_client)
+      error ("pythonic: remote Python workers are not running");
+
+    return remote_client;
+  }
+
+  void
+  py_remote_start (int nworkers)
+  {
+    if (nworkers < 1)
+      error ("pythonic: number of remote Python workers must be positive");
+
+#if PY_VERSION_HEX < 0x03030000
+    error ("pythonic: remote Python workers require Python 3.3 or newer");
+#else
+    py_remote_stop ();
+
+    python_object module = PyModule_New ("_pythonic_remote");
+    if (! module)
+      error_python_exception ();
+
+    PyObject *dict = PyModule_GetDict (module);
+
+    std::string common = py_remote_common_source;
+    python_object worker_source = make_py_str (common + py_remote_worker_source);
+    if (! worker_source
+        || PyDict_SetItemString (dict, "_WORKER_SOURCE", worker_source) < 0)
+      error_python_exception ();
+
+    python_object res = py_exec_string (common + py_remote_client_source,
+                                        dict, dict);
+
+    python_object client_type = PyObject_GetAttrString (module, "_Client");
+    python_object n = make_py_int (static_cast<int32_t> (nworkers));
+    python_object args = PyTuple_Pack (1, static_cast<PyObject *> (n));
+    remote_client = py_call_function (client_type, args);
+#endif
+  }
+
+  void
+  py_remote_stop ()
+  {
+    if (! remote_client)
+      return;
+
+    python_object client = remote_client;
+    remote_client = nullptr;
+
+    python_object res = PyObject_CallMethod (client, "close", nullptr);
+    if (! res)
+      error_python_exception ();
+  }
+
+  void
+  py_remote_reset_after_fork ()
+  {
+    if (! remote_client)
+      return;
+
+    python_object client = remote_client;
+    remote_client = nullptr;
+
+    // The worker processes belong to the parent process, close this
+    // process's copies of the sockets but leave the workers running.
+    python_object res = PyObject_CallMethod (client, "forget", nullptr);
+    if (! res)
+      PyErr_Clear ();
+  }
+
+  bool
+  py_remote_enabled ()
+  {
+    return remote_client != nullptr;
+  }
+
+  int
+  py_remote_workers ()
+  {
+    if (! remote_client)
+      return 0;
+
+    python_object workers = PyObject_GetAttrString (remote_client, "workers");
+    if (! workers)
+      error_python_exception ();
+
+    return static_cast<int> (PySequence_Size (workers));
+  }
+
+  PyObject *
+  py_remote_find_function (const std::string& name)
+  {
+    python_object func = PyObject_CallMethod (py_remote_client (), "function",
+                                              "s", name.c_str ());
+    if (! func)
+      error_python_exception ();
+
+    return func.release ();
+  }
+
+  PyObject *
+  py_remote_eval_string (const std::string& expr, PyObject *locals)
+  {
+    python_object code = make_py_str (expr);
+    python_object retval = PyObject_CallMethod (py_remote_client (), "eval",
+                                                "OO", static_cast<PyObject *> (code),
+                                                locals ? locals : Py_None);
+    if (! retval)
+      error_python_exception ();
+
+    return retval.release ();
+  }
+
+  PyObject *
+  py_remote_exec_string (const std::string& expr, PyObject *locals)
+  {
+    python_object code = make_py_str (expr);
+    python_object retval = PyObject_CallMethod (py_remote_client (), "exec",
+                                                "OO", static_cast<PyObject *> (code),
+                                                locals ? locals : Py_None);
+    if (! retval)
+      error_python_exception ();
+
+    return retval.release ();
+  }
+
+}
@@ -0,0 +1,106 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+#if ! defined (pythonic_oct_py_remote_h)
+#define pythonic_oct_py_remote_h 1
+
+#include <Python.h>
+#include <string>
+
+namespace pythonic
+{
+
+  //! Start the given number of out-of-process Python worker processes.
+  //!
+  //! Once started, @c pycall, @c pyeval, and @c pyexec forward all
+  //! evaluation to the workers over a Unix domain socket.  Any previously
+  //! started workers are stopped first.
+  //!
+  //! Large arrays are passed through shared memory files instead of the
+  //! socket.  The sender copies the data into the file.  The receiver maps
+  //! it and uses it in place for NumPy arrays and other out-of-band pickle
+  //! buffers, but copies it once more into a new array.array.
+  //!
+  //! @param nworkers number of worker processes to start
+  void
+  py_remote_start (int nworkers);
+
+  //! Stop all out-of-process Python worker processes.
+  //!
+  //! Python objects that refer to values held by the workers are no longer
+  //! valid after calling this function.
+  void
+  py_remote_stop ();
+
+  //! Detach from the out-of-process Python workers in a forked child.
+  //!
+  //! The workers keep serving the parent process.  The child evaluates Python
+  //! code in its own process from then on.
+  void
+  py_remote_reset_after_fork ();
+
+  //! Check whether evaluation is forwarded to out-of-process workers.
+  //!
+  //! @return @c true if workers are running, @c false otherwise
+  bool
+  py_remote_enabled ();
+
+  //! Return the number of running out-of-process Python workers.
+  //!
+  //! @return number of workers, or 0 if the remote backend is not in use
+  int
+  py_remote_workers ();
+
+  //! Return a callable that forwards calls to the named remote function.
+  //!
+  //! The function is looked up by the worker at call time using the same
+  //! rules as @c py_find_function.
+  //!
+  //! @param name fully-qualified name of the function
+  //! @return a reference to a local proxy callable
+  PyObject *
+  py_remote_find_function (const std::string& name);
+
+  //! Evaluate a Python expression in an out-of-process worker.
+  //!
+  //! @param expr Python expression
+  //! @param locals remote namespace, or a null pointer
+  //! @return result of the expression
+  PyObject *
+  py_remote_eval_string (const std::string& expr, PyObject *locals = nullptr);
+
+  //! Execute Python code in out-of-process workers.
+  //!
+  //! Without a namespace, the code is executed by all workers so that
+  //! definitions and imports are visible to every later call.
+  //!
+  //! @param expr Python code
+  //! @param locals remote namespace, or a null pointer
+  //! @return Python None object
+  PyObject *
+  py_remote_exec_string (const std::string& expr, PyObject *locals = nullptr);
+
+}
+
+#endif
@@ -0,0 +1,216 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+#if defined (HAVE_CONFIG_H)
+#  include <config.h>
+#endif
+
+#include <Python.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <octave/oct.h>
+#include <octave/oct-map.h>
+
+#include "oct-py-slowlog.h"
+#include "oct-py-stats.h"
+#include "oct-py-trace.h"
+
+namespace pythonic
+{
+
+  py_instrument py_slowlog;
+
+  struct slow_call
+  {
+    double timestamp;
+    const char *function;
+    std::string target;
+    std::string arguments;
+    double bytes;
+    std::string result;
+    double time;
+    double conversion;
+  };
+
+  // Ring buffer of the most recent slow calls
+
+  static std::vector<slow_call> slowlog;
+  static std::size_t slowlog_next = 0;
+  static std::size_t slowlog_count = 0;
+  static std::chrono::steady_clock::duration slowlog_threshold;
+
+  void
+  py_slowlog_start (double threshold, std::size_t capacity)
+  {
+    if (! (threshold >= 0))
+      error ("pythonic: slow call threshold must be a non-negative number");
+    if (capacity == 0)
+      error ("pythonic: slow call log capacity must be positive");
+
+    slowlog_threshold = std::chrono::duration_cast<std::chrono::steady_clock::duration>
+      (std::chrono::duration<double> (threshold));
+
+    if (capacity != slowlog.size ())
+      {
+        slowlog.assign (capacity, slow_call ());
+        slowlog_next = 0;
+        slowlog_count = 0;
+      }
+
+    py_slowlog.enable ();
+  }
+
+  void
+  py_slowlog_stop ()
+  {
+    py_slowlog.enable (false);
+  }
+
+  void
+  py_slowlog_clear ()
+  {
+    slowlog_next = 0;
+    slowlog_count = 0;
+  }
+
+  template <typename F>
+  static void
+  for_each_slow_call (F fcn)
+  {
+    std::size_t capacity = slowlog.size ();
+    std::size_t first = (slowlog_count < capacity) ? 0 : slowlog_next;
+    for (std::size_t i = 0; i < slowlog_count; i++)
+      fcn (i, slowlog[(first + i) % capacity]);
+  }
+
+  octave_map
+  py_slowlog_entries ()
+  {
+    dim_vector dims (slowlog_count, 1);
+    Cell timestamp (dims), function (dims), target (dims), arguments (dims);
+    Cell bytes (dims), result (dims), time (dims), conversion (dims);
+
+    for_each_slow_call ([&] (std::size_t i, const slow_call& c)
+      {
+        timestamp(i) = c.timestamp;
+        function(i) = c.function;
+        target(i) = c.target;
+        arguments(i) = c.arguments;
+        bytes(i) = c.bytes;
+        result(i) = c.result;
+        time(i) = c.time;
+        conversion(i) = c.conversion;
+      });
+
+    octave_map map (dims);
+    map.setfield ("timestamp", timestamp);
+    map.setfield ("function", function);
+    map.setfield ("target", target);
+    map.setfield ("arguments", arguments);
+    map.setfield ("bytes", bytes);
+    map.setfield ("result", result);
+    map.setfield ("time", time);
+    map.setfield ("conversion", conversion);
+    return map;
+  }
+
+  void
+  py_slowlog_save (const std::string& filename)
+  {
+    FILE *fid = std::fopen (filename.c_str (), "w");
+    if (! fid)
+      error ("pythonic: unable to open slow call log \"%s\" for writing",
+             filename.c_str ());
+
+    std::fprintf (fid, "timestamp\tfunction\ttarget\targuments\tbytes\t"
+                  "result\ttime\tconversion\n");
+
+    for_each_slow_call ([fid] (std::size_t, const slow_call& c)
+      {
+        std::fprintf (fid, "%.6f\t%s\t%s\t%s\t%.0f\t%s\t%.6f\t%.6f\n",
+                      c.timestamp, c.function, c.target.c_str (),
+                      c.arguments.c_str (), c.bytes, c.result.c_str (),
+                      c.time, c.conversion);
+      });
+
+    if (std::fclose (fid) != 0)
+      error ("pythonic: error writing slow call log \"%s\"",
+             filename.c_str ());
+  }
+
+  void
+  py_slowlog_call::finish (const std::string& code, PyObject *result)
+  {
+    if (m_active)
+      end (nullptr, &code, octave_value_list (), result);
+  }
+
+  void
+  py_slowlog_call::begin ()
+  {
+    m_start = std::chrono::steady_clock::now ();
+    m_conversion = py_stats_time (PY_STATS_CONVERSION);
+  }
+
+  // Make a string safe to write as one field of a tab-separated line
+
+  static std::string
+  one_line (std::string str)
+  {
+    for (auto& c : str)
+      if (c == '\t' || c == '\n' || c == '\r')
+        c = ' ';
+    return str;
+  }
+
+  void
+  py_slowlog_call::end (PyObject *callable, const std::string *code,
+                        const octave_value_list& args, PyObject *result)
+  {
+    auto duration = std::chrono::steady_clock::now () - m_start;
+    if (duration < slowlog_threshold || slowlog.empty ())
+      return;
+
+    slow_call& c = slowlog[slowlog_next];
+    c.timestamp = std::chrono::duration<double>
+      (std::chrono::system_clock::now ().time_since_epoch ()).count ();
+    c.function = m_function;
+    c.target = one_line (code ? code->substr (0, 80)
+                              : py_trace_function_name (callable));
+    c.arguments = py_trace_summary (args);
+    c.bytes = 0;
+    for (octave_idx_type i = 0; i < args.length (); i++)
+      c.bytes += args(i).byte_size ();
+    c.result = result ? Py_TYPE (result)->tp_name : "";
+    c.time = std::chrono::duration<double> (duration).count ();
+    c.conversion = std::chrono::duration<double>
+      (py_stats_time (PY_STATS_CONVERSION) - m_conversion).count ();
+
+    slowlog_next = (slowlog_next + 1) % slowlog.size ();
+    if (slowlog_count < slowlog.size ())
+      slowlog_count++;
+  }
+
+}
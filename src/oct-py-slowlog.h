@@ -0,0 +1,112 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+#if ! defined (pythonic_oct_py_slowlog_h)
+#define pythonic_oct_py_slowlog_h 1
+
+#include <Python.h>
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+#include "oct-py-instrument.h"
+
+class octave_map;
+class octave_value_list;
+
+namespace pythonic
+{
+
+  //! On while slow calls are being logged.
+  extern py_instrument py_slowlog;
+
+  //! Start logging calls that take at least @a threshold seconds.
+  //!
+  //! @param threshold minimum wall time of a logged call in seconds
+  //! @param capacity maximum number of calls kept, older calls are dropped
+  void
+  py_slowlog_start (double threshold, std::size_t capacity);
+
+  //! Stop logging slow calls, keeping the calls logged so far.
+  void
+  py_slowlog_stop ();
+
+  //! Discard all logged calls.
+  void
+  py_slowlog_clear ();
+
+  //! Return the logged calls, oldest first, as an Octave struct array.
+  //!
+  //! @return struct array with one element per logged call
+  octave_map
+  py_slowlog_entries ();
+
+  //! Write the logged calls to a file as tab-separated text.
+  //!
+  //! @param filename name of the file to write
+  void
+  py_slowlog_save (const std::string& filename);
+
+  //! Measure one call of pycall, pyeval, or pyexec.
+  //!
+  //! The call is logged when finish () is called if it took longer than
+  //! the threshold.  Names and argument summaries are only computed for
+  //! calls that are logged.  Calls that end in an error are not logged.
+  class py_slowlog_call : public py_instrument_scope
+  {
+  public:
+
+    py_slowlog_call (const char *function)
+      : py_instrument_scope (py_slowlog), m_function (function)
+    {
+      if (m_active)
+        begin ();
+    }
+
+    //! Finish a call of a Python callable.
+    void finish (PyObject *callable, const octave_value_list& args,
+                 PyObject *result)
+    {
+      if (m_active)
+        end (callable, nullptr, args, result);
+    }
+
+    //! Finish an evaluation of Python code.
+    void finish (const std::string& code, PyObject *result);
+
+  private:
+
+    void begin ();
+
+    void end (PyObject *callable, const std::string *code,
+              const octave_value_list& args, PyObject *result);
+
+    const char *m_function;
+    std::chrono::steady_clock::time_point m_start;
+    std::chrono::steady_clock::duration m_conversion;
+  };
+
+}
+
+#endif
@@ -0,0 +1,305 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+#if defined (HAVE_CONFIG_H)
+#  include <config.h>
+#endif
+
+#include <Python.h>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <octave/oct.h>
+#include <octave/Sparse.h>
+
+#include "oct-py-buffer.h"
+#include "oct-py-error.h"
+#include "oct-py-object.h"
+#include "oct-py-sparse.h"
+#include "oct-py-util.h"
+
+namespace pythonic
+{
+
+  // Reference to one of the three arrays of an Octave sparse matrix.
+
+  template <typename T>
+  class py_sparse_holder : public py_array_holder
+  {
+  public:
+    enum part { VALUES, ROW_INDEX, COLUMN_INDEX };
+
+    py_sparse_holder (const Sparse<T>& sparse, part p)
+      : m_sparse (sparse), m_part (p) { }
+
+    const void *data () const
+    {
+      switch (m_part)
+        {
+        case VALUES:
+          return m_sparse.data ();
+        case ROW_INDEX:
+          return m_sparse.ridx ();
+        default:
+          return m_sparse.cidx ();
+        }
+    }
+
+  private:
+    Sparse<T> m_sparse;
+    part m_part;
+  };
+
+  static const char *
+  py_index_format ()
+  {
+    return (sizeof (octave_idx_type) == 8) ? "q" : "i";
+  }
+
+  static PyObject *
+  make_py_sparse_part (PyObject *numpy, py_array_holder *holder,
+                       const std::string& format, Py_ssize_t itemsize,
+                       octave_idx_type n)
+  {
+    python_object buf = make_py_buffer (holder, format, itemsize,
+                                        dim_vector (n, 1));
+    PyObject *arr = PyObject_CallMethod (numpy, "asarray", "(O)",
+                                         static_cast<PyObject *> (buf));
+    if (! arr)
+      error_python_exception ();
+    return arr;
+  }
+
+  template <typename T>
+  static void
+  make_py_sparse_parts (PyObject *numpy, const Sparse<T>& sparse,
+                        const char *format, python_object& values,
+                        python_object& indices, python_object& indptr)
+  {
+    typedef py_sparse_holder<T> holder;
+
+    octave_idx_type nnz = sparse.nnz ();
+
+    values = python_object (make_py_sparse_part (numpy, new holder (sparse, holder::VALUES),
+                                                 format, sizeof (T), nnz));
+    indices = python_object (make_py_sparse_part (numpy, new holder (sparse, holder::ROW_INDEX),
+                                                  py_index_format (),
+                                                  sizeof (octave_idx_type), nnz));
+    indptr = python_object (make_py_sparse_part (numpy, new holder (sparse, holder::COLUMN_INDEX),
+                                                 py_index_format (),
+                                                 sizeof (octave_idx_type),
+                                                 sparse.cols () + 1));
+  }
+
+  PyObject *
+  make_py_sparse (const octave_value& value)
+  {
+    python_object sparse_module = py_import_module ("scipy.sparse");
+    python_object numpy = py_import_module ("numpy");
+    if (! (sparse_module && numpy))
+      error ("unable to convert Octave sparse matrix to a Python object, "
+             "scipy is not available");
+
+    python_object values, indices, indptr;
+    if (value.islogical ())
+      make_py_sparse_parts (numpy, value.sparse_bool_matrix_value (), "?",
+                            values, indices, indptr);
+    else if (value.iscomplex ())
+      make_py_sparse_parts (numpy, value.sparse_complex_matrix_value (), "Zd",
+                            values, indices, indptr);
+    else
+      make_py_sparse_parts (numpy, value.sparse_matrix_value (), "d",
+                            values, indices, indptr);
+
+    // Start from an empty matrix and attach the shared arrays, since the
+    // constructor copies the indices to narrow their type when it can.
+    Py_ssize_t rows = value.rows ();
+    Py_ssize_t cols = value.columns ();
+    python_object mat = PyObject_CallMethod (sparse_module, "csc_matrix",
+                                             "((nn))", rows, cols);
+    if (! mat)
+      error_python_exception ();
+
+    // Octave sparse matrices are always in canonical form, which also
+    // keeps SciPy from sorting the read-only indices in place.
+    if (PyObject_SetAttrString (mat, "data", values) < 0
+        || PyObject_SetAttrString (mat, "indices", indices) < 0
+        || PyObject_SetAttrString (mat, "indptr", indptr) < 0
+        || PyObject_SetAttrString (mat, "has_sorted_indices", Py_True) < 0
+        || PyObject_SetAttrString (mat, "has_canonical_format", Py_True) < 0)
+      error_python_exception ();
+
+    return mat.release ();
+  }
+
+  bool
+  py_is_sparse (PyObject *obj)
+  {
+    // Only look for a sparse matrix if scipy.sparse has already been imported
+    PyObject *sparse_module = PyDict_GetItemString (PyImport_GetModuleDict (),
+                                                    "scipy.sparse");
+    if (! sparse_module)
+      return false;
+
+    python_object result = PyObject_CallMethod (sparse_module, "issparse",
+                                                "(O)", obj);
+    if (! result)
+      {
+        PyErr_Clear ();
+        return false;
+      }
+
+    return PyObject_IsTrue (result) == 1;
+  }
+
+  // Copy an index array of any integer width into Octave indices.
+
+  static void
+  copy_py_index (PyObject *obj, octave_idx_type *dst, octave_idx_type n)
+  {
+    Py_buffer view;
+    if (PyObject_GetBuffer (obj, &view, PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) < 0)
+      error_python_exception ();
+
+    bool ok = (view.len / view.itemsize >= n);
+    if (ok && view.itemsize == sizeof (octave_idx_type))
+      std::memcpy (dst, view.buf, n * sizeof (octave_idx_type));
+    else if (ok && view.itemsize == 8)
+      std::copy_n (static_cast<const int64_t *> (view.buf), n, dst);
+    else if (ok && view.itemsize == 4)
+      std::copy_n (static_cast<const int32_t *> (view.buf), n, dst);
+    else
+      ok = false;
+
+    PyBuffer_Release (&view);
+
+    if (! ok)
+      error ("unable to convert SciPy sparse matrix, invalid index array");
+  }
+
+  template <typename S, typename A>
+  static S
+  make_octave_sparse (octave_idx_type rows, octave_idx_type cols,
+                      octave_idx_type nnz, const A& values,
+                      PyObject *indices, PyObject *indptr)
+  {
+    if (nnz < 0)
+      error ("unable to convert SciPy sparse matrix, invalid index pointer "
+             "array");
+    if (values.numel () < nnz)
+      error ("unable to convert SciPy sparse matrix, invalid data array");
+
+    S retval (rows, cols, nnz);
+    std::copy_n (values.data (), nnz, retval.data ());
+    copy_py_index (indices, retval.ridx (), nnz);
+    copy_py_index (indptr, retval.cidx (), cols + 1);
+
+    // The canonical format flag of a SciPy matrix can be set by hand, check
+    // the indices before Octave relies on them
+    const octave_idx_type *cidx = retval.cidx ();
+    const octave_idx_type *ridx = retval.ridx ();
+    if (cidx[0] != 0 || cidx[cols] != nnz)
+      error ("unable to convert SciPy sparse matrix, invalid index pointer "
+             "array");
+    for (octave_idx_type j = 0; j < cols; j++)
+      {
+        if (cidx[j+1] < cidx[j])
+          error ("unable to convert SciPy sparse matrix, invalid index "
+                 "pointer array");
+        for (octave_idx_type k = cidx[j]; k < cidx[j+1]; k++)
+          if (ridx[k] < 0 || ridx[k] >= rows
+              || (k > cidx[j] && ridx[k] <= ridx[k-1]))
+            error ("unable to convert SciPy sparse matrix, invalid or "
+                   "unsorted row index");
+      }
+
+    // SciPy allows explicitly stored zeros, Octave does not
+    retval.maybe_compress (true);
+
+    return retval;
+  }
+
+  octave_value
+  extract_py_sparse (PyObject *obj)
+  {
+    python_object csc = PyObject_CallMethod (obj, "tocsc", nullptr);
+    if (! csc)
+      error_python_exception ();
+
+    // Sort the indices and sum duplicate entries on a copy, tocsc may
+    // return the original matrix.
+    python_object canonical = PyObject_GetAttrString (csc, "has_canonical_format");
+    if (! canonical)
+      error_python_exception ();
+    if (! PyObject_IsTrue (canonical))
+      {
+        csc = python_object (PyObject_CallMethod (csc, "copy", nullptr));
+        python_object status = csc ? PyObject_CallMethod (csc, "sum_duplicates",
+                                                          nullptr)
+                                   : nullptr;
+        if (! status)
+          error_python_exception ();
+      }
+
+    python_object shape = PyObject_GetAttrString (csc, "shape");
+    python_object data = PyObject_GetAttrString (csc, "data");
+    python_object indices = PyObject_GetAttrString (csc, "indices");
+    python_object indptr = PyObject_GetAttrString (csc, "indptr");
+    if (! (shape && data && indices && indptr))
+      error_python_exception ();
+
+    if (! (PyTuple_Check (static_cast<PyObject *> (shape))
+           && PyTuple_Size (shape) == 2))
+      error ("unable to convert SciPy sparse matrix, must be two-dimensional");
+
+    octave_idx_type rows = PyLong_AsSsize_t (PyTuple_GET_ITEM (static_cast<PyObject *> (shape), 0));
+    octave_idx_type cols = PyLong_AsSsize_t (PyTuple_GET_ITEM (static_cast<PyObject *> (shape), 1));
+    if (PyErr_Occurred ())
+      error_python_exception ();
+
+    octave_idx_type nnz = 0;
+    if (cols >= 0)
+      {
+        Array<octave_idx_type> last (dim_vector (cols + 1, 1));
+        copy_py_index (indptr, last.fortran_vec (), cols + 1);
+        nnz = last(cols);
+      }
+
+    octave_value values = extract_py_buffer (data);
+
+    if (values.islogical ())
+      return make_octave_sparse<SparseBoolMatrix> (rows, cols, nnz,
+                                                   values.bool_array_value (),
+                                                   indices, indptr);
+    else if (values.iscomplex ())
+      return make_octave_sparse<SparseComplexMatrix> (rows, cols, nnz,
+                                                      values.complex_array_value (),
+                                                      indices, indptr);
+    else
+      return make_octave_sparse<SparseMatrix> (rows, cols, nnz,
+                                               values.array_value (),
+                                               indices, indptr);
+  }
+
+}
@@ -0,0 +1,67 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+#if ! defined (pythonic_oct_py_sparse_h)
+#define pythonic_oct_py_sparse_h 1
+
+#include <Python.h>
+
+class octave_value;
+
+namespace pythonic
+{
+
+  //! Check whether an object is a SciPy sparse matrix or array.
+  //!
+  //! @param obj Python object
+  //! @return @c true if @a obj is a SciPy sparse matrix, @c false otherwise
+  bool
+  py_is_sparse (PyObject *obj);
+
+  //! Convert a SciPy sparse matrix to an Octave sparse matrix.
+  //!
+  //! The matrix is converted to compressed sparse column format if needed.
+  //! The values and indices are copied once into the Octave sparse matrix.
+  //! Boolean matrices become logical sparse matrices, complex matrices
+  //! become complex sparse matrices, and all other types become double.
+  //!
+  //! @param obj SciPy sparse matrix
+  //! @return Octave sparse matrix
+  octave_value
+  extract_py_sparse (PyObject *obj);
+
+  //! Create a SciPy CSC matrix that shares the data of an Octave sparse
+  //! matrix.
+  //!
+  //! The values, row indices, and column pointers of the Octave matrix are
+  //! exported as read-only NumPy arrays without copying them.
+  //!
+  //! @param value Octave sparse matrix
+  //! @return a reference to a new @c scipy.sparse.csc_matrix object
+  PyObject *
+  make_py_sparse (const octave_value& value);
+
+}
+
+#endif
@@ -0,0 +1,348 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+#if defined (HAVE_CONFIG_H)
+#  include <config.h>
+#endif
+
+#include <Python.h>
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <octave/oct.h>
+#include <octave/Cell.h>
+#include <octave/oct-map.h>
+
+#include "oct-py-error.h"
+#include "oct-py-stats.h"
+
+namespace pythonic
+{
+
+  // Counters are plain integers, the Python GIL or the single-threaded
+  // Octave interpreter serializes every caller.  Function and Python type
+  // names are copied into the keys, so that no key points into a .oct file
+  // that may be unloaded or at a type object whose address may be reused.
+  // Octave type names are looked up once per type id.
+
+  typedef std::pair<std::string, uint64_t> named_count;
+
+#if defined (PYTHONIC_AUDIT)
+  // Total change in allocated blocks and references over all audited calls
+  // of one function, the reference count is only known on debug builds
+
+  struct audit_delta
+  {
+    uint64_t calls = 0;
+    int64_t blocks = 0;
+    int64_t refs = 0;
+    bool have_refs = false;
+  };
+#endif
+
+  struct boundary_stats
+  {
+    std::unordered_map<std::string, uint64_t> calls;
+    std::unordered_map<int, named_count> arguments;
+    std::unordered_map<std::string, uint64_t> returns;
+    uint64_t fallbacks = 0;
+    uint64_t python_exceptions = 0;
+    uint64_t octave_exceptions = 0;
+    uint64_t bytes = 0;
+    std::size_t objstore_size = 0;
+    std::size_t objstore_peak = 0;
+    std::chrono::steady_clock::duration time[PY_STATS_NUM_CATEGORIES] {};
+#if defined (PYTHONIC_AUDIT)
+    std::unordered_map<std::string, audit_delta> audit;
+#endif
+  };
+
+  static boundary_stats stats;
+
+  static thread_local py_stats_timer *current_timer = nullptr;
+
+  void
+  py_stats_count_call (const char *name)
+  {
+    stats.calls[name]++;
+  }
+
+  void
+  py_stats_count_argument (const octave_value& value)
+  {
+    auto it = stats.arguments.find (value.type_id ());
+    if (it == stats.arguments.end ())
+      it = stats.arguments.emplace (value.type_id (),
+                                    named_count (value.class_name (), 0)).first;
+    it->second.second++;
+  }
+
+  void
+  py_stats_count_return (PyObject *obj)
+  {
+    stats.returns[Py_TYPE (obj)->tp_name]++;
+  }
+
+  void
+  py_stats_count_fallback ()
+  {
+    stats.fallbacks++;
+  }
+
+  void
+  py_stats_count_python_exception ()
+  {
+    stats.python_exceptions++;
+  }
+
+  void
+  py_stats_count_octave_exception ()
+  {
+    stats.octave_exceptions++;
+  }
+
+  void
+  py_stats_add_bytes (std::size_t bytes)
+  {
+    stats.bytes += bytes;
+  }
+
+  void
+  py_stats_objstore_size (std::size_t size)
+  {
+    stats.objstore_size = size;
+    stats.objstore_peak = std::max (stats.objstore_peak, size);
+  }
+
+  std::size_t
+  py_stats_objstore_peak ()
+  {
+    return stats.objstore_peak;
+  }
+
+  // Return a column struct array of names and counts, most frequent first
+
+  static octave_map
+  make_count_table (const std::unordered_map<std::string, uint64_t>& counts)
+  {
+    std::vector<named_count> sorted (counts.begin (), counts.end ());
+    std::sort (sorted.begin (), sorted.end (),
+               [] (const named_count& a, const named_count& b)
+               {
+                 return a.second > b.second
+                        || (a.second == b.second && a.first < b.first);
+               });
+
+    octave_idx_type n = sorted.size ();
+    Cell names (dim_vector (n, 1));
+    Cell values (dim_vector (n, 1));
+    for (octave_idx_type i = 0; i < n; i++)
+      {
+        names(i) = sorted[i].first;
+        values(i) = static_cast<double> (sorted[i].second);
+      }
+
+    octave_map map (dim_vector (n, 1));
+    map.setfield ("name", names);
+    map.setfield ("count", values);
+    return map;
+  }
+
+#if defined (PYTHONIC_AUDIT)
+  // Return a column struct array of the change in allocated blocks and
+  // references per function, largest growth first
+
+  static octave_map
+  make_audit_table ()
+  {
+    typedef std::pair<std::string, audit_delta> named_delta;
+
+    std::vector<named_delta> sorted (stats.audit.begin (), stats.audit.end ());
+    std::sort (sorted.begin (), sorted.end (),
+               [] (const named_delta& a, const named_delta& b)
+               {
+                 return a.second.blocks > b.second.blocks
+                        || (a.second.blocks == b.second.blocks
+                            && a.first < b.first);
+               });
+
+    octave_idx_type n = sorted.size ();
+    Cell names (dim_vector (n, 1));
+    Cell calls (dim_vector (n, 1));
+    Cell blocks (dim_vector (n, 1));
+    Cell refs (dim_vector (n, 1));
+    for (octave_idx_type i = 0; i < n; i++)
+      {
+        const audit_delta& d = sorted[i].second;
+        names(i) = sorted[i].first;
+        calls(i) = static_cast<double> (d.calls);
+        blocks(i) = static_cast<double> (d.blocks);
+        refs(i) = d.have_refs ? static_cast<double> (d.refs)
+                                : std::numeric_limits<double>::quiet_NaN ();
+      }
+
+    octave_map map (dim_vector (n, 1));
+    map.setfield ("name", names);
+    map.setfield ("calls", calls);
+    map.setfield ("blocks", blocks);
+    map.setfield ("refs", refs);
+    return map;
+  }
+#endif
+
+  static double
+  seconds (std::chrono::steady_clock::duration d)
+  {
+    return std::chrono::duration<double> (d).count ();
+  }
+
+  octave_scalar_map
+  py_stats ()
+  {
+    // Several Octave type ids may share a class name, merge them by name
+    std::unordered_map<std::string, uint64_t> arguments;
+    for (const auto& p : stats.arguments)
+      arguments[p.second.first] += p.second.second;
+
+    octave_scalar_map exceptions;
+    exceptions.setfield ("python", static_cast<double> (stats.python_exceptions));
+    exceptions.setfield ("octave", static_cast<double> (stats.octave_exceptions));
+
+    octave_scalar_map objstore;
+    objstore.setfield ("size", static_cast<double> (stats.objstore_size));
+    objstore.setfield ("peak", static_cast<double> (stats.objstore_peak));
+
+    octave_scalar_map time;
+    time.setfield ("conversion", seconds (stats.time[PY_STATS_CONVERSION]));
+    time.setfield ("python", seconds (stats.time[PY_STATS_PYTHON]));
+    time.setfield ("octave", seconds (stats.time[PY_STATS_OCTAVE]));
+
+    octave_scalar_map map;
+    map.setfield ("calls", make_count_table (stats.calls));
+    map.setfield ("arguments", make_count_table (arguments));
+    map.setfield ("returns", make_count_table (stats.returns));
+    map.setfield ("fallbacks", static_cast<double> (stats.fallbacks));
+    map.setfield ("bytes", static_cast<double> (stats.bytes));
+    map.setfield ("exceptions", exceptions);
+    map.setfield ("objstore", objstore);
+    map.setfield ("time", time);
+#if defined (PYTHONIC_AUDIT)
+    map.setfield ("audit", make_audit_table ());
+#endif
+    return map;
+  }
+
+  void
+  py_stats_reset ()
+  {
+    // Keep the current object store size, reset its high-water mark to it
+    std::size_t size = stats.objstore_size;
+    stats = boundary_stats ();
+    stats.objstore_size = size;
+    stats.objstore_peak = size;
+  }
+
+  std::chrono::steady_clock::duration
+  py_stats_time (py_stats_category category)
+  {
+    return stats.time[category];
+  }
+
+#if defined (PYTHONIC_AUDIT)
+  // Return the value of a counter function in the sys module, or -1 if it
+  // is not available, for example sys.gettotalrefcount on a release build
+
+  static long
+  py_audit_counter (const char *name)
+  {
+    PyObject *fcn = PySys_GetObject (name);
+    if (! fcn)
+      return -1;
+
+    PyObject *res = PyObject_CallFunctionObjArgs (fcn, nullptr);
+    long n = res ? PyLong_AsLong (res) : -1;
+    Py_XDECREF (res);
+    if (n < 0)
+      PyErr_Clear ();
+    return n;
+  }
+
+  void
+  py_stats_call::audit_begin (const char *name)
+  {
+    if (! Py_IsInitialized ())
+      return;
+
+    m_name = name;
+    m_blocks = py_audit_counter ("getallocatedblocks");
+    m_refs = py_audit_counter ("gettotalrefcount");
+  }
+
+  void
+  py_stats_call::audit_end ()
+  {
+    if (m_name.empty ())
+      return;
+
+    long blocks, refs;
+    {
+      py_error_preserve preserve;
+      blocks = py_audit_counter ("getallocatedblocks");
+      refs = py_audit_counter ("gettotalrefcount");
+    }
+
+    audit_delta& d = stats.audit[m_name];
+    d.calls++;
+    if (m_blocks >= 0 && blocks >= 0)
+      d.blocks += blocks - m_blocks;
+    if (m_refs >= 0 && refs >= 0)
+      {
+        d.refs += refs - m_refs;
+        d.have_refs = true;
+      }
+  }
+#endif
+
+  py_stats_timer::py_stats_timer (py_stats_category category)
+    : m_category (category), m_parent (current_timer),
+      m_start (std::chrono::steady_clock::now ())
+  {
+    if (m_parent)
+      stats.time[m_parent->m_category] += m_start - m_parent->m_start;
+    current_timer = this;
+  }
+
+  py_stats_timer::~py_stats_timer ()
+  {
+    auto now = std::chrono::steady_clock::now ();
+    stats.time[m_category] += now - m_start;
+    if (m_parent)
+      m_parent->m_start = now;
+    current_timer = m_parent;
+  }
+
+}
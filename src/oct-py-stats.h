@@ -0,0 +1,185 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+#if ! defined (pythonic_oct_py_stats_h)
+#define pythonic_oct_py_stats_h 1
+
+#include <Python.h>
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+class octave_scalar_map;
+class octave_value;
+
+namespace pythonic
+{
+
+  //! Categories of time spent crossing between Octave and Python.
+  enum py_stats_category
+  {
+    PY_STATS_CONVERSION,
+    PY_STATS_PYTHON,
+    PY_STATS_OCTAVE,
+    PY_STATS_NUM_CATEGORIES
+  };
+
+  //! Count one call of a built-in function of the package.
+  //!
+  //! @param name name of the function
+  void
+  py_stats_count_call (const char *name);
+
+  //! Count one conversion of an Octave value to a Python argument.
+  //!
+  //! @param value Octave value being converted
+  void
+  py_stats_count_argument (const octave_value& value);
+
+  //! Count one conversion of a Python object to an Octave return value.
+  //!
+  //! @param obj Python object being converted
+  void
+  py_stats_count_return (PyObject *obj);
+
+  //! Count one return value that was wrapped as a pyobject because it has
+  //! no Octave equivalent.
+  void
+  py_stats_count_fallback ();
+
+  //! Count one Python exception raised as an Octave error.
+  void
+  py_stats_count_python_exception ();
+
+  //! Count one Octave error raised as a Python exception.
+  void
+  py_stats_count_octave_exception ();
+
+  //! Count bytes of data copied between Octave and Python.
+  //!
+  //! @param bytes number of bytes copied
+  void
+  py_stats_add_bytes (std::size_t bytes);
+
+  //! Record the current number of objects in the object store.
+  //!
+  //! @param size number of objects in the object store
+  void
+  py_stats_objstore_size (std::size_t size);
+
+  //! Return the largest number of objects in the object store since the
+  //! counters were last reset.
+  //!
+  //! @return peak number of objects in the object store
+  std::size_t
+  py_stats_objstore_peak ();
+
+  //! Return all counters and times as an Octave struct.
+  //!
+  //! @return scalar struct of boundary statistics
+  octave_scalar_map
+  py_stats ();
+
+  //! Reset all counters and times to zero.
+  void
+  py_stats_reset ();
+
+  //! Return the total time spent in one category, not including the time
+  //! of any timer that is still running.
+  //!
+  //! @param category category of time
+  //! @return accumulated time
+  std::chrono::steady_clock::duration
+  py_stats_time (py_stats_category category);
+
+  //! Scope of one call of a built-in function of the package.
+  //!
+  //! The call is counted as with py_stats_count_call ().  In builds with
+  //! @c PYTHONIC_AUDIT defined, the change over the call in the number of
+  //! allocated Python memory blocks, and in the total reference count on
+  //! debug builds of Python, is also added up for each function, so that
+  //! functions that leak Python objects can be found.
+  class py_stats_call
+  {
+  public:
+
+    py_stats_call (const char *name)
+    {
+      py_stats_count_call (name);
+#if defined (PYTHONIC_AUDIT)
+      audit_begin (name);
+#endif
+    }
+
+#if defined (PYTHONIC_AUDIT)
+    ~py_stats_call ()
+    {
+      audit_end ();
+    }
+#endif
+
+    py_stats_call (const py_stats_call&) = delete;
+
+    py_stats_call& operator = (const py_stats_call&) = delete;
+
+#if defined (PYTHONIC_AUDIT)
+  private:
+
+    void audit_begin (const char *name);
+
+    void audit_end ();
+
+    std::string m_name;
+    long m_blocks = 0;
+    long m_refs = 0;
+#endif
+  };
+
+  //! Scoped timer adding the time spent in its scope to one category.
+  //!
+  //! Timers nest, and time is only added to the innermost active timer, so
+  //! that for example the time spent converting the arguments of an Octave
+  //! callback is not also counted as Python execution time.
+  class py_stats_timer
+  {
+  public:
+
+    py_stats_timer (py_stats_category category);
+
+    ~py_stats_timer ();
+
+    py_stats_timer (const py_stats_timer&) = delete;
+
+    py_stats_timer& operator = (const py_stats_timer&) = delete;
+
+  private:
+
+    py_stats_category m_category;
+    py_stats_timer *m_parent;
+    std::chrono::steady_clock::time_point m_start;
+  };
+
+}
+
+#endif
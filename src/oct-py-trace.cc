@@ -0,0 +1,235 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+#if defined (HAVE_CONFIG_H)
+#  include <config.h>
+#endif
+
+#include <Python.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <octave/oct.h>
+
+#include "oct-py-object.h"
+#include "oct-py-trace.h"
+#include "oct-py-util.h"
+
+namespace pythonic
+{
+
+  py_instrument py_trace;
+
+  struct trace_event
+  {
+    std::string name;
+    const char *category;
+    double start_us;
+    double duration_us;
+    unsigned long thread;
+    std::string args;
+  };
+
+  // Fixed-size ring buffer, the oldest events are overwritten when full
+
+  static std::vector<trace_event> trace_buffer;
+  static std::size_t trace_next = 0;
+  static std::size_t trace_count = 0;
+  static std::chrono::steady_clock::time_point trace_epoch;
+
+  void
+  py_trace_start (std::size_t capacity)
+  {
+    if (capacity == 0)
+      error ("pythonic: trace buffer capacity must be positive");
+
+    trace_buffer.assign (capacity, trace_event ());
+    trace_next = 0;
+    trace_count = 0;
+    trace_epoch = std::chrono::steady_clock::now ();
+    py_trace.enable ();
+  }
+
+  void
+  py_trace_stop ()
+  {
+    py_trace.enable (false);
+  }
+
+  void
+  py_trace_clear ()
+  {
+    trace_next = 0;
+    trace_count = 0;
+  }
+
+  std::size_t
+  py_trace_size ()
+  {
+    return trace_count;
+  }
+
+  static void
+  write_json_string (FILE *fid, const char *str)
+  {
+    std::fputc ('"', fid);
+    for (const char *p = str; *p; p++)
+      {
+        unsigned char c = static_cast<unsigned char> (*p);
+        if (c == '"' || c == '\\')
+          std::fprintf (fid, "\\%c", c);
+        else if (c < 0x20)
+          std::fprintf (fid, "\\u%04x", c);
+        else
+          std::fputc (c, fid);
+      }
+    std::fputc ('"', fid);
+  }
+
+  void
+  py_trace_save (const std::string& filename)
+  {
+    FILE *fid = std::fopen (filename.c_str (), "w");
+    if (! fid)
+      error ("pythonic: unable to open trace file \"%s\" for writing",
+             filename.c_str ());
+
+    long pid = static_cast<long> (getpid ());
+    std::size_t capacity = trace_buffer.size ();
+    std::size_t first = (trace_count < capacity) ? 0 : trace_next;
+
+    std::fprintf (fid, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    std::fprintf (fid, "{\"name\": \"process_name\", \"ph\": \"M\", "
+                  "\"pid\": %ld, \"args\": {\"name\": \"Octave\"}}", pid);
+
+    for (std::size_t i = 0; i < trace_count; i++)
+      {
+        const trace_event& e = trace_buffer[(first + i) % capacity];
+        std::fprintf (fid, ",\n{\"name\": ");
+        write_json_string (fid, e.name.c_str ());
+        std::fprintf (fid, ", \"cat\": ");
+        write_json_string (fid, e.category);
+        std::fprintf (fid, ", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, "
+                      "\"pid\": %ld, \"tid\": %lu", e.start_us,
+                      e.duration_us, pid, e.thread);
+        if (! e.args.empty ())
+          {
+            std::fprintf (fid, ", \"args\": {\"summary\": ");
+            write_json_string (fid, e.args.c_str ());
+            std::fprintf (fid, "}");
+          }
+        std::fprintf (fid, "}");
+      }
+
+    std::fprintf (fid, "\n]}\n");
+
+    if (std::fclose (fid) != 0)
+      error ("pythonic: error writing trace file \"%s\"", filename.c_str ());
+  }
+
+  std::string
+  py_trace_function_name (PyObject *callable)
+  {
+    std::string name;
+
+    python_object qualname = PyObject_GetAttrString (callable, "__qualname__");
+    if (qualname && PyUnicode_Check (qualname))
+      {
+        python_object module = PyObject_GetAttrString (callable, "__module__");
+        if (module && PyUnicode_Check (module))
+          name = std::string (PyUnicode_AsUTF8 (module)) + '.';
+        name += PyUnicode_AsUTF8 (qualname);
+      }
+    else
+      name = Py_TYPE (callable)->tp_name;
+
+    PyErr_Clear ();
+    return name;
+  }
+
+  std::string
+  py_trace_summary (const octave_value_list& args)
+  {
+    std::string summary;
+    for (octave_idx_type i = 0; i < args.length (); i++)
+      {
+        if (i > 0)
+          summary += ", ";
+        summary += args(i).class_name () + ' ' + args(i).dims ().str ();
+      }
+    return summary;
+  }
+
+  std::string
+  py_trace_summary (PyObject *obj)
+  {
+    if (! obj)
+      return "";
+
+    std::string summary = Py_TYPE (obj)->tp_name;
+    if (PySequence_Check (obj) || PyMapping_Check (obj))
+      {
+        Py_ssize_t len = PyObject_Length (obj);
+        if (len >= 0)
+          summary += " len " + std::to_string (len);
+        else
+          PyErr_Clear ();
+      }
+    return summary;
+  }
+
+  void
+  py_trace_scope::begin (const char *name, const char *category)
+  {
+    m_name = name;
+    m_category = category;
+    m_start = std::chrono::steady_clock::now ();
+  }
+
+  void
+  py_trace_scope::end ()
+  {
+    // Tracing may have been restarted with a new buffer meanwhile
+    if (trace_buffer.empty () || m_start < trace_epoch)
+      return;
+
+    auto now = std::chrono::steady_clock::now ();
+    std::chrono::duration<double, std::micro> start = m_start - trace_epoch;
+    std::chrono::duration<double, std::micro> duration = now - m_start;
+
+    trace_event& e = trace_buffer[trace_next];
+    e.name.swap (m_name);
+    e.category = m_category;
+    e.start_us = start.count ();
+    e.duration_us = duration.count ();
+    e.thread = PyThread_get_thread_ident ();
+    e.args.swap (m_args);
+
+    trace_next = (trace_next + 1) % trace_buffer.size ();
+    if (trace_count < trace_buffer.size ())
+      trace_count++;
+  }
+
+}
@@ -0,0 +1,135 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+#if ! defined (pythonic_oct_py_trace_h)
+#define pythonic_oct_py_trace_h 1
+
+#include <Python.h>
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+#include "oct-py-instrument.h"
+
+class octave_value;
+class octave_value_list;
+
+namespace pythonic
+{
+
+  //! On while boundary crossings are being traced.
+  extern py_instrument py_trace;
+
+  //! Start tracing into a new ring buffer holding the most recent events.
+  //!
+  //! @param capacity maximum number of events kept
+  void
+  py_trace_start (std::size_t capacity);
+
+  //! Stop tracing, keeping the recorded events.
+  void
+  py_trace_stop ();
+
+  //! Discard all recorded events.
+  void
+  py_trace_clear ();
+
+  //! Return the number of events in the ring buffer.
+  //!
+  //! @return number of recorded events
+  std::size_t
+  py_trace_size ();
+
+  //! Write the recorded events to a file as Chrome trace-event JSON.
+  //!
+  //! The file can be opened in Perfetto or in chrome://tracing.
+  //!
+  //! @param filename name of the file to write
+  void
+  py_trace_save (const std::string& filename);
+
+  //! Return a readable name for a Python callable, such as "math.sqrt".
+  //!
+  //! @param callable Python callable object
+  //! @return qualified name of the callable
+  std::string
+  py_trace_function_name (PyObject *callable);
+
+  //! Summarize the classes and dimensions of an argument list, for example
+  //! "double 1x3, cell 1x2".
+  //!
+  //! @param args Octave argument list
+  //! @return summary string
+  std::string
+  py_trace_summary (const octave_value_list& args);
+
+  //! Summarize the type and length of a Python object.
+  //!
+  //! @param obj Python object
+  //! @return summary string
+  std::string
+  py_trace_summary (PyObject *obj);
+
+  //! Scoped trace event, recorded as one complete event when it ends.
+  //!
+  //! Nothing is recorded, and no summary should be computed, unless
+  //! active () is true.
+  class py_trace_scope : public py_instrument_scope
+  {
+  public:
+
+    py_trace_scope (const char *name, const char *category)
+      : py_instrument_scope (py_trace)
+    {
+      if (m_active)
+        begin (name, category);
+    }
+
+    ~py_trace_scope ()
+    {
+      if (m_active)
+        end ();
+    }
+
+    //! Replace the event name, for example with a Python function name.
+    void name (const std::string& name) { m_name = name; }
+
+    //! Attach a description of the arguments to the event.
+    void args (const std::string& summary) { m_args = summary; }
+
+  private:
+
+    void begin (const char *name, const char *category);
+
+    void end ();
+
+    std::string m_name;
+    const char *m_category = nullptr;
+    std::chrono::steady_clock::time_point m_start;
+    std::string m_args;
+  };
+
+}
+
+#endif
@@ -27,15 +27,22 @@ along with Octave Pythonic; see the file COPYING.  If not, see
 #endif
 
 #include <Python.h>
+#include <cstring>
 #include <limits>
 #include <octave/Cell.h>
 #include <octave/oct-map.h>
 #include <octave/quit.h>
 #include <octave/ov-null-mat.h>
 
+#include "oct-py-buffer.h"
+#include "oct-py-callback.h"
 #include "oct-py-error.h"
 #include "oct-py-eval.h"
+#include "oct-py-lazy.h"
 #include "oct-py-object.h"
+#include "oct-py-sparse.h"
+#include "oct-py-stats.h"
+#include "oct-py-trace.h"
 #include "oct-py-types.h"
 #include "oct-py-util.h"
 
@@ -148,16 +155,19 @@ namespace pythonic
     if (len > 0)
       {
         // create a byte buffer containing a copy of the array binary data
+        py_stats_add_bytes (len);
         const char *cdata = reinterpret_cast<const char *> (data);
         python_object buf = PyBytes_FromStringAndSize (cdata, len);
         if (! buf)
           throw std::bad_alloc ();
 
-        PyObject *frombytes = (PyObject_HasAttrString (array, "frombytes") ?
-                               PyObject_GetAttrString (array, "frombytes") :
-                               PyObject_GetAttrString (array, "fromstring"));
-        python_object args = PyTuple_Pack (1, buf.release ());
-        py_call_function (frombytes, args);
+        python_object frombytes = (PyObject_HasAttrString (array, "frombytes") ?
+                                   PyObject_GetAttrString (array, "frombytes") :
+                                   PyObject_GetAttrString (array, "fromstring"));
+        if (! frombytes)
+          error_python_exception ();
+        python_object args = PyTuple_Pack (1, static_cast<PyObject *> (buf));
+        python_object res = py_call_function (frombytes, args);
       }
 
     return array.release ();
@@ -349,23 +359,203 @@ namespace pythonic
   PyObject *
   make_py_dict (const octave_scalar_map& map)
   {
-    PyObject *dict = PyDict_New ();
+    python_object dict = PyDict_New ();
     if (! dict)
       throw std::bad_alloc ();
 
     for (auto p = map.begin (); p != map.end (); ++p)
       {
-        PyObject *key = make_py_str (map.key (p));
+        python_object key = make_py_str (map.key (p));
         if (! key)
           throw std::bad_alloc ();
 
-        PyObject *item = py_implicitly_convert_argument (map.contents (p));
+        python_object item = py_implicitly_convert_argument (map.contents (p));
 
         if (PyDict_SetItem (dict, key, item) < 0)
           error_python_exception ();
       }
 
-    return dict;
+    return dict.release ();
+  }
+
+  bool
+  py_is_dataframe (PyObject *obj)
+  {
+    // Only look for a DataFrame if pandas has already been imported
+    PyObject *pandas = PyDict_GetItemString (PyImport_GetModuleDict (),
+                                             "pandas");
+    if (! pandas)
+      return false;
+
+    python_object type = PyObject_GetAttrString (pandas, "DataFrame");
+    if (! type)
+      {
+        PyErr_Clear ();
+        return false;
+      }
+
+    return py_isinstance (obj, type);
+  }
+
+  // Convert a list of Python objects into a column cell array.  Strings are
+  // decoded directly from their UTF-8 representation.
+
+  static Cell
+  extract_py_column_cell (PyObject *list)
+  {
+    Py_ssize_t n = PyList_GET_SIZE (list);
+    Cell retval (dim_vector (n, 1));
+
+    for (Py_ssize_t i = 0; i < n; i++)
+      {
+        PyObject *item = PyList_GET_ITEM (list, i);
+        if (PyBytes_Check (item) || PyUnicode_Check (item))
+          retval(i) = extract_py_str (item);
+        else
+          retval(i) = py_implicitly_convert_return_value (item);
+      }
+
+    return retval;
+  }
+
+  static octave_value
+  extract_py_column (PyObject *series)
+  {
+    python_object values = PyObject_GetAttrString (series, "values");
+    if (! values)
+      error_python_exception ();
+
+    // Numeric and boolean NumPy arrays are copied from their buffer
+    python_object dtype = PyObject_GetAttrString (values, "dtype");
+    python_object kind = dtype ? PyObject_GetAttrString (dtype, "kind")
+                               : nullptr;
+    if (! kind)
+      PyErr_Clear ();
+    else if (py_is_buffer (values)
+             && extract_py_str (kind).find_first_of ("biufc") == 0)
+      {
+        octave_value col = extract_py_buffer (values);
+        return col.reshape (dim_vector (col.numel (), 1));
+      }
+
+    python_object list = PyObject_CallMethod (values, "tolist", nullptr);
+    if (! list || ! PyList_Check (static_cast<PyObject *> (list)))
+      error_python_exception ();
+
+    return extract_py_column_cell (list);
+  }
+
+  octave_scalar_map
+  extract_py_dataframe (PyObject *obj)
+  {
+    if (! obj)
+      error_conversion_invalid_python_object ("an Octave struct");
+
+    if (! py_is_dataframe (obj))
+      error_conversion_mismatch_python_type ("an Octave struct", "DataFrame");
+
+    octave_scalar_map map;
+
+    python_object items = PyObject_CallMethod (obj, "items", nullptr);
+    python_object it = items ? PyObject_GetIter (items) : nullptr;
+    if (! it)
+      error_python_exception ();
+
+    while (python_object item = PyIter_Next (it))
+      {
+        PyObject *name = PyTuple_GetItem (item, 0);
+        PyObject *series = PyTuple_GetItem (item, 1);
+        if (! (name && series))
+          error_python_exception ();
+
+        python_object str = PyObject_Str (name);
+        if (! str)
+          error_python_exception ();
+
+        map.setfield (extract_py_str (str), extract_py_column (series));
+      }
+
+    if (PyErr_Occurred ())
+      error_python_exception ();
+
+    return map;
+  }
+
+  PyObject *
+  make_py_dataframe (const octave_scalar_map& map)
+  {
+    string_vector names = map.fieldnames ();
+    octave_idx_type nfields = names.numel ();
+    octave_idx_type nrows = -1;
+
+    for (octave_idx_type i = 0; i < nfields; i++)
+      {
+        octave_value value = map.getfield (names(i));
+
+        if (! ((value.isnumeric () || value.islogical () || value.iscell ())
+               && ! value.issparse ()
+               && value.ndims () == 2
+               && (value.rows () <= 1 || value.columns () <= 1)))
+          error ("unable to convert field \"%s\" to a DataFrame column, "
+                 "must be a numeric, logical, or cell vector",
+                 names(i).c_str ());
+
+        if (nrows < 0)
+          nrows = value.numel ();
+        else if (value.numel () != nrows)
+          error ("unable to convert struct to a DataFrame, all fields must "
+                 "have the same number of elements");
+      }
+
+    python_object asarray = py_find_function ("numpy", "asarray");
+    python_object dataframe = py_find_function ("pandas", "DataFrame");
+    if (! (asarray && dataframe))
+      {
+        PyErr_Clear ();
+        error ("unable to convert struct to a DataFrame, "
+               "pandas is not available");
+      }
+
+    python_object dict = PyDict_New ();
+    python_object columns = PyList_New (nfields);
+    if (! (dict && columns))
+      throw std::bad_alloc ();
+
+    for (octave_idx_type i = 0; i < nfields; i++)
+      {
+        octave_value value = map.getfield (names(i));
+
+        python_object col;
+        if (value.iscell ())
+          {
+            Cell cell = value.cell_value ();
+            col = python_object (PyList_New (nrows));
+            if (! col)
+              throw std::bad_alloc ();
+            for (octave_idx_type j = 0; j < nrows; j++)
+              PyList_SET_ITEM (static_cast<PyObject *> (col), j,
+                               py_implicitly_convert_argument (cell(j)));
+          }
+        else
+          {
+            python_object buf = make_py_buffer (value);
+            python_object args = PyTuple_Pack (1, static_cast<PyObject *> (buf));
+            col = python_object (py_call_function (asarray, args));
+          }
+
+        python_object name = make_py_str (names(i));
+        if (! name || PyDict_SetItem (dict, name, col) < 0)
+          error_python_exception ();
+        PyList_SET_ITEM (static_cast<PyObject *> (columns), i, name.release ());
+      }
+
+    python_object args = PyTuple_Pack (1, static_cast<PyObject *> (dict));
+    python_object kwargs = PyDict_New ();
+    if (! (args && kwargs)
+        || PyDict_SetItemString (kwargs, "columns", columns) < 0)
+      error_python_exception ();
+
+    return py_call_function (dataframe, args, kwargs);
   }
 
   int64_t
@@ -447,17 +637,119 @@ namespace pythonic
       error ("unable to convert multidimensional cell array to a Python tuple");
 
     octave_idx_type size = cell.numel ();
-    PyObject *tuple = PyTuple_New (size);
+    python_object tuple = PyTuple_New (size);
     if (! tuple)
       throw std::bad_alloc ();
 
+    // Strings skip the generic conversion dispatch
+    bool is_cellstr = cell.iscellstr ();
+
     for (octave_idx_type i = 0; i < size; ++i)
       {
-        PyObject *item = py_implicitly_convert_argument (cell.xelem (i));
-        PyTuple_SET_ITEM (tuple, i, item);
+        const octave_value& elem = cell.xelem (i);
+        PyObject *item = nullptr;
+        if (is_cellstr && elem.rows () <= 1)
+          item = make_py_str (elem.string_value ());
+        else
+          item = py_implicitly_convert_argument (elem);
+        if (! item)
+          error_python_exception ();
+        PyTuple_SET_ITEM (static_cast<PyObject *> (tuple), i, item);
+      }
+
+    return tuple.release ();
+  }
+
+  PyObject *
+  make_py_str_list (const charMatrix& chm)
+  {
+    octave_idx_type rows = chm.rows ();
+    octave_idx_type cols = chm.columns ();
+
+    python_object list = PyList_New (rows);
+    if (! list)
+      throw std::bad_alloc ();
+
+    // Rows are strided in column-major storage, gather each one first
+    const char *data = chm.data ();
+    std::string row (cols, '\0');
+
+    for (octave_idx_type i = 0; i < rows; ++i)
+      {
+        for (octave_idx_type j = 0; j < cols; ++j)
+          row[j] = data[i + j * rows];
+
+        PyObject *item = make_py_str (row.data (), row.size ());
+        if (! item)
+          error_python_exception ();
+        PyList_SET_ITEM (static_cast<PyObject *> (list), i, item);
+      }
+
+    return list.release ();
+  }
+
+  Cell
+  extract_py_cellstr (PyObject *obj)
+  {
+    if (! obj)
+      error_conversion_invalid_python_object ("an Octave cell array of strings");
+
+    if (PyBytes_Check (obj) || PyUnicode_Check (obj))
+      return Cell (octave_value (extract_py_str (obj)));
+
+    python_object seq = PySequence_Fast (obj, "");
+    if (! seq)
+      {
+        PyErr_Clear ();
+        error ("unable to convert Python object of type \"%s\" to an Octave "
+               "cell array of strings, object must be iterable",
+               py_object_class_name (obj).c_str ());
+      }
+
+    Py_ssize_t n = PySequence_Fast_GET_SIZE (static_cast<PyObject *> (seq));
+    PyObject **items = PySequence_Fast_ITEMS (static_cast<PyObject *> (seq));
+
+    Cell retval (dim_vector (n, 1));
+
+    for (Py_ssize_t i = 0; i < n; i++)
+      {
+        PyObject *item = items[i];
+        if (! (PyBytes_Check (item) || PyUnicode_Check (item)))
+          error ("unable to convert Python object to an Octave cell array of "
+                 "strings, item %zd is of type \"%s\"", i + 1,
+                 py_object_class_name (item).c_str ());
+
+        retval(i) = extract_py_str (item);
       }
 
-    return tuple;
+    return retval;
+  }
+
+  // Check eight bytes at a time whether a string is plain ASCII.  Compilers
+  // vectorize the word loop, which covers the bulk of long strings.
+
+  static bool
+  is_ascii (const char *data, size_t len)
+  {
+    const uint64_t high_bits = UINT64_C (0x8080808080808080);
+    size_t i = 0;
+    uint64_t acc = 0;
+
+    for (; i + sizeof (uint64_t) <= len; i += sizeof (uint64_t))
+      {
+        uint64_t word;
+        std::memcpy (&word, data + i, sizeof (uint64_t));
+        acc |= word;
+      }
+
+    if (acc & high_bits)
+      return false;
+
+    for (; i < len; i++)
+      if (static_cast<unsigned char> (data[i]) & 0x80)
+        return false;
+
+    return true;
   }
 
   std::string
@@ -471,7 +763,21 @@ namespace pythonic
     if (PyBytes_Check (obj))
       {
         retval.assign (PyBytes_AsString (obj), PyBytes_Size (obj));
+        py_stats_add_bytes (retval.size ());
       }
+#if PY_VERSION_HEX >= 0x03030000
+    else if (PyUnicode_Check (obj))
+      {
+        // Borrows the cached UTF-8 form, which is the string data itself
+        // for ASCII strings
+        Py_ssize_t len = 0;
+        const char *data = PyUnicode_AsUTF8AndSize (obj, &len);
+        if (! data)
+          error_python_exception ();
+        retval.assign (data, len);
+        py_stats_add_bytes (len);
+      }
+#else
     else if (PyUnicode_Check (obj))
       {
         python_object enc = PyUnicode_AsUTF8String (obj);
@@ -480,6 +786,7 @@ namespace pythonic
         else
           throw std::bad_alloc ();
       }
+#endif
     else
       error_conversion_mismatch_python_type ("a string value", "str");
 
@@ -487,35 +794,63 @@ namespace pythonic
   }
 
   PyObject *
-  make_py_str (const std::string& str)
+  make_py_str (const char *data, size_t len)
   {
-#if PY_VERSION_HEX >= 0x03000000
-    return PyUnicode_FromStringAndSize (str.data (), str.size ());
+    py_stats_add_bytes (len);
+
+#if PY_VERSION_HEX >= 0x03030000
+    if (is_ascii (data, len))
+      {
+        PyObject *str = PyUnicode_New (len, 127);
+        if (str)
+          std::memcpy (PyUnicode_DATA (str), data, len);
+        return str;
+      }
+    return PyUnicode_DecodeUTF8 (data, len, nullptr);
+#elif PY_VERSION_HEX >= 0x03000000
+    return PyUnicode_FromStringAndSize (data, len);
 #else
-    return PyString_FromStringAndSize (str.data (), str.size ());
+    return PyString_FromStringAndSize (data, len);
 #endif
   }
 
+  PyObject *
+  make_py_str (const std::string& str)
+  {
+    return make_py_str (str.data (), str.size ());
+  }
+
   PyObject *
   py_implicitly_convert_argument (const octave_value& value)
   {
+    py_stats_count_argument (value);
+
     if (value.isobject () && value.class_name () == "pyobject")
       return pyobject_unwrap_object (value);
-    else if (value.is_string () && value.rows () > 1)
-      error ("unable to convert multirow char array to a Python object");
+    else if (value.is_function_handle ())
+      return make_py_function (value);
+    else if (value.is_string () && value.ndims () == 2
+             && value.rows () > 1 && value.columns () > 1)
+      return make_py_str_list (value.char_matrix_value ());
     else if (value.is_string ())
       return make_py_str (value.string_value ());
+    else if (value.issparse ())
+      return make_py_sparse (value);
     else if (value.is_scalar_type ())
       return make_py_numeric_value (value);
+    else if (value.iscell () && py_lazy_conversion ())
+      return make_py_lazy_sequence (value.cell_value ());
     else if (value.iscell ())
       return make_py_tuple (value.cell_value ());
     else if (value.isnumeric () && value.ndims () == 2
              && (value.columns () <= 1 || value.rows () <= 1))
       return make_py_array (value);
+    else if (value.isstruct () && value.numel () == 1 && py_lazy_conversion ())
+      return make_py_lazy_mapping (value.scalar_map_value ());
     else if (value.isstruct () && value.numel () == 1)
       return make_py_dict (value.scalar_map_value ());
-    else if (value.isstruct () && value.numel () != 1)
-      error ("unable to convert Octave struct array to a Python object");
+    else if (value.isstruct ())
+      return make_py_record_array (value.map_value ());
     else
       error ("unable to convert unhandled Octave type to a Python object");
 
@@ -525,6 +860,13 @@ namespace pythonic
   octave_value
   py_implicitly_convert_return_value (PyObject *obj)
   {
+    py_stats_timer timer (PY_STATS_CONVERSION);
+    py_stats_count_return (obj);
+
+    py_trace_scope trace ("convert return value", "conversion");
+    if (trace.active ())
+      trace.args (py_trace_summary (obj));
+
     if (PyBool_Check (obj))
       return octave_value {extract_py_bool (obj)};
 #if PY_VERSION_HEX < 0x03000000
@@ -535,8 +877,210 @@ namespace pythonic
       return octave_value {extract_py_complex (obj)};
     else if (PyFloat_Check (obj))
       return octave_value {extract_py_float (obj)};
+
+    py_stats_count_fallback ();
+    return pyobject_wrap_object (obj);
+  }
+
+  // Nesting limit guarding against self-referencing containers
+  static const int py_deep_conversion_max_depth = 1000;
+
+  static octave_value
+  py_deeply_convert (PyObject *obj, int depth);
+
+  // Large integers such as IDs are kept as Python ints instead of being
+  // rounded
+
+  bool
+  py_long_as_exact_double (PyObject *obj, double& value)
+  {
+    value = PyLong_AsDouble (obj);
+    if (value == -1.0 && PyErr_Occurred ())
+      {
+        PyErr_Clear ();
+        return false;
+      }
+
+    python_object back = PyLong_FromDouble (value);
+    int eq = back ? PyObject_RichCompareBool (obj, back, Py_EQ) : -1;
+    if (eq < 0)
+      PyErr_Clear ();
+
+    return eq == 1;
+  }
+
+  static octave_value
+  py_deeply_convert_sequence (PyObject *obj, int depth)
+  {
+    Py_ssize_t n = PySequence_Fast_GET_SIZE (obj);
+    PyObject **items = PySequence_Fast_ITEMS (obj);
+
+    // A list of only bools or only numbers becomes a row vector
+    Py_ssize_t n_bool = 0;
+    Py_ssize_t n_real = 0;
+    Py_ssize_t n_complex = 0;
+    for (Py_ssize_t i = 0; i < n; i++)
+      {
+        PyObject *item = items[i];
+        if (PyBool_Check (item))
+          n_bool++;
+        else if (PyFloat_Check (item) || PyLong_Check (item))
+          n_real++;
+        else if (PyComplex_Check (item))
+          n_complex++;
+        else
+          break;
+      }
+
+    bool all_bool = (n > 0 && n_bool == n);
+    bool all_real = (n > 0 && n_real == n);
+    bool all_number = (n > 0 && n_real + n_complex == n);
+
+    if (all_bool)
+      {
+        boolNDArray array (dim_vector (1, n));
+        for (Py_ssize_t i = 0; i < n; i++)
+          array(i) = (items[i] == Py_True);
+        return array;
+      }
+    else if (all_real)
+      {
+        NDArray array (dim_vector (1, n));
+        Py_ssize_t i = 0;
+        for (; i < n; i++)
+          {
+            if (PyLong_Check (items[i]))
+              {
+                if (! py_long_as_exact_double (items[i], array(i)))
+                  break;
+              }
+            else
+              array(i) = PyFloat_AS_DOUBLE (items[i]);
+          }
+        if (i == n)
+          return array;
+
+        // An int not exactly representable as a double, fall back to a
+        // cell array
+      }
+    else if (all_number)
+      {
+        ComplexNDArray array (dim_vector (1, n));
+        Py_ssize_t i = 0;
+        for (; i < n; i++)
+          {
+            if (PyLong_Check (items[i]))
+              {
+                double re = 0;
+                if (! py_long_as_exact_double (items[i], re))
+                  break;
+                array(i) = re;
+              }
+            else if (PyFloat_Check (items[i]))
+              array(i) = PyFloat_AS_DOUBLE (items[i]);
+            else
+              {
+                Py_complex z = PyComplex_AsCComplex (items[i]);
+                array(i) = Complex (z.real, z.imag);
+              }
+          }
+        if (i == n)
+          return array;
+      }
+
+    Cell cell (dim_vector (1, n));
+    for (Py_ssize_t i = 0; i < n; i++)
+      cell(i) = py_deeply_convert (items[i], depth + 1);
+
+    return cell;
+  }
+
+  static octave_value
+  py_deeply_convert (PyObject *obj, int depth)
+  {
+    if (depth > py_deep_conversion_max_depth)
+      error ("unable to convert Python object to Octave, "
+             "maximum nesting depth of %d exceeded",
+             py_deep_conversion_max_depth);
+
+    octave_quit ();
+
+    if (obj == Py_None)
+      return Matrix ();
+    else if (PyBool_Check (obj))
+      return octave_value {extract_py_bool (obj)};
+    else if (PyFloat_Check (obj))
+      return octave_value {extract_py_float (obj)};
+    else if (PyComplex_Check (obj))
+      return octave_value {extract_py_complex (obj)};
+    else if (PyLong_Check (obj))
+      {
+        // Keep the Python int if it cannot be converted exactly
+        double value = 0;
+        if (! py_long_as_exact_double (obj, value))
+          return pyobject_wrap_object (obj);
+        return octave_value {value};
+      }
+    else if (PyBytes_Check (obj) || PyUnicode_Check (obj))
+      return octave_value {extract_py_str (obj)};
+    else if (PyDict_Check (obj))
+      {
+        octave_scalar_map map;
+
+        Py_ssize_t pos = 0;
+        PyObject *py_key = nullptr;
+        PyObject *py_value = nullptr;
+
+        while (PyDict_Next (obj, &pos, &py_key, &py_value))
+          {
+            // A dict that cannot be a struct is kept as a Python dict
+            if (! PyBytes_Check (py_key) && ! PyUnicode_Check (py_key))
+              return pyobject_wrap_object (obj);
+
+            map.setfield (extract_py_str (py_key),
+                          py_deeply_convert (py_value, depth + 1));
+          }
+
+        return map;
+      }
+    else if (PyList_Check (obj) || PyTuple_Check (obj))
+      return py_deeply_convert_sequence (obj, depth);
+    else if (py_is_buffer (obj))
+      return extract_py_buffer (obj);
     else
       return pyobject_wrap_object (obj);
   }
 
+  octave_value
+  py_deeply_convert_return_value (PyObject *obj)
+  {
+    if (! obj)
+      error_conversion_invalid_python_object ("an Octave value");
+
+    return py_deeply_convert (obj, 0);
+  }
+
+  octave_value_list
+  py_implicitly_convert_return_values (PyObject *obj, int nargout)
+  {
+    if (nargout < 2)
+      return ovl (py_implicitly_convert_return_value (obj));
+
+    if (! (PyTuple_Check (obj) || PyList_Check (obj)))
+      error ("unable to unpack Python object of type \"%s\" into %d output "
+             "values", py_object_class_name (obj).c_str (), nargout);
+
+    Py_ssize_t n = PySequence_Fast_GET_SIZE (obj);
+    if (n < nargout)
+      error ("unable to unpack Python %s of length %zd into %d output values",
+             PyTuple_Check (obj) ? "tuple" : "list", n, nargout);
+
+    // Elements past nargout are not returned, do not convert them
+    octave_value_list retval (nargout);
+    for (int i = 0; i < nargout; i++)
+      retval(i) = py_implicitly_convert_return_value (PySequence_Fast_GET_ITEM (obj, i));
+
+    return retval;
+  }
+
 }
@@ -33,9 +33,11 @@ along with Octave Pythonic; see the file COPYING.  If not, see
 class Cell;
 class FloatNDArray;
 class NDArray;
+class charMatrix;
 template <typename T> class intNDArray;
 class octave_scalar_map;
 class octave_value;
+class octave_value_list;
 
 namespace pythonic
 {
@@ -100,6 +102,37 @@ namespace pythonic
   PyObject *
   make_py_dict (const octave_scalar_map& map);
 
+  //! Check whether an object is a pandas DataFrame.
+  //!
+  //! The pandas module is not imported by this check.
+  //!
+  //! @param obj Python object
+  //! @return @c true if @a obj is a pandas DataFrame, @c false otherwise
+  bool
+  py_is_dataframe (PyObject *obj);
+
+  //! Extract an Octave scalar map of columns from a pandas DataFrame.
+  //!
+  //! Each column becomes a field containing a column vector.  Numeric and
+  //! boolean columns are copied directly from the column's buffer, string
+  //! and other object columns become cell arrays.
+  //!
+  //! @param obj pandas DataFrame object
+  //! @return Octave scalar map containing the columns of @a obj
+  octave_scalar_map
+  extract_py_dataframe (PyObject *obj);
+
+  //! Create a pandas DataFrame from an Octave scalar map of columns.
+  //!
+  //! Every field must be a vector of the same length.  Numeric and logical
+  //! vectors are passed to pandas as NumPy arrays that share the Octave
+  //! data, cell arrays become columns of Python objects.
+  //!
+  //! @param map Octave scalar map
+  //! @return pandas DataFrame object
+  PyObject *
+  make_py_dataframe (const octave_scalar_map& map);
+
   //! Extract the integer value of the given Python int or long object.
   //!
   //! @param obj Python int or long object
@@ -114,6 +147,14 @@ namespace pythonic
   uint64_t
   extract_py_uint64 (PyObject *obj);
 
+  //! Convert the given Python int to a double only if no precision is lost.
+  //!
+  //! @param obj Python int or long object
+  //! @param[out] value value of @a obj as a double
+  //! @return true if @a value is exactly equal to @a obj
+  bool
+  py_long_as_exact_double (PyObject *obj, double& value);
+
   //! Create a Python int object with the value of the given @c int32_t value.
   //!
   //! @param value integer value
@@ -187,6 +228,25 @@ namespace pythonic
   PyObject *
   make_py_tuple (const Cell& cell);
 
+  //! Create a Python list of str objects from the rows of the given Octave
+  //! char matrix.
+  //!
+  //! Each row becomes one str of the same fixed width, including any
+  //! padding.
+  //!
+  //! @param chm Octave char matrix
+  //! @return Python list object
+  PyObject *
+  make_py_str_list (const charMatrix& chm);
+
+  //! Extract an Octave cell array of strings from the given Python sequence
+  //! of str or bytes objects.
+  //!
+  //! @param obj Python str object, or iterable of str or bytes objects
+  //! @return column cell array of strings
+  Cell
+  extract_py_cellstr (PyObject *obj);
+
   //! Create a Python numeric object from the given Octave numeric or boolean
   //! scalar value.
   //!
@@ -220,6 +280,16 @@ namespace pythonic
   PyObject *
   make_py_str (const std::string& str);
 
+  //! Create a Python str object from the given UTF-8 encoded character data.
+  //!
+  //! Plain ASCII data is copied directly without decoding.
+  //!
+  //! @param data UTF-8 encoded character data
+  //! @param len length of @a data in bytes
+  //! @return Python str object
+  PyObject *
+  make_py_str (const char *data, size_t len);
+
   //! Perform an implicit conversion of the given Octave @c value to a Python
   //! argument.
   //!
@@ -266,6 +336,40 @@ namespace pythonic
   octave_value
   py_implicitly_convert_return_value (PyObject *obj);
 
+  //! Recursively convert a Python object into an Octave value.
+  //!
+  //! Unlike py_implicitly_convert_return_value, nested containers are
+  //! converted in a single pass:
+  //!
+  //! @arg @c dict with string keys to a scalar @c struct,
+  //! @arg @c list or @c tuple of only @c bool to a @c logical row vector,
+  //! @arg @c list or @c tuple of only numbers to a @c double row vector,
+  //! @arg any other @c list or @c tuple to a @c cell row vector,
+  //! @arg @c str or @c bytes to @c char,
+  //! @arg @c bool, @c int, @c float, @c complex to scalars,
+  //! @arg @c None to an empty matrix,
+  //! @arg objects exporting a buffer to numeric arrays.
+  //!
+  //! Any other object, including an @c int too large for a @c double, is
+  //! left unconverted and wrapped as with py_implicitly_convert_return_value.
+  //!
+  //! @param obj Python object
+  //! @return Octave value
+  octave_value
+  py_deeply_convert_return_value (PyObject *obj);
+
+  //! Convert a Python tuple or list into multiple Octave return values.
+  //!
+  //! The first @a nargout elements of @a obj are converted with
+  //! py_implicitly_convert_return_value in a single pass.  If @a nargout is
+  //! less than 2, @a obj is converted as a single value instead.
+  //!
+  //! @param obj Python object
+  //! @param nargout number of requested return values
+  //! @return list of Octave values
+  octave_value_list
+  py_implicitly_convert_return_values (PyObject *obj, int nargout);
+
 }
 
 #endif
@@ -28,6 +28,10 @@ along with Octave Pythonic; see the file COPYING.  If not, see
 #endif
 
 #include <Python.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <unordered_map>
 #include <vector>
 #include <octave/oct-map.h>
 #include <octave/oct.h>
@@ -35,6 +39,8 @@ along with Octave Pythonic; see the file COPYING.  If not, see
 
 #include "oct-py-error.h"
 #include "oct-py-object.h"
+#include "oct-py-stats.h"
+#include "oct-py-trace.h"
 #include "oct-py-types.h"
 #include "oct-py-util.h"
 
@@ -90,7 +96,10 @@ namespace pythonic
       {
         PyObject *func = py_find_function ("__main__", name);
         if (! func)
-          func = py_find_function (py_builtins_module (), name);
+          {
+            python_object builtins = py_builtins_module ();
+            func = py_find_function (builtins, name);
+          }
         return func;
       }
     else
@@ -141,9 +150,9 @@ namespace pythonic
 
         python_object name;
         if (PyObject_HasAttrString (type, "__qualname__"))
-          name = PyObject_GetAttrString (type, "__qualname__");
+          name = python_object (PyObject_GetAttrString (type, "__qualname__"));
         else
-          name = PyObject_GetAttrString (type, "__name__");
+          name = python_object (PyObject_GetAttrString (type, "__name__"));
 
         std::string mod_str = !mod.is_none () ? extract_py_str (mod) : "";
         std::string name_str = name ? extract_py_str (name) : "";
@@ -157,6 +166,17 @@ namespace pythonic
     return retval;
   }
 
+  // Age and number of lookups of each object in the store, kept here so
+  // that looking up an object does not have to modify the store itself
+
+  struct objstore_entry_info
+  {
+    std::chrono::steady_clock::time_point created;
+    uint64_t accesses;
+  };
+
+  static std::unordered_map<uint64_t, objstore_entry_info> objstore_info;
+
   // FIXME: could make this into a class/singleton wrapper a la Octave core
   PyObject *objstore = nullptr;
 
@@ -192,20 +212,183 @@ namespace pythonic
   {
     python_object store = py_objstore ();
     PyDict_Clear (store);
+    objstore_info.clear ();
+    py_stats_objstore_size (PyDict_Size (store));
     store.release ();
   }
 
+  void
+  py_objstore_reset ()
+  {
+    Py_CLEAR (objstore);
+  }
+
+  // Return the number of bytes of data held by an object, the size of its
+  // buffer if it has one, otherwise the size reported by sys.getsizeof
+
+  static std::size_t
+  py_object_nbytes (PyObject *obj)
+  {
+    if (PyObject_CheckBuffer (obj))
+      {
+        Py_buffer view;
+        if (PyObject_GetBuffer (obj, &view, PyBUF_FULL_RO) == 0)
+          {
+            std::size_t nbytes = view.len;
+            PyBuffer_Release (&view);
+            return nbytes;
+          }
+        PyErr_Clear ();
+      }
+
+    PyObject *getsizeof = PySys_GetObject ("getsizeof");
+    python_object size;
+    if (getsizeof)
+      size = python_object (PyObject_CallFunctionObjArgs (getsizeof, obj,
+                                                          nullptr));
+    Py_ssize_t nbytes = size ? PyLong_AsSsize_t (size) : -1;
+    if (nbytes < 0)
+      {
+        PyErr_Clear ();
+        return 0;
+      }
+    return nbytes;
+  }
+
+  static std::string
+  py_object_type_name (PyObject *obj)
+  {
+    PyObject *type = reinterpret_cast<PyObject *> (Py_TYPE (obj));
+    python_object name = PyObject_GetAttrString (type, "__name__");
+    if (name && PyUnicode_Check (name))
+      return PyUnicode_AsUTF8 (name);
+    PyErr_Clear ();
+    return Py_TYPE (obj)->tp_name;
+  }
+
+  // Bounded repr for object snippets.  reprlib limits the size of the
+  // representation of the containers it knows, but calls the full repr of
+  // any other object before cutting it, so objects with more than maxsize
+  // bytes or items are described by their type and size instead.
+
+  static const char *py_snippet_source = R"py(
+import reprlib
+
+
+class _SnippetRepr(reprlib.Repr):
+
+    maxsize = 10000
+
+    def repr_instance(self, x, level):
+        size = _size(x)
+        if size > self.maxsize:
+            return "<%s of size %d>" % (type(x).__name__, size)
+        return reprlib.Repr.repr_instance(self, x, level)
+
+
+def _size(x):
+    try:
+        return int(x.nbytes)
+    except Exception:
+        pass
+    try:
+        return memoryview(x).nbytes
+    except Exception:
+        pass
+    try:
+        return len(x)
+    except Exception:
+        return 0
+
+
+_r = _SnippetRepr()
+_r.maxstring = _r.maxother = _r.maxlong = 200
+snippet = _r.repr
+)py";
+
+  // Return a short representation of an object.  Strings are shown as they
+  // are up to a fixed length, bytes are cut to that length before calling
+  // repr, and other objects are shown with the bounded repr above, so that
+  // listing the object store does not take time proportional to all of its
+  // data.
+
+  static std::string
+  py_object_snippet (PyObject *obj)
+  {
+    const Py_ssize_t maxlen = 1000;
+
+    if (PyUnicode_Check (obj))
+      {
+        Py_ssize_t len = PyUnicode_GetLength (obj);
+        if (len <= maxlen)
+          return extract_py_str (obj);
+        python_object head = PyUnicode_Substring (obj, 0, maxlen - 3);
+        if (! head)
+          {
+            PyErr_Clear ();
+            return "<failed to extract string>";
+          }
+        return extract_py_str (head) + "...";
+      }
+
+    if ((PyBytes_Check (obj) || PyByteArray_Check (obj))
+        && PyObject_Length (obj) > maxlen)
+      {
+        python_object head = PySequence_GetSlice (obj, 0, maxlen);
+        python_object str = head ? PyObject_Repr (head) : nullptr;
+        if (! str)
+          {
+            PyErr_Clear ();
+            return "<failed to extract string>";
+          }
+        return extract_py_str (str) + "...";
+      }
+
+    static PyObject *repr = nullptr;
+
+    if (! repr)
+      {
+        python_object ns = PyDict_New ();
+        python_object res;
+        if (ns && PyDict_SetItemString (ns, "__builtins__",
+                                        PyEval_GetBuiltins ()) == 0)
+          res = python_object (PyRun_String (py_snippet_source, Py_file_input,
+                                             ns, ns));
+        if (res)
+          {
+            repr = PyDict_GetItemString (ns, "snippet");
+            Py_XINCREF (repr);
+          }
+        if (! repr)
+          {
+            PyErr_Clear ();
+            return "<failed to extract string>";
+          }
+      }
+
+    python_object str = PyObject_CallFunctionObjArgs (repr, obj, nullptr);
+    if (! str || ! PyUnicode_Check (str))
+      {
+        PyErr_Clear ();
+        return "<failed to extract string>";
+      }
+
+    return PyUnicode_AsUTF8 (str);
+  }
+
   octave_map
   py_objstore_list ()
   {
     python_object store = py_objstore ();
 
-    std::vector<std::string> fields { "key", "count", "type", "value" };
+    std::vector<std::string> fields { "key", "count", "type", "value",
+                                      "bytes", "age", "accesses" };
 
     Py_ssize_t sz = PyDict_Size (store);
 
     octave_map map { dim_vector (sz, 1), string_vector (fields) };
 
+    auto now = std::chrono::steady_clock::now ();
     octave_idx_type idx = 0;
     Py_ssize_t pos = 0;
     PyObject *key_obj, *tuple;
@@ -215,49 +398,27 @@ namespace pythonic
         if (! tuple || ! PyTuple_Check (tuple))
           continue;
 
-        uint64_t key = PyLong_AsUnsignedLong (key_obj);
-        uint64_t count = PyLong_AsUnsignedLong (PyTuple_GetItem (tuple, 0));
+        uint64_t key = PyLong_AsUnsignedLongLong (key_obj);
+        uint64_t count = PyLong_AsUnsignedLongLong (PyTuple_GetItem (tuple, 0));
         PyObject *value = PyTuple_GetItem (tuple, 1);
 
-        PyObject *valtype = PyObject_Type (value);
-        PyObject *valtypename = PyObject_Str (PyObject_GetAttrString (valtype, "__name__"));
-#if PY_VERSION_HEX >= 0x03000000
-        std::string valtypestr = PyUnicode_AsUTF8 (valtypename);
-#else
-        std::string valtypestr = PyString_AsString (valtypename);
-#endif
-        Py_DECREF (valtype);
-        Py_DECREF (valtypename);
-
-        std::string s;
-        if (false)
-          // FIXME: http://gitlab.com/mtmiller/octave-pythonic/issues/51
-          s = "<large object>";
-        else
+        double age = 0;
+        double accesses = 0;
+        auto info = objstore_info.find (key);
+        if (info != objstore_info.end ())
           {
-            PyObject *valuestr = PyObject_Str (value);
-            if (! valuestr)
-              s = "<failed to extract string>";
-            else
-              {
-#if PY_VERSION_HEX >= 0x03000000
-                s = PyUnicode_AsUTF8 (valuestr);
-#else
-                s = PyString_AsString (valuestr);
-#endif
-                Py_DECREF (valuestr);
-                if (s.empty ())
-                  s = "<failed to extract string>";
-                if (s.length() > 1000)
-                  s = s.substr (0, 1000-3) + "...";
-              }
+            age = std::chrono::duration<double> (now - info->second.created).count ();
+            accesses = info->second.accesses;
           }
 
         octave_scalar_map entry { string_vector (fields) };
         entry.setfield ("key", octave_uint64 (key));
         entry.setfield ("count", octave_uint64 (count));
-        entry.setfield ("type", valtypestr);
-        entry.setfield ("value", s);
+        entry.setfield ("type", py_object_type_name (value));
+        entry.setfield ("value", py_object_snippet (value));
+        entry.setfield ("bytes", static_cast<double> (py_object_nbytes (value)));
+        entry.setfield ("age", age);
+        entry.setfield ("accesses", accesses);
         map.fast_elem_insert (idx++, entry);
       }
 
@@ -266,6 +427,77 @@ namespace pythonic
     return map;
   }
 
+  octave_scalar_map
+  py_objstore_stats ()
+  {
+    python_object store = py_objstore ();
+
+    struct type_usage
+    {
+      std::size_t count = 0;
+      std::size_t bytes = 0;
+    };
+
+    std::map<std::string, type_usage> types;
+    std::size_t entries = 0;
+    std::size_t references = 0;
+    std::size_t bytes = 0;
+
+    Py_ssize_t pos = 0;
+    PyObject *key_obj, *tuple;
+
+    while (PyDict_Next (store, &pos, &key_obj, &tuple))
+      {
+        if (! tuple || ! PyTuple_Check (tuple))
+          continue;
+
+        PyObject *value = PyTuple_GetItem (tuple, 1);
+        std::size_t nbytes = py_object_nbytes (value);
+
+        type_usage& usage = types[py_object_type_name (value)];
+        usage.count++;
+        usage.bytes += nbytes;
+
+        entries++;
+        references += PyLong_AsSize_t (PyTuple_GetItem (tuple, 0));
+        bytes += nbytes;
+      }
+
+    store.release ();
+
+    // Types using the most memory first
+    std::vector<std::pair<std::string, type_usage>> sorted (types.begin (),
+                                                            types.end ());
+    std::stable_sort (sorted.begin (), sorted.end (),
+                      [] (const std::pair<std::string, type_usage>& a,
+                          const std::pair<std::string, type_usage>& b)
+                      { return a.second.bytes > b.second.bytes; });
+
+    octave_idx_type n = sorted.size ();
+    Cell names (dim_vector (n, 1));
+    Cell counts (dim_vector (n, 1));
+    Cell sizes (dim_vector (n, 1));
+    for (octave_idx_type i = 0; i < n; i++)
+      {
+        names(i) = sorted[i].first;
+        counts(i) = static_cast<double> (sorted[i].second.count);
+        sizes(i) = static_cast<double> (sorted[i].second.bytes);
+      }
+
+    octave_map by_type (dim_vector (n, 1));
+    by_type.setfield ("name", names);
+    by_type.setfield ("count", counts);
+    by_type.setfield ("bytes", sizes);
+
+    octave_scalar_map map;
+    map.setfield ("entries", static_cast<double> (entries));
+    map.setfield ("references", static_cast<double> (references));
+    map.setfield ("bytes", static_cast<double> (bytes));
+    map.setfield ("peak", static_cast<double> (py_stats_objstore_peak ()));
+    map.setfield ("types", by_type);
+    return map;
+  }
+
   void
   py_objstore_drop (uint64_t key)
   {
@@ -280,18 +512,23 @@ namespace pythonic
             if (count > 1)
               {
                 PyObject *obj = PyTuple_GetItem (tuple, 1);
-                tuple = PyTuple_Pack (2, make_py_int (count - 1), obj);
+                python_object count_obj = make_py_int (count - 1);
+                tuple = PyTuple_Pack (2, static_cast<PyObject *> (count_obj), obj);
                 PyDict_SetItem (store, key_obj, tuple);
                 Py_DECREF (tuple);
               }
             else
-              PyDict_DelItem (store, key_obj);
+              {
+                PyDict_DelItem (store, key_obj);
+                objstore_info.erase (key);
+              }
           }
       }
     else
       {
         // FIXME: surely this is an error?
       }
+    py_stats_objstore_size (PyDict_Size (store));
     store.release ();
   }
 
@@ -303,7 +540,12 @@ namespace pythonic
     PyObject *tuple = PyDict_GetItem (store, key_obj);
     PyObject *obj = nullptr;
     if (tuple && PyTuple_Check (tuple))
-      obj = PyTuple_GetItem (tuple, 1);
+      {
+        obj = PyTuple_GetItem (tuple, 1);
+        auto info = objstore_info.find (key);
+        if (info != objstore_info.end ())
+          info->second.accesses++;
+      }
     store.release ();
     if (obj)
       Py_INCREF (obj);
@@ -322,17 +564,21 @@ namespace pythonic
         if (tuple && PyTuple_Check (tuple))
           {
             uint64_t count = PyLong_AsLong (PyTuple_GetItem (tuple, 0));
-            tuple = PyTuple_Pack (2, make_py_int (count + 1), obj);
+            python_object count_obj = make_py_int (count + 1);
+            tuple = PyTuple_Pack (2, static_cast<PyObject *> (count_obj), obj);
             PyDict_SetItem (store, key_obj, tuple);
             Py_DECREF (tuple);
           }
       }
     else
       {
-        PyObject *tuple = PyTuple_Pack (2, make_py_int (1), obj);
+        python_object count_obj = make_py_int (1);
+        PyObject *tuple = PyTuple_Pack (2, static_cast<PyObject *> (count_obj), obj);
         PyDict_SetItem (store, key_obj, tuple);
         Py_DECREF (tuple);
+        objstore_info[key] = { std::chrono::steady_clock::now (), 0 };
       }
+    py_stats_objstore_size (PyDict_Size (store));
     store.release ();
     return key;
   }
@@ -340,6 +586,10 @@ namespace pythonic
   octave_value
   pyobject_wrap_object (PyObject *obj)
   {
+    py_trace_scope trace ("wrap", "conversion");
+    if (trace.active ())
+      trace.args (py_trace_summary (obj));
+
     uint64_t key = py_objstore_put (obj);
     octave_value_list out = octave::feval ("pyobject", ovl (33554431.0, octave_uint64 (key)), 1);
     return out(0);
@@ -350,6 +600,7 @@ namespace pythonic
   {
     if (value.isobject () && value.class_name () == "pyobject")
       {
+        py_trace_scope trace ("unwrap", "conversion");
         octave_value_list out = octave::feval ("id", ovl (value), 1);
         uint64_t key = out(0).uint64_scalar_value ();
         return py_objstore_get (key);
@@ -364,9 +615,10 @@ namespace pythonic
     if (obj && py_object_class_name (obj) == "__main__._OctaveKwargs"
         && PyObject_HasAttrString (obj, "is_kwargs_argument"))
       {
-        PyObject *flag = PyObject_GetAttrString (obj, "is_kwargs_argument");
+        python_object flag = PyObject_GetAttrString (obj, "is_kwargs_argument");
         if (flag && PyBool_Check (flag) && PyObject_IsTrue (flag))
           return true;
+        PyErr_Clear ();
       }
     return false;
   }
@@ -374,9 +626,12 @@ namespace pythonic
   PyObject *
   update_py_dict (PyObject *dict_orig, PyObject *dict_new)
   {
-    PyObject *dict = dict_orig ? dict_orig : PyDict_New ();
-    PyDict_Update (dict, dict_new);
-    return dict;
+    python_object dict = dict_orig ? dict_orig : PyDict_New ();
+    if (dict_orig)
+      Py_INCREF (dict_orig);
+    if (! dict || PyDict_Update (dict, dict_new) < 0)
+      error_python_exception ();
+    return dict.release ();
   }
 
 }
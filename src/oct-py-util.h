@@ -30,6 +30,7 @@ along with Octave Pythonic; see the file COPYING.  If not, see
 #include <string>
 
 class octave_map;
+class octave_scalar_map;
 class octave_value;
 
 namespace pythonic
@@ -104,9 +105,36 @@ namespace pythonic
   void
   py_objstore_clear ();
 
+  //! Forget the cached reference to the object store.
+  //!
+  //! The object store is looked up again in the @c __main__ module the next
+  //! time it is used, for example in a child process after a fork.
+  void
+  py_objstore_reset ();
+
+  //! List the objects in the object store.
+  //!
+  //! Each element has the key, reference count, type name, a short
+  //! representation, the size in bytes, the age in seconds, and the number
+  //! of lookups of one object.  The representation is bounded in length,
+  //! so listing takes time proportional to the number of objects, not to
+  //! the size of their data.
+  //!
+  //! @return struct array with one element per object
   octave_map
   py_objstore_list ();
 
+  //! Return memory accounting of the object store.
+  //!
+  //! The size of an object is the size of its buffer if it has one, such
+  //! as a NumPy array, otherwise the size given by @c sys.getsizeof.
+  //!
+  //! @return scalar struct with the number of entries and references, the
+  //!         total size in bytes, the largest number of entries so far,
+  //!         and the number and size of objects of each type
+  octave_scalar_map
+  py_objstore_stats ();
+
   void
   py_objstore_drop (uint64_t key);
 
@@ -125,6 +153,11 @@ namespace pythonic
   bool
   is_py_kwargs_argument (PyObject *obj);
 
+  //! Update a dict with the items of another mapping.
+  //!
+  //! @param dict_orig dict to update, or @c nullptr to create a new dict
+  //! @param dict_new mapping whose items are added
+  //! @return new reference to the updated dict
   PyObject *
   update_py_dict (PyObject *dict_orig, PyObject *dict_new);
 
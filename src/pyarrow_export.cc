@@ -0,0 +1,107 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+#if defined (HAVE_CONFIG_H)
+#  include <config.h>
+#endif
+
+#include <Python.h>
+#include <octave/oct.h>
+
+#include "oct-py-arrow.h"
+#include "oct-py-init.h"
+#include "oct-py-object.h"
+#include "oct-py-stats.h"
+#include "oct-py-util.h"
+
+DEFUN_DLD (pyarrow_export, args, ,
+           R"doc(-*- texinfo -*-
+@deftypefn {} {@var{obj} =} pyarrow_export (@var{x})
+Export an Octave value as Arrow data.
+
+Return a Python object that implements the Arrow PyCapsule interface for
+the value @var{x}, so that it can be passed to any consumer of the Arrow
+C Data Interface, such as @code{pyarrow.array}, @code{pyarrow.record_batch},
+or @code{polars.DataFrame}.
+
+@var{x} may be a real numeric or logical vector, a cell array of strings,
+or a scalar struct whose fields are all such vectors with the same number
+of elements.  A struct is exported as an Arrow struct array, which
+consumers can use as a record batch.  Numeric data is shared with the
+consumer without being copied.
+
+Examples:
+@example
+@group
+a = py.pyarrow.array (pyarrow_export ([1, 2, 3]));
+s = struct ("x", [1; 2; 3], "name", @{@{"a"; "b"; "c"@}@});
+rb = py.pyarrow.record_batch (pyarrow_export (s));
+@end group
+@end example
+@seealso{pyarrow_import, pydataframe}
+@end deftypefn)doc")
+{
+  pythonic::py_stats_call call ("pyarrow_export");
+
+  int nargin = args.length ();
+
+  if (nargin != 1)
+    print_usage ();
+
+  pythonic::py_init ();
+
+  pythonic::python_object obj = pythonic::make_py_arrow (args(0));
+
+  return ovl (pythonic::pyobject_wrap_object (obj));
+}
+
+/*
+%!test
+%! obj = pyarrow_export ([1, 2, 3]);
+%! assert (isa (obj, "py.pythonic.OctaveArrowArray"))
+%! assert (pyarrow_import (obj), [1; 2; 3])
+
+%!test
+%! s = struct ("x", int32 ([1; 2; 3]), "b", [true; false; true], ...
+%!             "s", {{"a"; ""; "def"}});
+%! assert (pyarrow_import (pyarrow_export (s)), s)
+
+%!test
+%! if (pyeval ("__import__('importlib').util.find_spec('pyarrow') is not None"))
+%!   a = py.pyarrow.array (pyarrow_export (single ([1.5, 2.5])));
+%!   assert (char (a.type), "float")
+%!   assert (double (pycall ("len", a)), 2)
+%!   s = struct ("x", [1; 2], "name", {{"a"; "b"}});
+%!   rb = py.pyarrow.record_batch (pyarrow_export (s));
+%!   assert (char (pycall ("str", rb.schema.names)), "['x', 'name']")
+%! endif
+
+%!error pyarrow_export ()
+%!error pyarrow_export (1, 2)
+%!error <must be a real vector> pyarrow_export (ones (2, 2))
+%!error <must be a real vector> pyarrow_export ([1i, 2])
+%!error <all elements must be strings> pyarrow_export ({1, "a"})
+%!error <must be a scalar struct> pyarrow_export (struct ("a", {1, 2}))
+%!error <same number of elements> pyarrow_export (struct ("a", [1, 2], "b", 1))
+*/
@@ -0,0 +1,118 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+#if defined (HAVE_CONFIG_H)
+#  include <config.h>
+#endif
+
+#include <Python.h>
+#include <octave/oct.h>
+
+#include "oct-py-arrow.h"
+#include "oct-py-init.h"
+#include "oct-py-object.h"
+#include "oct-py-stats.h"
+#include "oct-py-util.h"
+
+DEFUN_DLD (pyarrow_import, args, ,
+           R"doc(-*- texinfo -*-
+@deftypefn {} {@var{x} =} pyarrow_import (@var{obj})
+Convert Arrow data held by a Python object to an Octave value.
+
+@var{obj} may be any Python object that implements the Arrow PyCapsule
+interface, such as a @code{pyarrow.Array}, @code{pyarrow.RecordBatch},
+@code{pyarrow.Table}, or a polars DataFrame.  The data is read through the
+Arrow C Data Interface without converting each element to a Python object.
+
+Numeric arrays become column vectors of the matching Octave type, boolean
+arrays become logical column vectors, and string arrays become cell arrays
+of strings.  Struct arrays, record batches, and tables become a scalar
+struct with one field per column.  Null values become @code{NaN} in
+floating point arrays, integer arrays with nulls are converted to
+@code{double}, and null strings become empty strings.  Temporal arrays
+are returned as their underlying integer values.
+
+Examples:
+@example
+@group
+a = py.pyarrow.array (@{1, 2, py.None@});
+pyarrow_import (a)
+  @result{}
+       1
+       2
+     NaN
+@end group
+@end example
+@seealso{pyarrow_export}
+@end deftypefn)doc")
+{
+  pythonic::py_stats_call call ("pyarrow_import");
+
+  int nargin = args.length ();
+
+  if (nargin != 1)
+    print_usage ();
+
+  pythonic::py_init ();
+
+  pythonic::python_object obj = pythonic::pyobject_unwrap_object (args(0));
+  if (! pythonic::py_is_arrow (obj))
+    error ("pyarrow_import: OBJ must be a Python object that exports Arrow data");
+
+  return ovl (pythonic::extract_py_arrow (obj));
+}
+
+/*
+%!test
+%! assert (pyarrow_import (pyarrow_export (uint8 ([1, 2, 255]))), uint8 ([1; 2; 255]))
+%! assert (pyarrow_import (pyarrow_export ([true, false])), [true; false])
+%! assert (pyarrow_import (pyarrow_export ({"abc", "d"})), {"abc"; "d"})
+%! assert (pyarrow_import (pyarrow_export (zeros (0, 1))), zeros (0, 1))
+
+%!test
+%! if (pyeval ("__import__('importlib').util.find_spec('pyarrow') is not None"))
+%!   a = pyeval ("__import__('pyarrow').array([1, 2, None])");
+%!   assert (pyarrow_import (a), [1; 2; NaN])
+%!   a = pyeval ("__import__('pyarrow').array([1.5, None, 3.5], 'float32')");
+%!   assert (pyarrow_import (a), single ([1.5; NaN; 3.5]))
+%!   a = pyeval ("__import__('pyarrow').array(['x', None, 'yz'])");
+%!   assert (pyarrow_import (a), {"x"; ""; "yz"})
+%!   a = pyeval ("__import__('pyarrow').array(list(range(10)))[3:6]");
+%!   assert (pyarrow_import (a), int64 ([3; 4; 5]))
+%! endif
+
+%!test
+%! if (pyeval ("__import__('importlib').util.find_spec('pyarrow') is not None"))
+%!   pyexec ("import pyarrow");
+%!   t = pyeval ("pyarrow.Table.from_batches([pyarrow.record_batch({'a': [1, 2], 'b': ['x', 'y']})] * 2)");
+%!   s = pyarrow_import (t);
+%!   assert (s.a, int64 ([1; 2; 1; 2]))
+%!   assert (s.b, {"x"; "y"; "x"; "y"})
+%! endif
+
+%!error pyarrow_import ()
+%!error pyarrow_import (1, 2)
+%!error <OBJ must be a Python object that exports Arrow data> pyarrow_import (1)
+%!error <OBJ must be a Python object that exports Arrow data> pyarrow_import (pyeval ("[1, 2]"))
+*/
@@ -0,0 +1,176 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+#if defined (HAVE_CONFIG_H)
+#  include <config.h>
+#endif
+
+#include <Python.h>
+#include <octave/oct.h>
+#include <octave/Cell.h>
+
+#include "oct-py-async.h"
+#include "oct-py-error.h"
+#include "oct-py-init.h"
+#include "oct-py-object.h"
+#include "oct-py-stats.h"
+#include "oct-py-types.h"
+#include "oct-py-util.h"
+
+DEFUN_DLD (pyawait, args, ,
+           R"doc(-*- texinfo -*-
+@deftypefn  {} {@var{x} =} pyawait (@var{fut})
+@deftypefnx {} {@var{c} =} pyawait (@{@var{fut1}, @var{fut2}, @dots{}@})
+@deftypefnx {} {} pyawait (@dots{}, @var{timeout})
+Wait for asynchronous Python calls to complete and return their results.
+
+Calling a Python coroutine function with @code{pycall} schedules the
+coroutine on a background event loop and returns a future.  Many calls
+can be started this way and gathered with a single @code{pyawait}, so
+that I/O-bound work runs concurrently.  @var{fut} may also be any other
+Python awaitable object, which is scheduled on the event loop first.
+
+When called with a cell array of futures, @code{pyawait} waits for all
+of them and returns a cell array of results of the same size.  If any of
+the calls raised an exception, the first one is raised as an error.
+
+With the optional @var{timeout} in seconds, an error is raised if the
+futures are not all done in time.  The calls keep running and may be
+waited for again.
+
+Scheduled coroutines make progress while Python code is running and
+while @code{pyawait} is waiting.
+
+Examples:
+@example
+@group
+pyexec ("import asyncio");
+f = pycall ("asyncio.sleep", 0.1, 42);
+pyawait (f)
+  @result{} 42
+c = pyawait (@{pycall("asyncio.sleep", 0.2, 1), pycall("asyncio.sleep", 0.2, 2)@});
+@end group
+@end example
+@seealso{pycall}
+@end deftypefn)doc")
+{
+  pythonic::py_stats_call call ("pyawait");
+
+  octave_value_list retval;
+
+  int nargin = args.length ();
+
+  if (nargin < 1 || nargin > 2)
+    {
+      print_usage ();
+      return retval;
+    }
+
+  double timeout = -1;
+  if (nargin > 1)
+    {
+      timeout = args(1).xdouble_value ("pyawait: TIMEOUT must be a number");
+      if (! (timeout >= 0))
+        error ("pyawait: TIMEOUT must be a non-negative number");
+    }
+
+  pythonic::py_init ();
+
+  bool is_cell = args(0).iscell ();
+  Cell futs = is_cell ? args(0).cell_value () : Cell (args(0));
+
+  pythonic::python_object futures = PyList_New (futs.numel ());
+  if (! futures)
+    pythonic::error_python_exception ();
+
+  for (octave_idx_type i = 0; i < futs.numel (); i++)
+    {
+      pythonic::python_object obj = pythonic::pyobject_unwrap_object (futs(i));
+      if (! obj)
+        error ("pyawait: FUT must be a Python reference or a cell array of Python references");
+
+      PyList_SET_ITEM (static_cast<PyObject *> (futures), i,
+                       pythonic::py_async_submit (obj));
+    }
+
+  if (! pythonic::py_async_wait (futures, timeout))
+    error ("pyawait: timed out after %g seconds", timeout);
+
+  Cell results (futs.dims ());
+  for (octave_idx_type i = 0; i < futs.numel (); i++)
+    {
+      PyObject *fut = PyList_GET_ITEM (static_cast<PyObject *> (futures), i);
+      pythonic::python_object res = PyObject_CallMethod (fut, "result",
+                                                         nullptr);
+      if (! res)
+        pythonic::error_python_exception ();
+
+      results(i) = pythonic::py_implicitly_convert_return_value (res);
+    }
+
+  if (is_cell)
+    retval(0) = results;
+  else
+    retval(0) = results(0);
+
+  return retval;
+}
+
+/*
+%!test
+%! pyexec ("import asyncio");
+%! f = pycall ("asyncio.sleep", 0, 42);
+%! assert (isa (f, "pyobject"))
+%! assert (pyawait (f), 42)
+
+%!test
+%! pyexec (["import asyncio\n" ...
+%!          "async def delayed(x):\n" ...
+%!          "    await asyncio.sleep(0.2)\n" ...
+%!          "    return x"]);
+%! tic ();
+%! c = pyawait ({pycall("delayed", 1), pycall("delayed", 2), pycall("delayed", 3)});
+%! assert (c, {1, 2, 3})
+%! assert (toc () < 0.5)
+
+%!test
+%! f = pycall ("asyncio.sleep", 0, 1);
+%! assert (pyawait (f), 1)
+%! assert (pyawait (f), 1)
+
+%!error <timed out>
+%! pyawait (pycall ("asyncio.sleep", 1), 0.1)
+
+%!error <ValueError>
+%! pyexec ("async def fails(): raise ValueError('oops')");
+%! pyawait (pycall ("fails"))
+
+%!error <TypeError>
+%! pyawait (pyeval ("object()"))
+
+%!error pyawait ()
+%!error pyawait (1, 2, 3)
+%!error <must be a Python reference> pyawait (1)
+%!error <non-negative> pyawait (pyeval ("None"), -1)
+*/
@@ -29,9 +29,14 @@ along with Octave Pythonic; see the file COPYING.  If not, see
 #include <Python.h>
 #include <octave/oct.h>
 
+#include "oct-py-async.h"
 #include "oct-py-eval.h"
 #include "oct-py-init.h"
+#include "oct-py-memory.h"
 #include "oct-py-object.h"
+#include "oct-py-remote.h"
+#include "oct-py-slowlog.h"
+#include "oct-py-stats.h"
 #include "oct-py-types.h"
 #include "oct-py-util.h"
 
@@ -40,6 +45,7 @@ DEFUN_DLD (pycall, args, nargout,
 @deftypefn  {} {} pycall (@var{func})
 @deftypefnx {} {@var{x} =} pycall (@var{func})
 @deftypefnx {} {@var{x} =} pycall (@var{func}, @var{arg1}, @var{arg2}, @dots{})
+@deftypefnx {} {[@var{x1}, @var{x2}, @dots{}] =} pycall (@dots{})
 Call a Python function or callable, passing Octave values as arguments.
 
 Examples:
@@ -70,9 +76,27 @@ r = pycall (s.add, 4)
 @end group
 @end example
 
-@seealso{pyeval, pyexec}
+When called with more than one output, a tuple or list returned by the
+callable is unpacked into the output values, for example
+@example
+@group
+[q, r] = pycall ("divmod", 7, 2)
+  @result{} q = 3
+  @result{} r = 1
+@end group
+@end example
+
+If the callable is a coroutine function, the coroutine is started on a
+background event loop and a future is returned, use @code{pyawait} to
+wait for its result.
+
+@seealso{pyawait, pyeval, pyexec}
 @end deftypefn)doc")
 {
+  pythonic::py_stats_call call ("pycall");
+  pythonic::py_slowlog_call slow ("pycall");
+  pythonic::py_memory_scope memory;
+
   octave_value_list retval;
   std::string id;
 
@@ -91,16 +115,21 @@ r = pycall (s.add, 4)
   pythonic::py_init ();
 
   pythonic::python_object callable;
-  if (args(0).is_string ())
+  if (args(0).is_string () && pythonic::py_remote_enabled ())
     {
-      callable = pythonic::py_find_function (args(0).string_value ());
+      std::string name = args(0).string_value ();
+      callable = pythonic::python_object (pythonic::py_remote_find_function (name));
+    }
+  else if (args(0).is_string ())
+    {
+      callable = pythonic::python_object (pythonic::py_find_function (args(0).string_value ()));
       if (! callable)
         error ("pycall: no such Python function or callable: %s",
                args(0).string_value ().c_str ());
     }
   else
     {
-      callable = pythonic::pyobject_unwrap_object (args(0));
+      callable = pythonic::python_object (pythonic::pyobject_unwrap_object (args(0)));
       if (! callable)
         error("pycall: FUNC must be a valid Python reference");
     }
@@ -108,10 +137,18 @@ r = pycall (s.add, 4)
   octave_value_list arglist = args.slice (1, nargin - 1);
   pythonic::python_object res = pythonic::py_call_function (callable, arglist);
 
+  // Schedule a coroutine on the background event loop, return its future.
+  if (pythonic::py_async_is_coroutine (res))
+    res = pythonic::python_object (pythonic::py_async_submit (res));
+
   // Ensure reasonable "ans" behaviour, consistent with Python's "_".
-  if (nargout > 0 || ! res.is_none ())
+  if (nargout > 1)
+    retval = pythonic::py_implicitly_convert_return_values (res, nargout);
+  else if (nargout > 0 || ! res.is_none ())
     retval(0) = pythonic::py_implicitly_convert_return_value (res);
 
+  slow.finish (callable, arglist, res);
+
   return retval;
 }
 
@@ -156,9 +193,13 @@ r = pycall (s.add, 4)
 %!error (pycall ("list", {1, 2, 3; 4, 5, 6}))
 %!error (pycall ("dict", {1, 2, 3}))
 
-## Test failure to convert char arrays to strings
+## Test conversion of char matrices to lists of strings
+%!assert (char (pycall ("repr", ["hello"; "world"])), "['hello', 'world']")
+%!assert (char (pycall ("typename", ["ab"; "cd"])), "list")
+
+## Test failure to convert column char vectors to strings
 %!error (pycall ("str", ("hello")'))
-%!error (pycall ("str", ["hello"; "world"]))
+%!error (pycall ("str", repmat ("a", [2, 2, 2])))
 
 ## Test construction of dict from pyargs
 %!test
@@ -247,6 +288,72 @@ r = pycall (s.add, 4)
 %! pyexec ("def raiseException(): raise NameError('oops')")
 %! pycall ("raiseException")
 
+## Octave function handles passed as Python callables
+%!assert (pycall (pyeval ("lambda f, x: f(x)"), @(x) 2 * x, 3), 6)
+%!assert (pycall (pyeval ("lambda f: f()"), @() true), true)
+%!assert (char (pycall (pyeval ("lambda f: f('abc')"), @(s) upper (s))), "ABC")
+
+%!test
+%! f = pyeval ("lambda f: list(map(f, [1.0, 2.0, 3.0]))");
+%! assert (cellfun (@double, cell (pycall (f, @(x) x^2))), [1, 4, 9])
+
+%!test
+%! f = pyeval ("lambda f: f(__import__('array').array('d', [1, 2, 3]))");
+%! m = pycall (f, @(x) 2 * x);
+%! assert (cellfun (@double, cell (pycall ("list", m))), [2, 4, 6])
+
+%!test
+%! f = pyeval ("lambda f: f().shape");
+%! assert (char (pycall (f, @() ones (2, 3))), "(2, 3)")
+%! assert (char (pycall (f, @() ones (1, 3))), "(3,)")
+
+%!test
+%! f = pyeval ("lambda f: f(__import__('array').array('i', [1, 2]))");
+%! assert (char (pycall (f, @(x) class (x))), "int32")
+
+## Ints that a double cannot hold exactly are passed as int64 or pyobject
+%!test
+%! assert (char (pycall (pyeval ("lambda f: f(3)"), @(x) class (x))), "double")
+%! f = pyeval ("lambda f: f(2**53 + 1)");
+%! assert (char (pycall (f, @(x) class (x))), "int64")
+%! assert (pycall (f, @(x) x == int64 (2)^53 + 1), true)
+%! f = pyeval ("lambda f: f(2**64 + 1)");
+%! assert (char (pycall (f, @(x) class (x))), "py.int")
+
+%!error <oops>
+%! pycall (pyeval ("lambda f: f()"), @() error ("oops"))
+
+%!error <TypeError>
+%! pycall (pyeval ("lambda f: f(x=1)"), @(x) x)
+
+## Multiple return values
+%!test
+%! [q, r] = pycall ("divmod", 7, 2);
+%! assert ({q, r}, {3, 1})
+
+%!test
+%! [a, b, c] = pycall (pyeval ("lambda: [1.5, True, 'x']"));
+%! assert (a, 1.5)
+%! assert (b, true)
+%! assert (char (c), "x")
+
+%!test
+%! [a, b] = pycall (pyeval ("lambda: (1.0, 2.0, 3.0)"));
+%! assert ({a, b}, {1, 2})
+
+## Unused elements are not wrapped into the object store
+%!test
+%! f = pyeval ("lambda: (1.0, object(), object(), object())");
+%! n = __py_objstore_stats__ ().entries;
+%! [a, b] = pycall (f);
+%! assert (__py_objstore_stats__ ().entries, n + 1)
+
+%!error <unable to unpack Python tuple of length 1 into 2 output values>
+%! [a, b] = pycall (pyeval ("lambda: (1.0,)"));
+
+%!error <unable to unpack Python object of type "float">
+%! [a, b] = pycall ("float", 1);
+
 ## None as a return value
 %!test
 %! f = pyeval ("lambda: None");
@@ -259,4 +366,17 @@ r = pycall (s.add, 4)
 %! clear ans
 %! pycall (f);
 %! assert (! exist ("ans", "var"))
+
+## Time in Python functions is reported by the Octave profiler
+%!test
+%! if (compare_versions (OCTAVE_VERSION, "6", ">="))
+%!   profile off
+%!   profile clear
+%!   profile on
+%!   pycall ("math.sqrt", 2);
+%!   profile off
+%!   T = profile ("info");
+%!   profile clear
+%!   assert (any (strcmp ({T.FunctionTable.FunctionName}, "py:math.sqrt")))
+%! endif
 */
@@ -0,0 +1,136 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+#if defined (HAVE_CONFIG_H)
+#  include <config.h>
+#endif
+
+#include <Python.h>
+#include <octave/oct.h>
+#include <octave/oct-map.h>
+
+#include "oct-py-init.h"
+#include "oct-py-object.h"
+#include "oct-py-stats.h"
+#include "oct-py-types.h"
+#include "oct-py-util.h"
+
+DEFUN_DLD (pydataframe, args, ,
+           R"doc(-*- texinfo -*-
+@deftypefn {} {@var{df} =} pydataframe (@var{s})
+Create a pandas DataFrame from a struct of columns.
+
+Each field of the scalar struct @var{s} becomes a column of the DataFrame,
+in the same order.  All fields must be vectors with the same number of
+elements.  Numeric and logical vectors are passed to pandas as NumPy
+arrays without an intermediate Python list, and cell arrays, such as
+cell arrays of strings, become columns of Python objects.
+
+The reverse conversion is done by @code{struct}, which returns a struct
+with one column vector per column of a DataFrame.
+
+Examples:
+@example
+@group
+s = struct ("x", [1; 2; 3], "name", @{@{"a"; "b"; "c"@}@});
+df = pydataframe (s);
+t = struct (df);
+t.x
+  @result{}
+     1
+     2
+     3
+@end group
+@end example
+@seealso{pyobject}
+@end deftypefn)doc")
+{
+  pythonic::py_stats_call call ("pydataframe");
+
+  int nargin = args.length ();
+
+  if (nargin != 1)
+    print_usage ();
+
+  if (! (args(0).isstruct () && args(0).numel () == 1))
+    error ("pydataframe: S must be a scalar struct");
+
+  pythonic::py_init ();
+
+  octave_scalar_map map = args(0).scalar_map_value ();
+  pythonic::python_object df = pythonic::make_py_dataframe (map);
+
+  return ovl (pythonic::pyobject_wrap_object (df));
+}
+
+/*
+%!test
+%! if (pyeval ("__import__('importlib').util.find_spec('pandas') is not None"))
+%!   s = struct ("x", [1.5; 2.5; 3.5], "n", int32 ([1, 2, 3]), ...
+%!               "b", [true; false; true], "s", {{"a"; "bc"; "def"}});
+%!   df = pydataframe (s);
+%!   assert (isa (df, "py.pandas.core.frame.DataFrame"))
+%!   assert (char (pycall ("str", df.columns.tolist ())), "['x', 'n', 'b', 's']")
+%!   t = struct (df);
+%!   assert (t.x, s.x)
+%!   assert (t.n, s.n(:))
+%!   assert (t.b, s.b)
+%!   assert (t.s, s.s)
+%! endif
+
+%!test
+%! if (pyeval ("__import__('importlib').util.find_spec('pandas') is not None"))
+%!   df = pydataframe (struct ());
+%!   assert (double (pycall ("len", df)), 0)
+%! endif
+
+## Missing pandas is an error, not a crash
+%!test
+%! pyexec (["import sys\n" ...
+%!          "_pythonic_saved_pandas = sys.modules.get('pandas')\n" ...
+%!          "sys.modules['pandas'] = None"]);
+%! unwind_protect
+%!   msg = "";
+%!   try
+%!     pydataframe (struct ("x", 1));
+%!   catch err
+%!     msg = err.message;
+%!   end_try_catch
+%!   assert (! isempty (strfind (msg, "pandas is not available")))
+%! unwind_protect_cleanup
+%!   pyexec (["if _pythonic_saved_pandas is None:\n" ...
+%!            "    del sys.modules['pandas']\n" ...
+%!            "else:\n" ...
+%!            "    sys.modules['pandas'] = _pythonic_saved_pandas\n" ...
+%!            "del _pythonic_saved_pandas"]);
+%! end_unwind_protect
+
+%!error pydataframe ()
+%!error pydataframe (1, 2)
+%!error <S must be a scalar struct> pydataframe (1)
+%!error <S must be a scalar struct> pydataframe (struct ("a", {1, 2}))
+%!error <same number of elements> pydataframe (struct ("a", [1, 2], "b", [1, 2, 3]))
+%!error <must be a numeric, logical, or cell vector> pydataframe (struct ("a", "abc"))
+%!error <must be a numeric, logical, or cell vector> pydataframe (struct ("a", ones (2, 2)))
+*/
@@ -0,0 +1,173 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+#if defined (HAVE_CONFIG_H)
+#  include <config.h>
+#endif
+
+#include <Python.h>
+#include <octave/oct.h>
+
+#include "oct-py-buffer.h"
+#include "oct-py-init.h"
+#include "oct-py-object.h"
+#include "oct-py-stats.h"
+#include "oct-py-util.h"
+
+DEFUN_DLD (pydlpack, args, ,
+           R"doc(-*- texinfo -*-
+@deftypefn  {} {@var{obj} =} pydlpack (@var{x})
+@deftypefnx {} {@var{x} =} pydlpack (@var{obj})
+Exchange arrays with Python libraries through DLPack.
+
+If the argument is a numeric or logical Octave array @var{x}, return a
+Python object @var{obj} that exports the array with the DLPack protocol
+and the buffer protocol.  The array can be passed to the @code{from_dlpack}
+function of NumPy, PyTorch, JAX, and other libraries without copying its
+data.  The exported data must not be modified, consumers that support
+DLPack 1.0 receive it marked as read-only.
+
+If the argument is a Python object @var{obj} that implements
+@code{__dlpack__}, such as a PyTorch tensor or a NumPy array on the CPU,
+return its data as an Octave array of the matching type.  The data is
+copied once, directly from the tensor memory.  One-dimensional tensors are
+returned as row vectors.
+
+Examples:
+@example
+@group
+t = py.torch.from_dlpack (pydlpack (magic (3)));
+x = pydlpack (t.T)
+  @result{} x =
+
+     8   3   4
+     1   5   9
+     6   7   2
+
+@end group
+@end example
+@seealso{pyarrow_export, pycall}
+@end deftypefn)doc")
+{
+  pythonic::py_stats_call call ("pydlpack");
+
+  int nargin = args.length ();
+
+  if (nargin != 1)
+    print_usage ();
+
+  pythonic::py_init ();
+
+  if (args(0).isobject () && args(0).class_name () == "pyobject")
+    {
+      pythonic::python_object obj = pythonic::pyobject_unwrap_object (args(0));
+      if (! pythonic::py_is_dlpack (obj))
+        error ("pydlpack: OBJ must be a Python object that implements "
+               "__dlpack__");
+
+      return ovl (pythonic::extract_py_dlpack (obj));
+    }
+
+  if (! (args(0).isnumeric () || args(0).islogical ()) || args(0).issparse ())
+    error ("pydlpack: X must be a full numeric or logical array");
+
+  pythonic::python_object obj = pythonic::make_py_buffer (args(0));
+
+  return ovl (pythonic::pyobject_wrap_object (obj));
+}
+
+/*
+%!test
+%! x = reshape (int16 (1:24), 2, 3, 4);
+%! obj = pydlpack (x);
+%! assert (isa (obj, "py.pythonic.OctaveArray"))
+%! assert (pydlpack (obj), x)
+
+%!test
+%! assert (pydlpack (pydlpack ([1, 2, 3])), [1, 2, 3])
+%! assert (pydlpack (pydlpack ([1; 2; 3])), [1, 2, 3])
+%! assert (pydlpack (pydlpack (single (pi))), single (pi))
+%! assert (pydlpack (pydlpack ([1+2i, 3-4i])), [1+2i, 3-4i])
+%! assert (pydlpack (pydlpack ([true, false])), [true, false])
+%! assert (pydlpack (pydlpack (uint64 (2^60))), uint64 (2^60))
+
+%!test
+%! if (pyeval ("__import__('importlib').util.find_spec('numpy') is not None"))
+%!   pyexec ("import numpy");
+%!   x = [1, 2, 3; 4, 5, 6];
+%!   a = py.numpy.from_dlpack (pydlpack (x));
+%!   assert (char (pycall ("str", a.shape)), "(2, 3)")
+%!   assert (pydlpack (a), x)
+%!   assert (pydlpack (a.T), x.')
+%!   a = pyeval ("numpy.arange(12, dtype='int32').reshape(3, 4)[:, ::2]");
+%!   assert (pydlpack (a), int32 ([0, 2; 4, 6; 8, 10]))
+%! endif
+
+%!test
+%! if (pyeval ("__import__('importlib').util.find_spec('torch') is not None"))
+%!   x = magic (4);
+%!   t = py.torch.from_dlpack (pydlpack (x));
+%!   assert (pydlpack (t), x)
+%!   assert (pydlpack (t.T), x.')
+%! endif
+
+## Unversioned and copy requests get a private copy of the data
+%!test
+%! pyexec (["import ctypes\n" ...
+%!          "def _pythonic_dlpack_check(obj):\n" ...
+%!          "    get = ctypes.pythonapi.PyCapsule_GetPointer\n" ...
+%!          "    get.restype = ctypes.c_void_p\n" ...
+%!          "    get.argtypes = [ctypes.py_object, ctypes.c_char_p]\n" ...
+%!          "    shared = obj.__dlpack__(max_version=(1, 0))\n" ...
+%!          "    copied = obj.__dlpack__(max_version=(1, 0), copy=True)\n" ...
+%!          "    legacy = obj.__dlpack__()\n" ...
+%!          "    p = get(shared, b'dltensor_versioned')\n" ...
+%!          "    q = get(copied, b'dltensor_versioned')\n" ...
+%!          "    r = get(legacy, b'dltensor')\n" ...
+%!          "    flags = ctypes.c_uint64.from_address\n" ...
+%!          "    data = lambda a: ctypes.c_void_p.from_address(a).value\n" ...
+%!          "    return (flags(p + 24).value, flags(q + 24).value,\n" ...
+%!          "            data(p + 32) != data(q + 32), data(p + 32) != data(r))"]);
+%! unwind_protect
+%!   [shared, copied, copy_differs, legacy_differs] = ...
+%!     pycall ("_pythonic_dlpack_check", pydlpack ([1, 2, 3]));
+%!   assert (double (shared), 1)
+%!   assert (double (copied), 2)
+%!   assert (copy_differs)
+%!   assert (legacy_differs)
+%! unwind_protect_cleanup
+%!   pyexec ("del _pythonic_dlpack_check");
+%! end_unwind_protect
+
+%!error <can only be exported to the CPU>
+%! pycall (pycall ("getattr", pydlpack (1), "__dlpack__"), pyargs ("dl_device", {2, 0}))
+%!error <without a copy>
+%! pycall (pycall ("getattr", pydlpack (1), "__dlpack__"), pyargs ("copy", false))
+
+%!error pydlpack ()
+%!error pydlpack (1, 2)
+%!error <X must be a full numeric or logical array> pydlpack ("abc")
+%!error <X must be a full numeric or logical array> pydlpack (sparse (1))
+%!error <OBJ must be a Python object that implements __dlpack__> pydlpack (pyeval ("[1, 2]"))
+*/
@@ -31,7 +31,11 @@ along with Octave Pythonic; see the file COPYING.  If not, see
 
 #include "oct-py-eval.h"
 #include "oct-py-init.h"
+#include "oct-py-memory.h"
 #include "oct-py-object.h"
+#include "oct-py-remote.h"
+#include "oct-py-slowlog.h"
+#include "oct-py-stats.h"
 #include "oct-py-types.h"
 #include "oct-py-util.h"
 
@@ -40,12 +44,16 @@ DEFUN_DLD (pyeval, args, nargout,
 @deftypefn  {} {} pyeval (@var{expr})
 @deftypefnx {} {} pyeval (@var{expr}, @var{localns})
 @deftypefnx {} {@var{x} =} pyeval (@dots{})
+@deftypefnx {} {[@var{x1}, @var{x2}, @dots{}] =} pyeval (@dots{})
 Evaluate a Python expression and return the result.
 
 When called with an optional second argument, @var{localns} is a
 @code{py.dict} that acts as the namespace for any assignments or other
 side effects of the expression.
 
+When called with more than one output, a tuple or list result is unpacked
+into the output values.
+
 Examples:
 @example
 @group
@@ -60,6 +68,10 @@ pyeval ("dict(two=2)")
 @seealso{pycall, pyexec}
 @end deftypefn)doc")
 {
+  pythonic::py_stats_call call ("pyeval");
+  pythonic::py_slowlog_call slow ("pyeval");
+  pythonic::py_memory_scope memory;
+
   octave_value_list retval;
 
   int nargin = args.length ();
@@ -74,19 +86,25 @@ pyeval ("dict(two=2)")
 
   pythonic::py_init ();
 
-  PyObject *local_namespace = nullptr;
+  pythonic::python_object local_namespace;
   if (nargin > 1)
     {
-      local_namespace = pythonic::pyobject_unwrap_object (args(1));
+      local_namespace = pythonic::python_object (pythonic::pyobject_unwrap_object (args(1)));
       if (! local_namespace)
         error ("pyeval: NAMESPACE must be a valid Python reference");
     }
 
-  pythonic::python_object res = pythonic::py_eval_string (code, 0, local_namespace);
+  pythonic::python_object res = pythonic::py_remote_enabled ()
+    ? pythonic::py_remote_eval_string (code, local_namespace)
+    : pythonic::py_eval_string (code, 0, local_namespace);
 
-  if (nargout > 0 || ! res.is_none ())
+  if (nargout > 1)
+    retval = pythonic::py_implicitly_convert_return_values (res, nargout);
+  else if (nargout > 0 || ! res.is_none ())
     retval(0) = pythonic::py_implicitly_convert_return_value (res);
 
+  slow.finish (code, res);
+
   return retval;
 }
 
@@ -115,6 +133,10 @@ pyeval ("dict(two=2)")
 
 %!assert (isa (pyeval ("object()"), "pyobject"))
 
+%!test
+%! [a, b] = pyeval ("(1.0, 2.0)");
+%! assert ({a, b}, {1, 2})
+
 %!assert (isnumeric (double (pyeval ("__import__('sys').maxsize"))))
 %!assert (double (pyeval ("99999999999999")), 99999999999999)
 %!assert (double (pyeval ("-99999999999999")), -99999999999999)
@@ -32,6 +32,11 @@ along with Octave Pythonic; see the file COPYING.  If not, see
 
 #include "oct-py-eval.h"
 #include "oct-py-init.h"
+#include "oct-py-memory.h"
+#include "oct-py-object.h"
+#include "oct-py-remote.h"
+#include "oct-py-slowlog.h"
+#include "oct-py-stats.h"
 #include "oct-py-util.h"
 
 DEFUN_DLD (pyexec, args, ,
@@ -56,6 +61,10 @@ pyexec ("print(42)")
 @seealso{pycall, pyeval}
 @end deftypefn)doc")
 {
+  pythonic::py_stats_call call ("pyexec");
+  pythonic::py_slowlog_call slow ("pyexec");
+  pythonic::py_memory_scope memory;
+
   octave_value_list retval;
 
   int nargin = args.length ();
@@ -70,16 +79,20 @@ pyexec ("print(42)")
 
   pythonic::py_init ();
 
-  PyObject *local_namespace = nullptr;
+  pythonic::python_object local_namespace;
   if (nargin > 1)
     {
-      local_namespace = pythonic::pyobject_unwrap_object (args(1));
+      local_namespace = pythonic::python_object (pythonic::pyobject_unwrap_object (args(1)));
       if (! local_namespace)
         error ("pyexec: NAMESPACE must be a valid Python reference");
     }
 
   // FIXME: figure out exec return code:
-  pythonic::py_exec_string (code, 0, local_namespace);
+  pythonic::python_object res = pythonic::py_remote_enabled ()
+    ? pythonic::py_remote_exec_string (code, local_namespace)
+    : pythonic::py_exec_string (code, 0, local_namespace);
+
+  slow.finish (code, res);
 
   return retval;
 }
@@ -0,0 +1,299 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+#if defined (HAVE_CONFIG_H)
+#  include <config.h>
+#endif
+
+#include <Python.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <octave/oct.h>
+#include <octave/Cell.h>
+#include <octave/quit.h>
+
+#include "oct-py-error.h"
+#include "oct-py-init.h"
+#include "oct-py-object.h"
+#include "oct-py-stats.h"
+#include "oct-py-types.h"
+#include "oct-py-util.h"
+
+// Kinds of items that can be packed into a typed array, in order of
+// promotion.  Anything else is returned in a cell array.
+
+enum item_kind
+{
+  ITEM_BOOL,
+  ITEM_INT,
+  ITEM_FLOAT,
+  ITEM_COMPLEX,
+  ITEM_OTHER
+};
+
+static item_kind
+py_item_kind (PyObject *obj)
+{
+  if (PyBool_Check (obj))
+    return ITEM_BOOL;
+  else if (PyLong_Check (obj))
+    {
+      int overflow = 0;
+      PY_LONG_LONG value = PyLong_AsLongLongAndOverflow (obj, &overflow);
+      if (value == -1 && PyErr_Occurred ())
+        PyErr_Clear ();
+      return overflow ? ITEM_OTHER : ITEM_INT;
+    }
+#if PY_VERSION_HEX < 0x03000000
+  else if (PyInt_Check (obj))
+    return ITEM_INT;
+#endif
+  else if (PyFloat_Check (obj))
+    return ITEM_FLOAT;
+  else if (PyComplex_Check (obj))
+    return ITEM_COMPLEX;
+  else
+    return ITEM_OTHER;
+}
+
+static octave_value
+pack_items (std::vector<pythonic::python_object>& items, item_kind kind)
+{
+  octave_idx_type n = items.size ();
+
+  if (n == 0)
+    return NDArray (dim_vector (0, 1));
+
+  switch (kind)
+    {
+    case ITEM_BOOL:
+      {
+        boolNDArray retval (dim_vector (n, 1));
+        for (octave_idx_type i = 0; i < n; i++)
+          retval(i) = (static_cast<PyObject *> (items[i]) == Py_True);
+        return retval;
+      }
+
+    case ITEM_INT:
+      {
+        int64NDArray retval (dim_vector (n, 1));
+        for (octave_idx_type i = 0; i < n; i++)
+          retval(i) = pythonic::extract_py_int64 (items[i]);
+        return retval;
+      }
+
+    case ITEM_FLOAT:
+      {
+        NDArray retval (dim_vector (n, 1));
+        for (octave_idx_type i = 0; i < n; i++)
+          retval(i) = PyFloat_AsDouble (items[i]);
+        return retval;
+      }
+
+    case ITEM_COMPLEX:
+      {
+        ComplexNDArray retval (dim_vector (n, 1));
+        for (octave_idx_type i = 0; i < n; i++)
+          {
+            PyObject *obj = items[i];
+            retval(i) = Complex (PyComplex_RealAsDouble (obj),
+                                 PyComplex_ImagAsDouble (obj));
+          }
+        return retval;
+      }
+
+    default:
+      {
+        Cell retval (dim_vector (n, 1));
+        for (octave_idx_type i = 0; i < n; i++)
+          retval(i) = pythonic::py_implicitly_convert_return_value (items[i]);
+        return retval;
+      }
+    }
+}
+
+DEFUN_DLD (pyiter_read, args, ,
+           R"doc(-*- texinfo -*-
+@deftypefn  {} {@var{x} =} pyiter_read (@var{it})
+@deftypefnx {} {@var{x} =} pyiter_read (@var{it}, @var{n})
+@deftypefnx {} {[@var{x}, @var{done}] =} pyiter_read (@dots{})
+Read a batch of items from a Python iterator or generator.
+
+Up to @var{n} items are read from the iterator @var{it} and returned as a
+column vector.  If all items are Python @code{bool} values, @var{x} is a
+logical array.  If all items are integers, @var{x} is an @code{int64}
+array.  Mixed integers and floats are returned as a @code{double} array,
+and a @code{complex} array if any item is complex.  Any other items are
+returned in a cell array, with the same conversions as @code{pycall}
+uses for return values.
+
+If @var{n} is omitted, all remaining items are read.
+
+The second output @var{done} is true if the iterator was exhausted
+during this call, in which case @var{x} has fewer than @var{n} items.
+Reaching the end of the iterator is not an error.
+
+Examples:
+@example
+@group
+it = pyeval ("iter(range(10))");
+[x, done] = pyiter_read (it, 4);
+x'
+  @result{}   0  1  2  3
+[x, done] = pyiter_read (it, 100);
+done
+  @result{} 1
+@end group
+@end example
+@seealso{pycall}
+@end deftypefn)doc")
+{
+  pythonic::py_stats_call call ("pyiter_read");
+
+  octave_value_list retval;
+
+  int nargin = args.length ();
+
+  if (nargin < 1 || nargin > 2)
+    {
+      print_usage ();
+      return retval;
+    }
+
+  octave_idx_type n = std::numeric_limits<octave_idx_type>::max ();
+  if (nargin > 1)
+    {
+      double d = args(1).xdouble_value ("pyiter_read: N must be a number");
+      if (! (d >= 0) || (d != std::floor (d) && ! std::isinf (d)))
+        error ("pyiter_read: N must be a non-negative integer");
+      if (d < static_cast<double> (n))
+        n = static_cast<octave_idx_type> (d);
+    }
+
+  pythonic::py_init ();
+
+  pythonic::python_object it = pythonic::pyobject_unwrap_object (args(0));
+  if (! it || ! PyIter_Check (static_cast<PyObject *> (it)))
+    error ("pyiter_read: IT must be a Python iterator");
+
+  // Only reserve a small chunk up front, N may be much larger than the
+  // number of items left in the iterator
+  std::vector<pythonic::python_object> items;
+  items.reserve (std::min<octave_idx_type> (n, 1024));
+
+  item_kind kind = ITEM_BOOL;
+  bool done = false;
+
+  while (static_cast<octave_idx_type> (items.size ()) < n)
+    {
+      octave_quit ();
+
+      pythonic::python_object item = PyIter_Next (it);
+      if (! item)
+        {
+          if (PyErr_Occurred ())
+            pythonic::error_python_exception ();
+          done = true;
+          break;
+        }
+
+      item_kind k = py_item_kind (item);
+      if (k > kind)
+        kind = k;
+
+      items.push_back (item);
+    }
+
+  retval(1) = done;
+  retval(0) = pack_items (items, kind);
+
+  return retval;
+}
+
+/*
+%!test
+%! it = pyeval ("iter(range(10))");
+%! [x, done] = pyiter_read (it, 4);
+%! assert (x, int64 ([0; 1; 2; 3]))
+%! assert (done, false)
+%! [x, done] = pyiter_read (it, 4);
+%! assert (x, int64 ([4; 5; 6; 7]))
+%! assert (done, false)
+%! [x, done] = pyiter_read (it, 4);
+%! assert (x, int64 ([8; 9]))
+%! assert (done, true)
+%! [x, done] = pyiter_read (it, 4);
+%! assert (size (x), [0, 1])
+%! assert (done, true)
+
+%!test
+%! it = pyeval ("iter(range(3))");
+%! [x, done] = pyiter_read (it, 1e18);
+%! assert (x, int64 ([0; 1; 2]))
+%! assert (done, true)
+
+%!test
+%! it = pyeval ("(x / 2 for x in range(5))");
+%! assert (pyiter_read (it), [0; 0.5; 1; 1.5; 2])
+
+%!test
+%! it = pyeval ("iter([1, 2.5, 3])");
+%! assert (pyiter_read (it), [1; 2.5; 3])
+
+%!test
+%! it = pyeval ("iter([True, False])");
+%! assert (pyiter_read (it), [true; false])
+
+%!test
+%! it = pyeval ("iter([1j, 2])");
+%! assert (pyiter_read (it), [1j; 2])
+
+%!test
+%! it = pyeval ("iter([1.5, 'a', None])");
+%! x = pyiter_read (it);
+%! assert (iscell (x))
+%! assert (size (x), [3, 1])
+%! assert (x{1}, 1.5)
+%! assert (char (x{2}), "a")
+%! assert (__py_is_none__ (x{3}))
+
+%!test
+%! it = pyeval ("iter([2**100])");
+%! x = pyiter_read (it);
+%! assert (iscell (x))
+
+%!assert (pyiter_read (pyeval ("iter([1.0])"), 0), zeros (0, 1))
+
+%!error <ZeroDivisionError>
+%! it = pyeval ("(1 / x for x in [1, 0])");
+%! pyiter_read (it)
+
+%!error pyiter_read ()
+%!error pyiter_read (1, 2, 3)
+%!error <IT must be a Python iterator> pyiter_read (pyeval ("[1, 2, 3]"))
+%!error <N must be a non-negative integer> pyiter_read (pyeval ("iter([])"), -1)
+%!error <N must be a non-negative integer> pyiter_read (pyeval ("iter([])"), 1.5)
+*/
@@ -0,0 +1,88 @@
+## Copyright (C) 2019 Mike Miller
+## SPDX-License-Identifier: GPL-3.0-or-later
+##
+## This file is part of Octave Pythonic.
+##
+## Octave Pythonic is free software: you can redistribute it and/or modify
+## it under the terms of the GNU General Public License as published by
+## the Free Software Foundation, either version 3 of the License, or
+## (at your option) any later version.
+##
+## Octave Pythonic is distributed in the hope that it will be useful,
+## but WITHOUT ANY WARRANTY; without even the implied warranty of
+## MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+## GNU General Public License for more details.
+##
+## You should have received a copy of the GNU General Public License
+## along with Octave Pythonic; see the file COPYING.  If not, see
+## <https://www.gnu.org/licenses/>.
+
+## Repeated operations must not leak Python objects.  Each operation is run
+## many times, and the number of allocated Python memory blocks, and the
+## total reference count on debug builds of Python, must not grow with the
+## number of calls.  Build with "make AUDIT=1" to also see the change per
+## function in "pythonic stats".
+
+%!function [blocks, refs] = __audit_counters__ ()
+%!  blocks = double (pyeval ("__import__('sys').getallocatedblocks()"));
+%!  refs = double (pyeval ("getattr(__import__('sys'), 'gettotalrefcount', int)()"));
+%!endfunction
+
+%!function growth = __audit_growth__ (fcn)
+%!  n = 1000;
+%!  for i = 1:10
+%!    fcn ();
+%!  endfor
+%!  [b0, r0] = __audit_counters__ ();
+%!  for i = 1:n
+%!    fcn ();
+%!  endfor
+%!  [b1, r1] = __audit_counters__ ();
+%!  growth = max (b1 - b0, r1 - r0) / n;
+%!endfunction
+
+%!assert (__audit_growth__ (@() pycall ("len", [1, 2, 3])) < 0.1)
+%!assert (__audit_growth__ (@() pycall ("max", 1, 2, 3)) < 0.1)
+%!assert (__audit_growth__ (@() pycall ("len", int32 ([1, 2, 3]))) < 0.1)
+%!assert (__audit_growth__ (@() pycall ("len", {1, "a", [1, 2]})) < 0.1)
+%!assert (__audit_growth__ (@() pycall ("len", {"abc", "de"})) < 0.1)
+%!assert (__audit_growth__ (@() pycall ("len", struct ("a", 1, "b", "x"))) < 0.1)
+%!assert (__audit_growth__ (@() pycall ("math.sqrt", 2)) < 0.1)
+%!assert (__audit_growth__ (@() pyeval ("1 + 1")) < 0.1)
+%!assert (__audit_growth__ (@() pyeval ("'abc'")) < 0.1)
+
+## Objects returned to Octave stay in the object store, create them once
+%!test
+%! kw = pyargs ("base", 16);
+%! assert (__audit_growth__ (@() pycall ("int", "42", kw)) < 0.1)
+
+%!test
+%! f = pyeval ("lambda x: x");
+%! assert (__audit_growth__ (@() pycall (f, 1)) < 0.1)
+
+%!test
+%! ns = pyeval ("{'x': 1}");
+%! assert (__audit_growth__ (@() pyeval ("x", ns)) < 0.1)
+%! assert (__audit_growth__ (@() pyexec ("y = x", ns)) < 0.1)
+
+%!test
+%! d = pyeval ("{'a': 1, 'b': [1, 2]}");
+%! assert (__audit_growth__ (@() __py_struct_from_dict__ (d)) < 0.1)
+
+%!function __audit_put_drop__ ()
+%!  __py_objstore_drop__ (__py_objstore_put__ ([1, 2, 3]));
+%!endfunction
+
+%!assert (__audit_growth__ (@__audit_put_drop__) < 0.1)
+%!assert (__audit_growth__ (@() __py_objstore_list__ ()) < 0.1)
+
+## Per-function deltas are only recorded in audit builds
+%!test
+%! s = __py_stats__ ();
+%! if (isfield (s, "audit"))
+%!   pycall ("len", [1, 2, 3]);
+%!   s = __py_stats__ ();
+%!   a = s.audit(strcmp ({s.audit.name}, "pycall"));
+%!   assert (a.calls >= 1)
+%!   assert (isfield (a, "blocks") && isfield (a, "refs"))
+%! endif
@@ -0,0 +1,88 @@
+## Copyright (C) 2019 Mike Miller
+## SPDX-License-Identifier: GPL-3.0-or-later
+##
+## This file is part of Octave Pythonic.
+##
+## Octave Pythonic is free software: you can redistribute it and/or modify
+## it under the terms of the GNU General Public License as published by
+## the Free Software Foundation, either version 3 of the License, or
+## (at your option) any later version.
+##
+## Octave Pythonic is distributed in the hope that it will be useful,
+## but WITHOUT ANY WARRANTY; without even the implied warranty of
+## MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+## GNU General Public License for more details.
+##
+## You should have received a copy of the GNU General Public License
+## along with Octave Pythonic; see the file COPYING.  If not, see
+## <https://www.gnu.org/licenses/>.
+
+
+## -*- texinfo -*-
+## @deftypefn {} {@var{r} =} __bench_time__ (@var{name}, @var{fn}, @var{bytes}, @var{opts})
+## Time calls to the function handle @var{fn} and return a benchmark result.
+##
+## @var{fn} is called with a single integer argument that is different for
+## every call, so that it can build unique inputs.  After a warmup, the
+## number of calls per sample is doubled until one sample takes at least
+## @code{@var{opts}.min_sample} seconds, and then @code{@var{opts}.repeats}
+## samples are timed.  All times in @var{r} are per call.  If @var{bytes} is
+## positive, the throughput in bytes per second is also reported.
+##
+## Benchmarks whose @var{name} does not match @code{@var{opts}.filter} are
+## skipped and an empty struct array is returned.
+## @end deftypefn
+
+function r = __bench_time__ (name, fn, bytes, opts)
+
+  r = struct ("name", {}, "calls", {}, "repeats", {}, "median", {},
+              "min", {}, "max", {}, "mean", {}, "bytes", {},
+              "throughput", {});
+
+  if (! isempty (opts.filter) && isempty (regexp (name, opts.filter, "once")))
+    return;
+  endif
+
+  ## Warm up, then find how many calls make a sample long enough to time
+  time_calls (fn, 1);
+  n = 1;
+  while (time_calls (fn, n) < opts.min_sample && n < 2^24)
+    n *= 2;
+  endwhile
+
+  samples = zeros (1, opts.repeats);
+  for i = 1:opts.repeats
+    samples(i) = time_calls (fn, n) / n;
+  endfor
+
+  t = median (samples);
+  throughput = 0;
+  if (bytes > 0)
+    throughput = bytes / t;
+  endif
+
+  r(1).name = name;
+  r(1).calls = n;
+  r(1).repeats = opts.repeats;
+  r(1).median = t;
+  r(1).min = min (samples);
+  r(1).max = max (samples);
+  r(1).mean = mean (samples);
+  r(1).bytes = bytes;
+  r(1).throughput = throughput;
+
+endfunction
+
+function t = time_calls (fn, n)
+
+  persistent counter = 0;
+
+  t0 = tic ();
+  for i = 1:n
+    fn (counter + i);
+  endfor
+  t = toc (t0);
+
+  counter += n;
+
+endfunction
@@ -0,0 +1,212 @@
+## Copyright (C) 2019 Mike Miller
+## SPDX-License-Identifier: GPL-3.0-or-later
+##
+## This file is part of Octave Pythonic.
+##
+## Octave Pythonic is free software: you can redistribute it and/or modify
+## it under the terms of the GNU General Public License as published by
+## the Free Software Foundation, either version 3 of the License, or
+## (at your option) any later version.
+##
+## Octave Pythonic is distributed in the hope that it will be useful,
+## but WITHOUT ANY WARRANTY; without even the implied warranty of
+## MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+## GNU General Public License for more details.
+##
+## You should have received a copy of the GNU General Public License
+## along with Octave Pythonic; see the file COPYING.  If not, see
+## <https://www.gnu.org/licenses/>.
+
+
+## This is a script file that runs the benchmark suite for the boundary
+## between Octave and Python and writes the results as JSON.
+##
+## Usage: octave __py_bench__.m [OPTION]...
+##
+##   --output=FILE       write results as JSON to FILE (default bench.json)
+##   --baseline=FILE     compare results against the JSON file FILE
+##   --tolerance=X       relative slowdown allowed by --baseline (default 0.1)
+##   --filter=REGEXP     run only benchmarks whose name matches REGEXP
+##   --max-bytes=N       largest array size to convert (default 2^27)
+##   --max-objects=N     largest number of live objects (default 1e6)
+##   --repeats=N         number of timed samples per benchmark (default 7)
+##   --quick             use fewer samples and smaller sizes
+true;
+
+function retval = __run_py_bench__ (varargin)
+
+  opts = parse_options (varargin{:});
+
+  benchdir = fileparts (mfilename ("fullpath"));
+  addpath (benchdir);
+
+  files = dir (fullfile (benchdir, "bench_*.m"));
+  results = struct ("name", {}, "calls", {}, "repeats", {}, "median", {},
+                    "min", {}, "max", {}, "mean", {}, "bytes", {},
+                    "throughput", {});
+
+  pso = page_screen_output ();
+  unwind_protect
+    page_screen_output (false);
+    puts ("\nBenchmarks:\n\n");
+    for i = 1:numel (files)
+      [~, name] = fileparts (files(i).name);
+      r = feval (name, opts);
+      for j = 1:numel (r)
+        print_result (r(j));
+      endfor
+      results = [results, r];
+    endfor
+  unwind_protect_cleanup
+    page_screen_output (pso);
+  end_unwind_protect
+
+  write_json (opts.output, results);
+  printf ("\nResults written to %s\n", opts.output);
+
+  retval = 0;
+  if (! isempty (opts.baseline))
+    retval = compare_baseline (results, opts.baseline, opts.tolerance);
+  endif
+
+endfunction
+
+function opts = parse_options (varargin)
+
+  opts = struct ("output", "bench.json", "baseline", "", "tolerance", 0.1,
+                 "filter", "", "max_bytes", 2^27, "max_objects", 1e6,
+                 "repeats", 7, "min_sample", 0.01);
+
+  for i = 1:numel (varargin)
+    arg = varargin{i};
+    [key, value] = strtok (arg, "=");
+    value = value(2:end);
+    switch (key)
+      case "--output"
+        opts.output = value;
+      case "--baseline"
+        opts.baseline = value;
+      case "--tolerance"
+        opts.tolerance = str2double (value);
+      case "--filter"
+        opts.filter = value;
+      case "--max-bytes"
+        opts.max_bytes = str2double (value);
+      case "--max-objects"
+        opts.max_objects = str2double (value);
+      case "--repeats"
+        opts.repeats = str2double (value);
+      case "--quick"
+        opts.repeats = 3;
+        opts.min_sample = 0.002;
+        opts.max_bytes = min (opts.max_bytes, 2^20);
+        opts.max_objects = min (opts.max_objects, 1e4);
+      otherwise
+        error ("__py_bench__: unrecognized option '%s'", arg);
+    endswitch
+  endfor
+
+endfunction
+
+function print_result (r)
+
+  filler = repmat (".", 1, max (1, 48 - length (r.name)));
+  printf ("  %s %s %s", r.name, filler, format_time (r.median));
+  if (r.throughput > 0)
+    printf ("  %10.1f MB/s", r.throughput / 1e6);
+  endif
+  puts ("\n");
+
+endfunction
+
+function s = format_time (t)
+
+  if (t < 1e-6)
+    s = sprintf ("%8.1f ns", t * 1e9);
+  elseif (t < 1e-3)
+    s = sprintf ("%8.2f us", t * 1e6);
+  elseif (t < 1)
+    s = sprintf ("%8.2f ms", t * 1e3);
+  else
+    s = sprintf ("%8.2f s ", t);
+  endif
+
+endfunction
+
+## Write one result object per line so that the baseline can be read back
+## without a JSON parser.
+
+function write_json (filename, results)
+
+  fid = fopen (filename, "wt");
+  if (fid < 0)
+    error ("__py_bench__: could not open %s for writing", filename);
+  endif
+
+  unwind_protect
+    fprintf (fid, "{\n");
+    fprintf (fid, "  \"octave\": \"%s\",\n", OCTAVE_VERSION);
+    fprintf (fid, "  \"python\": \"%s\",\n", pyversion ());
+    fprintf (fid, "  \"date\": \"%s\",\n", datestr (now (), 31));
+    fprintf (fid, "  \"results\": [\n");
+    for i = 1:numel (results)
+      r = results(i);
+      fprintf (fid, ["    {\"name\": \"%s\", \"calls\": %d, \"repeats\": %d, " ...
+                     "\"median\": %.9g, \"min\": %.9g, \"max\": %.9g, " ...
+                     "\"mean\": %.9g, \"bytes\": %.17g, \"throughput\": %.9g}"],
+               r.name, r.calls, r.repeats, r.median, r.min, r.max, r.mean,
+               r.bytes, r.throughput);
+      if (i < numel (results))
+        fprintf (fid, ",");
+      endif
+      fprintf (fid, "\n");
+    endfor
+    fprintf (fid, "  ]\n");
+    fprintf (fid, "}\n");
+  unwind_protect_cleanup
+    fclose (fid);
+  end_unwind_protect
+
+endfunction
+
+function retval = compare_baseline (results, filename, tolerance)
+
+  text = fileread (filename);
+  tok = regexp (text, '"name": "([^"]*)"[^}]*"median": ([-+.0-9eE]+)',
+                "tokens");
+  names = cellfun (@(t) t{1}, tok, "uniformoutput", false);
+  medians = cellfun (@(t) str2double (t{2}), tok);
+
+  printf ("\nComparison with %s (tolerance %g%%):\n\n", filename,
+          100 * tolerance);
+
+  nslow = nfast = nmissing = 0;
+  for i = 1:numel (results)
+    idx = find (strcmp (names, results(i).name), 1);
+    if (isempty (idx))
+      nmissing++;
+      continue;
+    endif
+    ratio = results(i).median / medians(idx);
+    if (ratio > 1 + tolerance)
+      status = "SLOWER";
+      nslow++;
+    elseif (ratio < 1 / (1 + tolerance))
+      status = "faster";
+      nfast++;
+    else
+      continue;
+    endif
+    filler = repmat (".", 1, max (1, 48 - length (results(i).name)));
+    printf ("  %s %s %6.2fx  %s\n", results(i).name, filler, ratio, status);
+  endfor
+
+  printf ("\n  SLOWER   %6d\n", nslow);
+  printf ("  faster   %6d\n", nfast);
+  printf ("  new      %6d\n\n", nmissing);
+
+  retval = (nslow != 0);
+
+endfunction
+
+exit (__run_py_bench__ (argv (){:}));
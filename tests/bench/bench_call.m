@@ -0,0 +1,36 @@
+## Copyright (C) 2019 Mike Miller
+## SPDX-License-Identifier: GPL-3.0-or-later
+##
+## This file is part of Octave Pythonic.
+##
+## Octave Pythonic is free software: you can redistribute it and/or modify
+## it under the terms of the GNU General Public License as published by
+## the Free Software Foundation, either version 3 of the License, or
+## (at your option) any later version.
+##
+## Octave Pythonic is distributed in the hope that it will be useful,
+## but WITHOUT ANY WARRANTY; without even the implied warranty of
+## MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+## GNU General Public License for more details.
+##
+## You should have received a copy of the GNU General Public License
+## along with Octave Pythonic; see the file COPYING.  If not, see
+## <https://www.gnu.org/licenses/>.
+
+
+## Benchmark the latency of calling Python functions from Octave.
+
+function r = bench_call (opts)
+
+  pyexec ("def _bench_noop(*args): pass");
+  noop = pyeval ("_bench_noop");
+  obj = pyeval ("[1.0, 2.0, 3.0]");
+
+  r = [__bench_time__("call/pycall-empty", @(k) pycall ("_bench_noop"), 0, opts), ...
+       __bench_time__("call/pycall-object", @(k) pycall (noop), 0, opts), ...
+       __bench_time__("call/pycall-args", @(k) pycall (noop, 1, 2, "three"), 0, opts), ...
+       __bench_time__("call/pycall-builtin", @(k) pycall ("len", obj), 0, opts), ...
+       __bench_time__("call/method", @(k) obj.count (2.0), 0, opts), ...
+       __bench_time__("call/py-module", @(k) py.math.sqrt (2), 0, opts)];
+
+endfunction
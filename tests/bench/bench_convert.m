@@ -0,0 +1,84 @@
+## Copyright (C) 2019 Mike Miller
+## SPDX-License-Identifier: GPL-3.0-or-later
+##
+## This file is part of Octave Pythonic.
+##
+## Octave Pythonic is free software: you can redistribute it and/or modify
+## it under the terms of the GNU General Public License as published by
+## the Free Software Foundation, either version 3 of the License, or
+## (at your option) any later version.
+##
+## Octave Pythonic is distributed in the hope that it will be useful,
+## but WITHOUT ANY WARRANTY; without even the implied warranty of
+## MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+## GNU General Public License for more details.
+##
+## You should have received a copy of the GNU General Public License
+## along with Octave Pythonic; see the file COPYING.  If not, see
+## <https://www.gnu.org/licenses/>.
+
+
+## Benchmark conversion of values between Octave and Python, in both
+## directions, for each type over a range of sizes up to opts.max_bytes.
+
+function r = bench_convert (opts)
+
+  pyexec ("def _bench_sink(x): pass");
+  sink = pyeval ("_bench_sink");
+  ident = pyeval ("lambda x: x");
+
+  r = [__bench_time__("convert/to-py/double-scalar", @(k) pycall (sink, 1.5), 8, opts), ...
+       __bench_time__("convert/to-py/logical-scalar", @(k) pycall (sink, true), 1, opts), ...
+       __bench_time__("convert/to-py/int32-scalar", @(k) pycall (sink, int32 (1)), 4, opts), ...
+       __bench_time__("convert/to-py/complex-scalar", @(k) pycall (sink, 1+2i), 16, opts)];
+
+  types = {"double", "single", "int32", "uint8", "logical"};
+  for i = 1:numel (types)
+    t = types{i};
+    for n = element_counts (opts, sizeof (cast (0, t)))
+      x = cast (ones (1, n), t);
+      bytes = sizeof (x);
+      p = pyobject (x);
+      back = pyfunc2handle (pycall ("functools.partial", ident, p));
+      r = [r, ...
+           __bench_time__(sprintf ("convert/to-py/%s/%d", t, n), @(k) pycall (sink, x), bytes, opts), ...
+           __bench_time__(sprintf ("convert/from-py/%s/%d", t, n), @(k) back (), bytes, opts)];
+    endfor
+  endfor
+
+  for n = element_counts (opts, 1)
+    s = repmat ("a", 1, n);
+    p = pyobject (s);
+    r = [r, ...
+         __bench_time__(sprintf ("convert/to-py/char/%d", n), @(k) pycall (sink, s), n, opts), ...
+         __bench_time__(sprintf ("convert/from-py/char/%d", n), @(k) char (p), n, opts)];
+  endfor
+
+  ## Cell arrays of eight-character strings
+  for n = element_counts (opts, 8)
+    c = repmat ({"abcdefgh"}, 1, n);
+    p = pyobject (c);
+    r = [r, ...
+         __bench_time__(sprintf ("convert/to-py/cellstr/%d", n), @(k) pycall (sink, c), 8 * n, opts), ...
+         __bench_time__(sprintf ("convert/from-py/cellstr/%d", n), @(k) cellstr (p), 8 * n, opts)];
+  endfor
+
+  ## Scalar structs of double fields
+  for n = element_counts (opts, 8)
+    if (n > 1e5)
+      break;
+    endif
+    s = cell2struct (num2cell (1:n), strsplit (sprintf ("f%d ", 1:n)), 2);
+    p = pyobject (s);
+    r = [r, ...
+         __bench_time__(sprintf ("convert/to-py/struct/%d", n), @(k) pycall (sink, s), 8 * n, opts), ...
+         __bench_time__(sprintf ("convert/from-py/struct/%d", n), @(k) struct (p), 8 * n, opts)];
+  endfor
+
+endfunction
+
+## Powers of ten from 1 element up to the size limit in bytes
+
+function n = element_counts (opts, elsize)
+  n = 10 .^ (0:floor (log10 (opts.max_bytes / elsize)));
+endfunction
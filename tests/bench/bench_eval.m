@@ -0,0 +1,32 @@
+## Copyright (C) 2019 Mike Miller
+## SPDX-License-Identifier: GPL-3.0-or-later
+##
+## This file is part of Octave Pythonic.
+##
+## Octave Pythonic is free software: you can redistribute it and/or modify
+## it under the terms of the GNU General Public License as published by
+## the Free Software Foundation, either version 3 of the License, or
+## (at your option) any later version.
+##
+## Octave Pythonic is distributed in the hope that it will be useful,
+## but WITHOUT ANY WARRANTY; without even the implied warranty of
+## MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+## GNU General Public License for more details.
+##
+## You should have received a copy of the GNU General Public License
+## along with Octave Pythonic; see the file COPYING.  If not, see
+## <https://www.gnu.org/licenses/>.
+
+
+## Benchmark evaluating Python code with pyeval and pyexec, repeating the
+## same code and compiling new code on every call.
+
+function r = bench_eval (opts)
+
+  r = [__bench_time__("eval/pyeval-repeated", @(k) pyeval ("1 + 1"), 0, opts), ...
+       __bench_time__("eval/pyeval-unique", @(k) pyeval (sprintf ("%d + 1", k)), 0, opts), ...
+       __bench_time__("eval/pyexec-repeated", @(k) pyexec ("_bench_x = 1 + 1"), 0, opts), ...
+       __bench_time__("eval/pyexec-unique", @(k) pyexec (sprintf ("_bench_x = %d + 1", k)), 0, opts), ...
+       __bench_time__("eval/pyexec-function", @(k) pyexec ("def _bench_f(x):\n    return x + 1\n"), 0, opts)];
+
+endfunction
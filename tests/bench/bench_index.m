@@ -0,0 +1,53 @@
+## Copyright (C) 2019 Mike Miller
+## SPDX-License-Identifier: GPL-3.0-or-later
+##
+## This file is part of Octave Pythonic.
+##
+## Octave Pythonic is free software: you can redistribute it and/or modify
+## it under the terms of the GNU General Public License as published by
+## the Free Software Foundation, either version 3 of the License, or
+## (at your option) any later version.
+##
+## Octave Pythonic is distributed in the hope that it will be useful,
+## but WITHOUT ANY WARRANTY; without even the implied warranty of
+## MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+## GNU General Public License for more details.
+##
+## You should have received a copy of the GNU General Public License
+## along with Octave Pythonic; see the file COPYING.  If not, see
+## <https://www.gnu.org/licenses/>.
+
+
+## Benchmark indexing Python objects with subsref and subsasgn.
+
+function r = bench_index (opts)
+
+  L = pyeval ("list(range(1000))");
+  D = pyeval ("{'key': 1.0, 'other': 2.0}");
+  pyexec ("import types");
+  ns = pyeval ("types.SimpleNamespace(attr=1.0)");
+
+  r = [__bench_time__("index/subsref-list", @(k) L{1}, 0, opts), ...
+       __bench_time__("index/subsref-list-end", @(k) L{end}, 0, opts), ...
+       __bench_time__("index/subsref-dict", @(k) D{"key"}, 0, opts), ...
+       __bench_time__("index/subsref-attr", @(k) ns.attr, 0, opts), ...
+       __bench_time__("index/subsasgn-list", @(k) assign_item (L, k), 0, opts), ...
+       __bench_time__("index/subsasgn-dict", @(k) assign_key (D, k), 0, opts), ...
+       __bench_time__("index/subsasgn-attr", @(k) assign_attr (ns, k), 0, opts)];
+
+endfunction
+
+## Python objects are handles, so the assignments below change the objects
+## captured by the benchmark functions.
+
+function assign_item (L, k)
+  L{1} = k;
+endfunction
+
+function assign_key (D, k)
+  D{"key"} = k;
+endfunction
+
+function assign_attr (ns, k)
+  ns.attr = k;
+endfunction
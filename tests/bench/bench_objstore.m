@@ -0,0 +1,64 @@
+## Copyright (C) 2019 Mike Miller
+## SPDX-License-Identifier: GPL-3.0-or-later
+##
+## This file is part of Octave Pythonic.
+##
+## Octave Pythonic is free software: you can redistribute it and/or modify
+## it under the terms of the GNU General Public License as published by
+## the Free Software Foundation, either version 3 of the License, or
+## (at your option) any later version.
+##
+## Octave Pythonic is distributed in the hope that it will be useful,
+## but WITHOUT ANY WARRANTY; without even the implied warranty of
+## MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+## GNU General Public License for more details.
+##
+## You should have received a copy of the GNU General Public License
+## along with Octave Pythonic; see the file COPYING.  If not, see
+## <https://www.gnu.org/licenses/>.
+
+
+## Benchmark object store operations with an increasing number of live
+## objects, up to opts.max_objects.
+
+function r = bench_objstore (opts)
+
+  r = [];
+  live = zeros (1, 0, "uint64");
+
+  unwind_protect
+    for n = 10 .^ (0:floor (log10 (opts.max_objects)))
+      ## Grow the object store to n live objects
+      grow = n - numel (live);
+      live(end+1:n) = arrayfun (@(i) __py_objstore_put__ (i), 1:grow);
+      key = live(ceil (n / 2));
+
+      r = [r, ...
+           __bench_time__(sprintf ("objstore/put-drop/%d", n), @(k) put_drop (k), 0, opts), ...
+           __bench_time__(sprintf ("objstore/get/%d", n), @(k) get_drop (key), 0, opts), ...
+           __bench_time__(sprintf ("objstore/pyobject/%d", n), @(k) wrap_drop (k), 0, opts)];
+    endfor
+  unwind_protect_cleanup
+    for key = live
+      __py_objstore_drop__ (key);
+    endfor
+  end_unwind_protect
+
+endfunction
+
+function put_drop (k)
+  __py_objstore_drop__ (__py_objstore_put__ (k));
+endfunction
+
+## Wrapping an object takes a new reference, which is dropped again so that
+## the number of live objects stays the same
+
+function wrap_drop (k)
+  obj = pyobject (k);
+  __py_objstore_drop__ (obj.m_id);
+endfunction
+
+function get_drop (key)
+  obj = __py_objstore_get__ (key);
+  __py_objstore_drop__ (obj.m_id);
+endfunction
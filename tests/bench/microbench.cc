@@ -0,0 +1,465 @@
+/*
+
+SPDX-License-Identifier: GPL-3.0-or-later
+
+Copyright (C) 2019 Mike Miller
+
+This file is part of Octave Pythonic.
+
+Octave Pythonic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Octave Pythonic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Octave Pythonic; see the file COPYING.  If not, see
+<https://www.gnu.org/licenses/>.
+
+*/
+
+// Standalone microbenchmarks for the conversion layer.  This program links
+// the package library with liboctave and libpython directly and times its
+// functions without going through the Octave interpreter, so that the C++
+// costs are not hidden by the overhead of evaluating m-code.
+//
+// Usage: microbench [--filter=SUBSTR] [--repeats=N] [--warmup=N]
+//                   [--min-time=SECONDS] [--json=FILE] [--no-perf]
+
+#if defined (HAVE_CONFIG_H)
+#  include <config.h>
+#endif
+
+#include <Python.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#if defined (__linux__)
+#  include <linux/perf_event.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+#include <octave/oct.h>
+#include <octave/oct-map.h>
+#include <octave/interpreter.h>
+
+#include "oct-py-error.h"
+#include "oct-py-eval.h"
+#include "oct-py-init.h"
+#include "oct-py-object.h"
+#include "oct-py-types.h"
+#include "oct-py-util.h"
+
+namespace
+{
+
+  struct options
+  {
+    std::string filter;
+    std::string json;
+    int repeats = 50;
+    int warmup = 10;
+    double min_time = 1e-3;
+    bool perf = true;
+  };
+
+  // Hardware counters for the calling thread, read as one group.  Counters
+  // that the kernel or the CPU does not provide are reported as missing.
+
+  class perf_counters
+  {
+  public:
+
+    enum { CYCLES, INSTRUCTIONS, CACHE_MISSES, NUM_COUNTERS };
+
+    perf_counters (bool enable)
+    {
+      std::fill (m_fd, m_fd + NUM_COUNTERS, -1);
+#if defined (__linux__)
+      if (! enable)
+        return;
+
+      const uint64_t config[NUM_COUNTERS] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES
+      };
+
+      for (int i = 0; i < NUM_COUNTERS; i++)
+        {
+          perf_event_attr attr;
+          std::memset (&attr, 0, sizeof (attr));
+          attr.type = PERF_TYPE_HARDWARE;
+          attr.size = sizeof (attr);
+          attr.config = config[i];
+          attr.disabled = 1;
+          attr.exclude_kernel = 1;
+          attr.exclude_hv = 1;
+          m_fd[i] = syscall (SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        }
+#else
+      (void) enable;
+#endif
+    }
+
+    ~perf_counters ()
+    {
+#if defined (__linux__)
+      for (int i = 0; i < NUM_COUNTERS; i++)
+        if (m_fd[i] >= 0)
+          close (m_fd[i]);
+#endif
+    }
+
+    perf_counters (const perf_counters&) = delete;
+
+    perf_counters& operator = (const perf_counters&) = delete;
+
+    bool available (int i) const { return m_fd[i] >= 0; }
+
+    void start ()
+    {
+#if defined (__linux__)
+      for (int i = 0; i < NUM_COUNTERS; i++)
+        if (m_fd[i] >= 0)
+          {
+            ioctl (m_fd[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl (m_fd[i], PERF_EVENT_IOC_ENABLE, 0);
+          }
+#endif
+    }
+
+    void stop (uint64_t counts[NUM_COUNTERS])
+    {
+      for (int i = 0; i < NUM_COUNTERS; i++)
+        {
+          counts[i] = 0;
+#if defined (__linux__)
+          if (m_fd[i] >= 0)
+            {
+              ioctl (m_fd[i], PERF_EVENT_IOC_DISABLE, 0);
+              if (read (m_fd[i], &counts[i], sizeof (uint64_t)) != sizeof (uint64_t))
+                counts[i] = 0;
+            }
+#endif
+        }
+    }
+
+  private:
+
+    int m_fd[NUM_COUNTERS];
+  };
+
+  struct result
+  {
+    std::string name;
+    long calls;
+    int repeats;
+    double bytes;
+    std::vector<double> samples;
+    double counters[perf_counters::NUM_COUNTERS];
+  };
+
+  double
+  percentile (const std::vector<double>& sorted, double p)
+  {
+    if (sorted.empty ())
+      return 0;
+    double pos = p * (sorted.size () - 1);
+    std::size_t lo = static_cast<std::size_t> (pos);
+    std::size_t hi = std::min (lo + 1, sorted.size () - 1);
+    return sorted[lo] + (pos - lo) * (sorted[hi] - sorted[lo]);
+  }
+
+  class bench_runner
+  {
+  public:
+
+    bench_runner (const options& opts)
+      : m_opts (opts), m_perf (opts.perf)
+    { }
+
+    // Time FN, which performs one operation per call.  The number of calls
+    // per sample is doubled until a sample takes at least min_time.
+
+    void run (const std::string& name, const std::function<void ()>& fn,
+              double bytes = 0)
+    {
+      if (! m_opts.filter.empty ()
+          && name.find (m_opts.filter) == std::string::npos)
+        return;
+
+      for (int i = 0; i < m_opts.warmup; i++)
+        fn ();
+
+      long calls = 1;
+      while (time_calls (fn, calls) < m_opts.min_time && calls < (1L << 24))
+        calls *= 2;
+
+      result r;
+      r.name = name;
+      r.calls = calls;
+      r.repeats = m_opts.repeats;
+      r.bytes = bytes;
+      std::fill (r.counters, r.counters + perf_counters::NUM_COUNTERS, 0.0);
+
+      uint64_t counts[perf_counters::NUM_COUNTERS];
+      for (int i = 0; i < m_opts.repeats; i++)
+        {
+          m_perf.start ();
+          double t = time_calls (fn, calls);
+          m_perf.stop (counts);
+          r.samples.push_back (t / calls);
+          for (int j = 0; j < perf_counters::NUM_COUNTERS; j++)
+            r.counters[j] += static_cast<double> (counts[j]);
+        }
+
+      for (int j = 0; j < perf_counters::NUM_COUNTERS; j++)
+        r.counters[j] /= static_cast<double> (calls) * m_opts.repeats;
+
+      std::sort (r.samples.begin (), r.samples.end ());
+      print (r);
+      m_results.push_back (r);
+    }
+
+    void write_json (const std::string& filename) const
+    {
+      FILE *fid = std::fopen (filename.c_str (), "w");
+      if (! fid)
+        {
+          std::fprintf (stderr, "microbench: could not open %s for writing\n",
+                        filename.c_str ());
+          return;
+        }
+
+      std::fprintf (fid, "{\n  \"results\": [\n");
+      for (std::size_t i = 0; i < m_results.size (); i++)
+        {
+          const result& r = m_results[i];
+          double sum = 0;
+          for (double s : r.samples)
+            sum += s;
+          double median = percentile (r.samples, 0.5);
+          std::fprintf (fid, "    {\"name\": \"%s\", \"calls\": %ld, "
+                        "\"repeats\": %d, \"median\": %.9g, \"min\": %.9g, "
+                        "\"max\": %.9g, \"mean\": %.9g, \"p90\": %.9g, "
+                        "\"p99\": %.9g, \"bytes\": %.17g, "
+                        "\"throughput\": %.9g",
+                        r.name.c_str (), r.calls, r.repeats, median,
+                        r.samples.front (), r.samples.back (),
+                        sum / r.samples.size (),
+                        percentile (r.samples, 0.9),
+                        percentile (r.samples, 0.99), r.bytes,
+                        r.bytes > 0 ? r.bytes / median : 0.0);
+          if (m_perf.available (perf_counters::CYCLES))
+            std::fprintf (fid, ", \"cycles\": %.9g",
+                          r.counters[perf_counters::CYCLES]);
+          if (m_perf.available (perf_counters::INSTRUCTIONS))
+            std::fprintf (fid, ", \"instructions\": %.9g",
+                          r.counters[perf_counters::INSTRUCTIONS]);
+          if (m_perf.available (perf_counters::CACHE_MISSES))
+            std::fprintf (fid, ", \"cache_misses\": %.9g",
+                          r.counters[perf_counters::CACHE_MISSES]);
+          std::fprintf (fid, "}%s\n", i + 1 < m_results.size () ? "," : "");
+        }
+      std::fprintf (fid, "  ]\n}\n");
+      std::fclose (fid);
+    }
+
+  private:
+
+    static double time_calls (const std::function<void ()>& fn, long calls)
+    {
+      auto t0 = std::chrono::steady_clock::now ();
+      for (long i = 0; i < calls; i++)
+        fn ();
+      auto t1 = std::chrono::steady_clock::now ();
+      return std::chrono::duration<double> (t1 - t0).count ();
+    }
+
+    void print (const result& r) const
+    {
+      std::printf ("  %-40s %10.1f ns  p90 %10.1f ns  p99 %10.1f ns",
+                   r.name.c_str (), 1e9 * percentile (r.samples, 0.5),
+                   1e9 * percentile (r.samples, 0.9),
+                   1e9 * percentile (r.samples, 0.99));
+      if (m_perf.available (perf_counters::CYCLES))
+        std::printf ("  %10.0f cyc", r.counters[perf_counters::CYCLES]);
+      if (m_perf.available (perf_counters::CACHE_MISSES))
+        std::printf ("  %8.1f miss", r.counters[perf_counters::CACHE_MISSES]);
+      std::printf ("\n");
+      std::fflush (stdout);
+    }
+
+    options m_opts;
+    perf_counters m_perf;
+    std::vector<result> m_results;
+  };
+
+  options
+  parse_options (int argc, char **argv)
+  {
+    options opts;
+
+    for (int i = 1; i < argc; i++)
+      {
+        std::string arg = argv[i];
+        std::string key = arg.substr (0, arg.find ('='));
+        std::string value = (arg.find ('=') == std::string::npos)
+                            ? "" : arg.substr (arg.find ('=') + 1);
+        if (key == "--filter")
+          opts.filter = value;
+        else if (key == "--json")
+          opts.json = value;
+        else if (key == "--repeats")
+          opts.repeats = std::max (1, std::atoi (value.c_str ()));
+        else if (key == "--warmup")
+          opts.warmup = std::max (0, std::atoi (value.c_str ()));
+        else if (key == "--min-time")
+          opts.min_time = std::atof (value.c_str ());
+        else if (key == "--no-perf")
+          opts.perf = false;
+        else
+          {
+            std::fprintf (stderr, "microbench: unrecognized option '%s'\n",
+                          arg.c_str ());
+            std::exit (2);
+          }
+      }
+
+    return opts;
+  }
+
+  NDArray
+  make_row (octave_idx_type n)
+  {
+    NDArray array (dim_vector (1, n));
+    for (octave_idx_type i = 0; i < n; i++)
+      array(i) = i;
+    return array;
+  }
+
+  octave_scalar_map
+  make_map (int nfields)
+  {
+    octave_scalar_map map;
+    for (int i = 0; i < nfields; i++)
+      map.setfield ("f" + std::to_string (i), octave_value (1.0 * i));
+    return map;
+  }
+
+  void
+  run_benchmarks (bench_runner& bench)
+  {
+    using pythonic::python_object;
+
+    for (octave_idx_type n : {1, 1000, 1000000})
+      {
+        NDArray array = make_row (n);
+        bench.run ("make_py_array/double/" + std::to_string (n),
+                   [&] () { python_object obj = pythonic::make_py_array (array); },
+                   8.0 * n);
+      }
+
+    for (octave_idx_type n : {1, 1000, 1000000})
+      {
+        int32NDArray array (dim_vector (1, n), octave_int32 (1));
+        bench.run ("make_py_array/int32/" + std::to_string (n),
+                   [&] () { python_object obj = pythonic::make_py_array (array); },
+                   4.0 * n);
+      }
+
+    for (int n : {1, 10, 100, 1000})
+      {
+        octave_scalar_map map = make_map (n);
+        python_object dict = pythonic::make_py_dict (map);
+        bench.run ("make_py_dict/" + std::to_string (n),
+                   [&] () { python_object obj = pythonic::make_py_dict (map); });
+        bench.run ("extract_py_scalar_map/" + std::to_string (n),
+                   [&] () { pythonic::extract_py_scalar_map (dict); });
+      }
+
+    python_object list = pythonic::py_eval_string ("[1, 2, 3]");
+    python_object noop = pythonic::py_eval_string ("lambda *args: None");
+    octave_value_list no_args;
+    octave_value_list three_args = ovl (1.0, 2.0, "three");
+
+    bench.run ("py_call_function/noop",
+               [&] () { python_object r = pythonic::py_call_function (noop, no_args); });
+    bench.run ("py_call_function/noop-args",
+               [&] () { python_object r = pythonic::py_call_function (noop, three_args); });
+    python_object len_args = PyTuple_Pack (1, static_cast<PyObject *> (list));
+    bench.run ("py_call_function/by-name",
+               [&] () { python_object r = pythonic::py_call_function ("len", len_args); });
+
+    bench.run ("py_objstore/put-drop", [&] ()
+      {
+        pythonic::py_objstore_drop (pythonic::py_objstore_put (Py_None));
+      });
+
+    uint64_t key = pythonic::py_objstore_put (list);
+    bench.run ("py_objstore/get", [&] ()
+      {
+        python_object obj = pythonic::py_objstore_get (key);
+      });
+    pythonic::py_objstore_drop (key);
+
+    bench.run ("error_python_exception", [] ()
+      {
+        PyErr_SetString (PyExc_ValueError, "benchmark error");
+        try
+          {
+            pythonic::error_python_exception ();
+          }
+        catch (const octave::execution_exception&)
+          {
+          }
+      });
+  }
+
+}
+
+int
+main (int argc, char **argv)
+{
+  options opts = parse_options (argc, argv);
+
+  octave::interpreter interpreter;
+  interpreter.initialize_history (false);
+  interpreter.initialize_load_path (false);
+  interpreter.initialize ();
+
+  if (! interpreter.initialized ())
+    {
+      std::fprintf (stderr, "microbench: Octave interpreter initialization failed\n");
+      return 1;
+    }
+
+  if (interpreter.execute () != 0)
+    {
+      std::fprintf (stderr, "microbench: creating the Octave interpreter failed\n");
+      return 1;
+    }
+
+  pythonic::py_init ();
+
+  bench_runner bench (opts);
+  run_benchmarks (bench);
+
+  if (! opts.json.empty ())
+    bench.write_json (opts.json);
+
+  return 0;
+}
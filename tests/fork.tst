@@ -0,0 +1,56 @@
+## Copyright (C) 2019 Mike Miller
+## SPDX-License-Identifier: GPL-3.0-or-later
+##
+## This file is part of Octave Pythonic.
+##
+## Octave Pythonic is free software: you can redistribute it and/or modify
+## it under the terms of the GNU General Public License as published by
+## the Free Software Foundation, either version 3 of the License, or
+## (at your option) any later version.
+##
+## Octave Pythonic is distributed in the hope that it will be useful,
+## but WITHOUT ANY WARRANTY; without even the implied warranty of
+## MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+## GNU General Public License for more details.
+##
+## You should have received a copy of the GNU General Public License
+## along with Octave Pythonic; see the file COPYING.  If not, see
+## <https://www.gnu.org/licenses/>.
+
+## The child process leaves with os._exit so that it never returns into the
+## test runner, its exit status reports whether Python was usable.
+
+%!test
+%! if (isunix ())
+%!   x = pyeval ("[1, 2, 3]");
+%!   pyexec ("import threading, time");
+%!   t = pycall ("threading.Thread", pyargs ("target", pyeval ("lambda: time.sleep(0.5)")));
+%!   t.start ();
+%!   pid = fork ();
+%!   if (pid == 0)
+%!     status = 1;
+%!     try
+%!       status = 2 * (double (pycall ("len", x)) != 3) ...
+%!                + 4 * (double (pyeval ("threading.active_count()")) != 1);
+%!     end_try_catch
+%!     pycall ("os._exit", int32 (status));
+%!   endif
+%!   [~, status] = waitpid (pid);
+%!   t.join ();
+%!   assert (WEXITSTATUS (status), 0)
+%!   assert (double (pycall ("len", x)), 3)
+%! endif
+
+%!test
+%! if (isunix ())
+%!   pyexec ("import os");
+%!   pyexec ("pid = os.fork()\nif pid == 0: os._exit(0)\nos.waitpid(pid, 0)");
+%!   assert (double (pyeval ("sum([1, 2, 3])")), 6)
+%! endif
+
+## The .oct files that registered fork handlers stay loaded
+%!test
+%! if (isunix ())
+%!   pycall ("int");
+%!   assert (mislocked ("pycall"))
+%! endif
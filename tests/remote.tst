@@ -0,0 +1,102 @@
+## Copyright (C) 2019 Mike Miller
+## SPDX-License-Identifier: GPL-3.0-or-later
+##
+## This file is part of Octave Pythonic.
+##
+## Octave Pythonic is free software: you can redistribute it and/or modify
+## it under the terms of the GNU General Public License as published by
+## the Free Software Foundation, either version 3 of the License, or
+## (at your option) any later version.
+##
+## Octave Pythonic is distributed in the hope that it will be useful,
+## but WITHOUT ANY WARRANTY; without even the implied warranty of
+## MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+## GNU General Public License for more details.
+##
+## You should have received a copy of the GNU General Public License
+## along with Octave Pythonic; see the file COPYING.  If not, see
+## <https://www.gnu.org/licenses/>.
+
+## Every test starts its own workers and stops them even if it fails, so
+## that later test files do not run against remote workers
+
+%!function msg = __remote_error__ (f, varargin)
+%!  msg = "";
+%!  try
+%!    f (varargin{:});
+%!  catch err
+%!    msg = err.message;
+%!  end_try_catch
+%!endfunction
+
+%!test
+%! n = pythonic ("remote", 2);
+%! unwind_protect
+%!   assert (n, 2)
+%!   assert (pycall ("math.sqrt", 2), sqrt (2))
+%!   assert (pyeval ("1.5 + 1"), 2.5)
+%!   assert (pycall ("operator.not_", true), false)
+%!   pid = double (pyeval ("__import__('os').getpid()"));
+%!   assert (pid != getpid ())
+%! unwind_protect_cleanup
+%!   pythonic ("remote", "off");
+%! end_unwind_protect
+
+## Definitions made without a namespace are visible to all workers
+%!test
+%! pythonic ("remote", 2);
+%! unwind_protect
+%!   pyexec ("def remote_double(x): return x * 2");
+%!   for i = 1:4
+%!     assert (pycall ("remote_double", 21), 42)
+%!   endfor
+%! unwind_protect_cleanup
+%!   pythonic ("remote", "off");
+%! end_unwind_protect
+
+## Mutable objects stay in the worker and are used by reference
+%!test
+%! pythonic ("remote", 2);
+%! unwind_protect
+%!   L = pyeval ("[1., 2., 3.]");
+%!   pycall (pycall ("getattr", L, "append"), 4);
+%!   assert (double (pycall ("len", L)), 4)
+%!   assert (char (L), "[1.0, 2.0, 3.0, 4.0]")
+%!   ns = pyeval ("{}");
+%!   pyexec ("y = 3.", ns);
+%!   assert (pyeval ("y", ns), 3)
+%! unwind_protect_cleanup
+%!   pythonic ("remote", "off");
+%! end_unwind_protect
+
+## Large arrays are passed through shared memory
+%!test
+%! pythonic ("remote", 2);
+%! unwind_protect
+%!   x = rand (1, 100000);
+%!   assert (pycall ("sum", x), sum (x), -1e-12)
+%!   a = pycall ("array.array", "d", 1:10000);
+%!   assert (isa (a, "py.array.array"))
+%!   assert (pycall ("sum", a), sum (1:10000))
+%! unwind_protect_cleanup
+%!   pythonic ("remote", "off");
+%! end_unwind_protect
+
+## Errors are raised in Octave, a crashed worker is restarted on the next
+## call
+%!test
+%! pythonic ("remote", 2);
+%! unwind_protect
+%!   assert (! isempty (strfind (__remote_error__ (@pyeval, "no_such_name"), "NameError")))
+%!   assert (! isempty (strfind (__remote_error__ (@pycall, "no_such_function"), "NameError")))
+%!   msg = __remote_error__ (@pyexec, "__import__('os')._exit(1)");
+%!   assert (! isempty (strfind (msg, "exited unexpectedly")))
+%!   assert (pycall ("math.sqrt", 4), 2)
+%! unwind_protect_cleanup
+%!   pythonic ("remote", "off");
+%! end_unwind_protect
+
+%!test
+%! pythonic ("remote", 2);
+%! assert (pythonic ("remote", "off"), 0)
+%! assert (double (pyeval ("__import__('os').getpid()")), getpid ())